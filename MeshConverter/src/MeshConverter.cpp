@@ -0,0 +1,92 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "VertexBufferLayout.h"
+
+// Offline converter from Wavefront OBJ to the binary .mesh format loaded by
+// Mesh::LoadFromFile.
+//
+//   MeshConverter <input.obj> <output.mesh> [--packed] [--no-optimize]
+//
+// --packed stores normals as GL_INT_2_10_10_10_REV and texture coordinates
+// as half floats (20 instead of 32 bytes per vertex).
+// --no-optimize keeps the OBJ's triangle and vertex order instead of running
+// MeshOptimizer. Packing happens first so vertices that only differ below
+// the packed precision get welded too.
+
+static void PackVertices(MeshData& mesh) {
+	struct InputVertex { float Position[3]; float Normal[3]; float TexCoord[2]; };
+	struct OutputVertex { float Position[3]; PackedNormal Normal; Half TexCoord[2]; };
+	using OutputLayout = StaticVertexLayout<VertexAttribute<float, 3>, VertexAttribute<PackedNormal, 1>, VertexAttribute<Half, 2>>;
+	static_assert(OutputLayout::Stride == sizeof(OutputVertex), "OutputVertex layout does not match the struct");
+
+	uint32_t count = mesh.GetVertexCount();
+	std::vector<unsigned char> packed(count * sizeof(OutputVertex));
+	const InputVertex* in = (const InputVertex*)mesh.Vertices.data();
+	OutputVertex* out = (OutputVertex*)packed.data();
+	for (uint32_t i = 0; i < count; i++) {
+		memcpy(out[i].Position, in[i].Position, sizeof(out[i].Position));
+		out[i].Normal = VertexPacking::ToPackedNormal(in[i].Normal[0], in[i].Normal[1], in[i].Normal[2]);
+		out[i].TexCoord[0] = VertexPacking::ToHalf(in[i].TexCoord[0]);
+		out[i].TexCoord[1] = VertexPacking::ToHalf(in[i].TexCoord[1]);
+	}
+
+	mesh.Vertices.swap(packed);
+	mesh.VertexStride = OutputLayout::Stride;
+	mesh.Attributes.clear();
+	for (const VertexBufferElement& element : OutputLayout::Elements)
+		mesh.Attributes.push_back({ element.type, element.count, element.normalized, element.integer, 0, element.offset });
+}
+
+int main(int argc, char* args[]) {
+	if (argc < 3) {
+		std::cout << "Usage: MeshConverter <input.obj> <output.mesh> [--packed] [--no-optimize]" << std::endl;
+		return 1;
+	}
+
+	std::string input = args[1];
+	std::string output = args[2];
+	bool packed = false;
+	bool optimize = true;
+	for (int i = 3; i < argc; i++) {
+		std::string option = args[i];
+		if (option == "--packed")
+			packed = true;
+		else if (option == "--no-optimize")
+			optimize = false;
+		else
+			std::cout << "Ignoring unknown option " << option << std::endl;
+	}
+
+	Timer timer;
+	MeshData mesh;
+	if (!ObjLoader::Load(input, mesh))
+		return 1;
+	std::cout << "Parsed " << input << " in " << timer.ElapsedMilliseconds() << " ms" << std::endl;
+
+	if (packed)
+		PackVertices(mesh);
+
+	if (optimize) {
+		MeshOptimizer::Report report = MeshOptimizer::Optimize(mesh, &ThreadPool::Get());
+		std::cout << "Optimized in " << report.Milliseconds << " ms: "
+			<< "ACMR " << report.Before.ACMR << " -> " << report.After.ACMR << ", "
+			<< "ATVR " << report.Before.ATVR << " -> " << report.After.ATVR << ", "
+			<< report.VerticesBefore << " -> " << report.VerticesAfter << " vertices" << std::endl;
+	}
+
+	if (!MeshFile::Write(output, mesh)) {
+		std::cout << "Could not write " << output << std::endl;
+		return 1;
+	}
+
+	std::cout << "Wrote " << output << ": " << mesh.GetVertexCount() << " vertices (" << mesh.VertexStride << " bytes each), "
+		<< mesh.Indices.size() / 3 << " triangles" << std::endl;
+	return 0;
+}
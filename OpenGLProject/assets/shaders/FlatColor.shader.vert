@@ -2,7 +2,13 @@
 
 layout(location = 0) in vec4 position;
 
+layout(std140) uniform Frame
+{
+	mat4 u_ViewProjection;
+	float u_Time;
+};
+
 void main()
 {
-	gl_Position = position;
+	gl_Position = u_ViewProjection * position;
 }
@@ -0,0 +1,32 @@
+#version 330 core
+
+layout(location = 0) in vec4 a_Position;
+
+// PER_DRAW reads the same data from uniforms, for comparison with instancing
+#ifdef PER_DRAW
+uniform vec2 u_Offset;
+uniform vec4 u_Color;
+#else
+layout(location = 1) in vec2 a_Offset;
+layout(location = 2) in vec4 a_Color;
+#endif
+
+out vec4 v_Color;
+
+layout(std140) uniform Frame
+{
+	mat4 u_ViewProjection;
+	float u_Time;
+};
+
+void main()
+{
+#ifdef PER_DRAW
+	vec2 offset = u_Offset;
+	v_Color = u_Color;
+#else
+	vec2 offset = a_Offset;
+	v_Color = a_Color;
+#endif
+	gl_Position = u_ViewProjection * vec4(a_Position.xy + offset, a_Position.zw);
+}
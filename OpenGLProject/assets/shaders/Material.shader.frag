@@ -0,0 +1,17 @@
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+layout(std140) uniform Material
+{
+	vec4 u_Color;
+};
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord) * u_Color;
+}
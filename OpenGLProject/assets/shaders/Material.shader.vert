@@ -0,0 +1,18 @@
+#version 330 core
+
+layout(location = 0) in vec4 a_Position;
+layout(location = 1) in vec2 a_TexCoord;
+
+out vec2 v_TexCoord;
+
+layout(std140) uniform Frame
+{
+	mat4 u_ViewProjection;
+	float u_Time;
+};
+
+void main()
+{
+	v_TexCoord = a_TexCoord;
+	gl_Position = u_ViewProjection * a_Position;
+}
@@ -1,13 +1,21 @@
 #include <SDL.h>
 #include <glew.h>
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
 
 #include "Renderer.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "RenderBenchmark.h"
+#include "RenderThread.h"
+#include "VecMath.h"
 
 const unsigned int SCREEN_WIDTH = 1000;
 const unsigned int SCREEN_HEIGHT = 1000;
@@ -17,86 +25,37 @@ SDL_GLContext gContext = nullptr;
 
 void PrintKeyInfo(SDL_KeyboardEvent* key);
 
-static std::string LoadShaderSource(const std::string& filepath) {
-	std::ifstream stream(filepath);
-
-	std::string line;
-	std::string shaderSource;
-	while (getline(stream, line)) {
-		shaderSource.append(line + "\n");
-	}
-
-	return shaderSource;
-}
-
-static unsigned int CompileShader(unsigned int type, const std::string& source) {
-	GLCall(unsigned int id = glCreateShader(type));
-	const char* src = source.c_str();
-	GLCall(glShaderSource(id, 1, &src, nullptr));
-	GLCall(glCompileShader(id));
-
-	int result;
-	GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
-	if (result == GL_FALSE) {
-		int length;
-		GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-		char* message = (char*)alloca(sizeof(char) * length);
-		GLCall(glGetShaderInfoLog(id, length, &length, message));
-
-		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
-		std::cout << message << std::endl;
-		GLCall(glDeleteShader(id));
-		return 0;
-	}
-
-	return id;
-}
-
-static unsigned int CreateShaderProgram(const std::string& vertexShaderSource, const std::string& fragmentShaderSource) {
-	GLCall(unsigned int program = glCreateProgram());
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-	GLCall(glAttachShader(program, vs));
-	GLCall(glAttachShader(program, fs));
-	GLCall(glLinkProgram(program));
-	GLCall(glValidateProgram(program));
-
-	GLCall(glDeleteShader(vs));
-	GLCall(glDeleteShader(fs));
-
-	return program;
-}
+static bool CreateWindowAndContext(Uint32 flags);
 
 int main(int argc, char* args[]) {
 	int quit = 0;
 
+	// Headless mode renders the benchmark scenes offscreen, see RenderBenchmark.h
+	bool headless = argc > 1 && std::string(args[1]) == "--headless";
+	RenderBenchmark::Options headlessOptions;
+	if (headless && !RenderBenchmark::ParseOptions(argc - 2, args + 2, headlessOptions))
+		return -1;
+
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-
-	// Create Window
-	gWindow = SDL_CreateWindow(
-		"OpenGLProject",
-		SDL_WINDOWPOS_UNDEFINED,
-		SDL_WINDOWPOS_UNDEFINED,
-		SCREEN_WIDTH, SCREEN_HEIGHT,
-		SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN
-	);
-	if (gWindow == nullptr) {
-		std::cout << "Window could not be created" << std::endl << "Error: " << SDL_GetError() << std::endl;
-		return -1;
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#endif
+
+	// SDL's offscreen driver gets a context from EGL without any display
+	// server, e.g. Mesa llvmpipe on build machines. Where it is missing a
+	// hidden window works as well since everything renders into an FBO.
+	bool created = false;
+	if (headless && SDL_VideoInit("offscreen") == 0) {
+		created = CreateWindowAndContext(SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+		if (!created) {
+			std::cout << "Falling back to a hidden window" << std::endl;
+			SDL_VideoQuit();
+		}
 	}
-
-	// Create Context
-	gContext = SDL_GL_CreateContext(gWindow);
-	if (gContext == nullptr) {
-		std::cout << "OpenGL context could not be created" << std::endl << "Error: " << SDL_GetError() << std::endl;
+	if (!created && !CreateWindowAndContext(SDL_WINDOW_OPENGL | (headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)))
 		return -1;
-	}
-	else {
-		std::cout << "OpenGL " << glGetString(GL_VERSION) << std::endl;
-	}
 
 	// Initialize GLEW
 	GLenum glewError = glewInit();
@@ -108,6 +67,22 @@ int main(int argc, char* args[]) {
 		std::cout << "GLEW " << glewGetString(GLEW_VERSION) << " initialized" << std::endl << std::endl;
 	}
 
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+	if (!GLInstallDebugOutput(false)) {
+		std::cout << "KHR_debug is not supported, GL errors will not be reported" << std::endl;
+	}
+#endif
+
+	if (headless) {
+		SDL_GL_SetSwapInterval(0);
+		int result = RenderBenchmark::Run(headlessOptions);
+		Profiler::ShutdownGpu();
+
+		SDL_DestroyWindow(gWindow);
+		SDL_Quit();
+		return result;
+	}
+
 	// Enable adaptive v-sync if supported
 	if (SDL_GL_SetSwapInterval(-1) < 0) {
 		std::cout << "Error enabling adaptive vsync" << std::endl << SDL_GetError() << std::endl;
@@ -116,6 +91,24 @@ int main(int argc, char* args[]) {
 		}
 	}
 
+	// Run benchmarks instead of the application loop
+	if (argc > 1 && std::string(args[1]) == "--benchmark") {
+		Benchmark::Run(argc > 2 ? args[2] : "");
+
+		SDL_DestroyWindow(gWindow);
+		SDL_Quit();
+		return Benchmark::GetFailedCheckCount() > 0 ? 1 : 0;
+	}
+
+	// Profile the whole run and write a Chrome trace on exit
+	std::string tracePath;
+	if (argc > 2 && std::string(args[1]) == "--profile") {
+		tracePath = args[2];
+		Profiler::SetThreadName("Main");
+		Profiler::InitGpu();
+		Profiler::SetEnabled(true);
+	}
+
 	{
 		// Vertex positions
 		float positions[] = {
@@ -140,61 +133,96 @@ int main(int argc, char* args[]) {
 
 		IndexBuffer ibo(indices, 6);
 
-		// Load shaders from filesystem 
-		std::string vertexShaderSource = LoadShaderSource("assets/shaders/FlatColor.shader.vert");
-		std::string fragmentShaderSource = LoadShaderSource("assets/shaders/FlatColor.shader.frag");
+		// Load shaders from the binary cache, or compile and link them on the first run
+		ShaderLibrary shaderLibrary;
+		std::shared_ptr<Shader> shader = shaderLibrary.Load("assets/shaders/FlatColor.shader.vert", "assets/shaders/FlatColor.shader.frag");
+		if (!shader) {
+			SDL_DestroyWindow(gWindow);
+			SDL_Quit();
+			return -1;
+		}
+		shaderLibrary.PrintLoadTimings();
+		shader->Bind();
 
-		// Creates a GLSL shader program; compiles, attaches, and links shaders to the program
-		// then executes the program on the currently bound VBO
-		unsigned int shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
-		GLCall(glUseProgram(shaderProgram));
+		// Per-frame data shared by every program through the Frame uniform block
+		FrameUniforms frame = {};
+		float aspect = (float)SCREEN_WIDTH / SCREEN_HEIGHT;
+		Mat4 projection = Mat4::Orthographic(-aspect, aspect, -1.0f, 1.0f, -1.0f, 1.0f);
+		Mat4 view = Mat4::LookAt(Vec3(0.0f, 0.0f, 0.5f), Vec3(), Vec3(0.0f, 1.0f, 0.0f));
+		memcpy(frame.ViewProjection, (projection * view).Data(), sizeof(frame.ViewProjection));
+		UniformBuffer frameUniforms(sizeof(FrameUniforms), UniformBlock::Frame);
 
-		// Locate shader uniform and pass variable to the shader program
 		float red = 1.0f;
-		GLCall(int location = glGetUniformLocation(shaderProgram, "u_Color"));
-		ASSERT(location != -1);
-		GLCall(glUniform4f(location, red, 0.0f, 0.0f, 1.0f));
+		shader->SetUniform4f("u_Color", red, 0.0f, 0.0f, 1.0f);
+
+		// Simulation, recording and input stay on this thread; GL calls and
+		// SwapWindow move to the render thread unless --no-render-thread
+		bool renderThreaded = true;
+		for (int i = 1; i < argc; i++) {
+			if (std::string(args[i]) == "--no-render-thread")
+				renderThreaded = false;
+		}
 
 		// Application Loop
 		float redIncrement = 0.05f;
 		SDL_Event event;
-		while (!quit) {
-			// GFX
-			GLCall(glClear(GL_COLOR_BUFFER_BIT));
-			GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+		{
+			RenderThread renderThread(gWindow, gContext, renderThreaded);
+			while (!quit) {
+				{
+					PROFILE_SCOPE("Update");
+					frame.Time = SDL_GetTicks() / 1000.0f;
+
+					if (red >= 1.0f) {
+						redIncrement = -0.05f;
+					}
+					else if (red <= 0.0f) {
+						redIncrement = 0.05f;
+					}
+					red += redIncrement;
+				}
 
-			if (red >= 1.0f) {
-				redIncrement = -0.05f;
-			}
-			else if (red <= 0.0f) {
-				redIncrement = 0.05f;
-			}
-			red += redIncrement;
-			GLCall(glUniform4f(location, red, 0.0f, 0.0f, 1.0f));
-
-			// Swap front and back buffer
-			SDL_GL_SwapWindow(gWindow);
-
-			// INPUT
-			while (SDL_PollEvent(&event)) {
-				switch (event.type) {
-				case SDL_KEYDOWN:
-					PrintKeyInfo(&event.key);
-					if (event.key.keysym.sym == SDLK_ESCAPE)
-						quit = 1;
-					break;
-				case SDL_KEYUP:
-					PrintKeyInfo(&event.key);
-					break;
-				case SDL_QUIT:
-					std::cout << "Program quit after " << event.quit.timestamp << " ticks" << std::endl;
-					quit = 1;
-					break;
+				// GFX
+				{
+					RenderFrame& renderFrame = renderThread.BeginFrame();
+					PROFILE_SCOPE("Record");
+					CommandBuffer& commands = renderFrame.GetCommandBuffer();
+					commands.SetUniformBufferData(frameUniforms, &frame, sizeof(frame));
+					commands.SetUniform4f(*shader, "u_Color", red, 0.0f, 0.0f, 1.0f);
+					commands.Clear();
+					commands.Draw(vao, ibo, *shader);
+					renderThread.Submit();
+				}
+
+				// INPUT
+				{
+					PROFILE_SCOPE("Input");
+					while (SDL_PollEvent(&event)) {
+						switch (event.type) {
+						case SDL_KEYDOWN:
+							PrintKeyInfo(&event.key);
+							if (event.key.keysym.sym == SDLK_ESCAPE)
+								quit = 1;
+							break;
+						case SDL_KEYUP:
+							PrintKeyInfo(&event.key);
+							break;
+						case SDL_QUIT:
+							std::cout << "Program quit after " << event.quit.timestamp << " ticks" << std::endl;
+							quit = 1;
+							break;
+						}
+					}
 				}
 			}
 		}
 
-		GLCall(glDeleteProgram(shaderProgram));
+		if (!tracePath.empty()) {
+			Profiler::PrintSummary();
+			if (Profiler::WriteChromeTrace(tracePath))
+				std::cout << "Wrote trace " << tracePath << std::endl;
+		}
+		Profiler::ShutdownGpu();
 	}
 
 	SDL_DestroyWindow(gWindow);
@@ -202,6 +230,33 @@ int main(int argc, char* args[]) {
 	return 0;
 }
 
+static bool CreateWindowAndContext(Uint32 flags) {
+	// Create Window
+	gWindow = SDL_CreateWindow(
+		"OpenGLProject",
+		SDL_WINDOWPOS_UNDEFINED,
+		SDL_WINDOWPOS_UNDEFINED,
+		SCREEN_WIDTH, SCREEN_HEIGHT,
+		flags
+	);
+	if (gWindow == nullptr) {
+		std::cout << "Window could not be created" << std::endl << "Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	// Create Context
+	gContext = SDL_GL_CreateContext(gWindow);
+	if (gContext == nullptr) {
+		std::cout << "OpenGL context could not be created" << std::endl << "Error: " << SDL_GetError() << std::endl;
+		SDL_DestroyWindow(gWindow);
+		gWindow = nullptr;
+		return false;
+	}
+
+	std::cout << "OpenGL " << glGetString(GL_VERSION) << std::endl;
+	return true;
+}
+
 void PrintKeyInfo(SDL_KeyboardEvent* key) {
 	if (key->type == SDL_KEYDOWN) {
 		printf("KEY DOWN - ");
@@ -0,0 +1,424 @@
+#include <algorithm>
+
+#include "BVH.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+static const uint32_t Empty = 0xFFFFFFFF;
+static const uint32_t LeafFlag = 0x80000000;
+static const float Huge = 1e30f;
+// Traversal pushes at most three more entries per level, and median splits
+// keep the tree at about log4(objects) levels
+static const int MaxStackSize = 256;
+
+static inline bool IsLeaf(uint32_t child) { return child != Empty && (child & LeafFlag); }
+static inline uint32_t GetLeafIndex(uint32_t child) { return (child & ~LeafFlag) >> 3; }
+static inline uint32_t GetLeafCount(uint32_t child) { return child & 7; }
+
+// Centers are copied next to the object index so the splits during Build()
+// stay in cache
+struct BVH::BuildItem
+{
+	float Center[3];
+	uint32_t Object;
+};
+
+BVH::BVH()
+	: m_ObjectCount(0), m_BuildCost(0.0), m_Cost(0.0)
+{
+}
+
+void BVH::Build(const BoundsArrays& bounds)
+{
+	m_ObjectCount = (uint32_t)bounds.GetCount();
+	m_Nodes.clear();
+	m_Leaves.clear();
+	m_ObjectSlots.assign(m_ObjectCount, Empty);
+
+	size_t leafEstimate = m_ObjectCount / 2 + 1;
+	m_Nodes.reserve(leafEstimate / 3 + 1);
+	m_Leaves.reserve(leafEstimate);
+
+	if (m_ObjectCount > 0) {
+		std::vector<BuildItem> items(m_ObjectCount);
+		for (uint32_t i = 0; i < m_ObjectCount; i++)
+			items[i] = { { bounds.CenterX[i], bounds.CenterY[i], bounds.CenterZ[i] }, i };
+		BuildNode(items.data(), items.size(), Empty);
+	}
+
+	for (size_t leaf = 0; leaf < m_Leaves.size(); leaf++) {
+		for (uint32_t slot = 0; slot < LeafSize; slot++) {
+			uint32_t object = m_Leaves[leaf].Objects[slot];
+			if (object != Empty)
+				m_ObjectSlots[object] = (uint32_t)leaf * LeafSize + slot;
+		}
+	}
+	m_NodeDirty.assign(m_Nodes.size(), 0);
+
+	Refit(bounds);
+	m_BuildCost = m_Cost;
+}
+
+uint32_t BVH::BuildNode(BuildItem* items, size_t count, uint32_t parent)
+{
+	uint32_t index = (uint32_t)m_Nodes.size();
+	m_Nodes.emplace_back();
+	m_Nodes[index].Parent = parent;
+
+	// Two levels of median splits along the longest axis of the centers give
+	// up to four ranges of objects
+	struct Range { BuildItem* Items; size_t Count; };
+	Range ranges[4] = { { items, count } };
+	size_t rangeCount = 1;
+	for (int level = 0; level < 2; level++) {
+		size_t current = rangeCount;
+		for (size_t r = 0; r < current; r++) {
+			Range& range = ranges[r];
+			if (range.Count <= LeafSize)
+				continue;
+
+			Vec3 low(Huge), high(-Huge);
+			for (size_t i = 0; i < range.Count; i++) {
+				const float* c = range.Items[i].Center;
+				Vec3 center(c[0], c[1], c[2]);
+				low = Min(low, center);
+				high = Max(high, center);
+			}
+			Vec3 size = high - low;
+			int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+
+			size_t half = range.Count / 2;
+			std::nth_element(range.Items, range.Items + half, range.Items + range.Count,
+				[axis](const BuildItem& a, const BuildItem& b) { return a.Center[axis] < b.Center[axis]; });
+			ranges[rangeCount++] = { range.Items + half, range.Count - half };
+			range.Count = half;
+		}
+	}
+
+	for (size_t lane = 0; lane < 4; lane++)
+		m_Nodes[index].Children[lane] = Empty;
+
+	// Children are created after their parent, so refitting nodes from the
+	// last to the first handles every child before its parent
+	for (size_t lane = 0; lane < rangeCount; lane++) {
+		const Range& range = ranges[lane];
+		uint32_t child;
+		if (range.Count <= LeafSize) {
+			uint32_t leaf = (uint32_t)m_Leaves.size();
+			m_Leaves.emplace_back();
+			Leaf& data = m_Leaves.back();
+			for (size_t slot = 0; slot < LeafSize; slot++) {
+				data.CenterX[slot] = data.CenterY[slot] = data.CenterZ[slot] = 0.0f;
+				data.ExtentX[slot] = data.ExtentY[slot] = data.ExtentZ[slot] = 0.0f;
+				data.Objects[slot] = slot < range.Count ? range.Items[slot].Object : Empty;
+			}
+			data.Parent = index * 4 + (uint32_t)lane;
+			child = LeafFlag | leaf << 3 | (uint32_t)range.Count;
+		}
+		else
+			child = BuildNode(range.Items, range.Count, index * 4 + (uint32_t)lane);
+		m_Nodes[index].Children[lane] = child;
+	}
+	return index;
+}
+
+void BVH::RefitNode(uint32_t index)
+{
+	Node& node = m_Nodes[index];
+	for (int lane = 0; lane < 4; lane++) {
+		uint32_t child = node.Children[lane];
+		Vec3 low(Huge), high(-Huge);
+		if (IsLeaf(child)) {
+			const Leaf& leaf = m_Leaves[GetLeafIndex(child)];
+			for (uint32_t slot = 0; slot < GetLeafCount(child); slot++) {
+				Vec3 center(leaf.CenterX[slot], leaf.CenterY[slot], leaf.CenterZ[slot]);
+				Vec3 extent(leaf.ExtentX[slot], leaf.ExtentY[slot], leaf.ExtentZ[slot]);
+				low = Min(low, center - extent);
+				high = Max(high, center + extent);
+			}
+		}
+		else if (child != Empty) {
+			const Node& childNode = m_Nodes[child];
+			for (int i = 0; i < 4; i++) {
+				low = Min(low, Vec3(childNode.MinX[i], childNode.MinY[i], childNode.MinZ[i]));
+				high = Max(high, Vec3(childNode.MaxX[i], childNode.MaxY[i], childNode.MaxZ[i]));
+			}
+		}
+		// Empty lanes keep an inverted box that is outside of every plane
+		node.MinX[lane] = low.x;
+		node.MinY[lane] = low.y;
+		node.MinZ[lane] = low.z;
+		node.MaxX[lane] = high.x;
+		node.MaxY[lane] = high.y;
+		node.MaxZ[lane] = high.z;
+	}
+}
+
+double BVH::ComputeCost() const
+{
+	double cost = 0.0;
+	for (const Node& node : m_Nodes) {
+		for (int lane = 0; lane < 4; lane++) {
+			if (node.Children[lane] == Empty)
+				continue;
+			double x = node.MaxX[lane] - node.MinX[lane];
+			double y = node.MaxY[lane] - node.MinY[lane];
+			double z = node.MaxZ[lane] - node.MinZ[lane];
+			cost += x * y + y * z + z * x;
+		}
+	}
+	return cost;
+}
+
+void BVH::SetSlot(uint32_t slot, const BoundsArrays& bounds, uint32_t object)
+{
+	Leaf& leaf = m_Leaves[slot / LeafSize];
+	slot %= LeafSize;
+	leaf.CenterX[slot] = bounds.CenterX[object];
+	leaf.CenterY[slot] = bounds.CenterY[object];
+	leaf.CenterZ[slot] = bounds.CenterZ[object];
+	leaf.ExtentX[slot] = bounds.ExtentX[object];
+	leaf.ExtentY[slot] = bounds.ExtentY[object];
+	leaf.ExtentZ[slot] = bounds.ExtentZ[object];
+}
+
+void BVH::Refit(const BoundsArrays& bounds)
+{
+	// Reading the objects in order and scattering them into the leaves only
+	// misses the cache on the leaves, which keep every box in two lines
+	for (uint32_t object = 0; object < m_ObjectCount; object++)
+		SetSlot(m_ObjectSlots[object], bounds, object);
+	for (size_t i = m_Nodes.size(); i-- > 0;)
+		RefitNode((uint32_t)i);
+	m_Cost = ComputeCost();
+}
+
+void BVH::Refit(const BoundsArrays& bounds, const uint32_t* moved, size_t movedCount)
+{
+	m_DirtyNodes.clear();
+	for (size_t i = 0; i < movedCount; i++) {
+		uint32_t object = moved[i];
+		uint32_t slot = m_ObjectSlots[object];
+		SetSlot(slot, bounds, object);
+
+		uint32_t node = m_Leaves[slot / LeafSize].Parent / 4;
+		while (!m_NodeDirty[node]) {
+			m_NodeDirty[node] = 1;
+			m_DirtyNodes.push_back(node);
+			if (m_Nodes[node].Parent == Empty)
+				break;
+			node = m_Nodes[node].Parent / 4;
+		}
+	}
+
+	std::sort(m_DirtyNodes.begin(), m_DirtyNodes.end(), [](uint32_t a, uint32_t b) { return a > b; });
+	for (uint32_t node : m_DirtyNodes) {
+		RefitNode(node);
+		m_NodeDirty[node] = 0;
+	}
+}
+
+void BVH::TestNode(const Node& node, const Frustum& frustum, int& outside, int& inside) const
+{
+#if MATH_SSE
+	const __m128 zero = _mm_setzero_ps();
+	__m128 anyOutside = zero;
+	__m128 allInside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	for (const Vec4& plane : frustum.Planes) {
+		// The corner furthest along the normal decides outside, the nearest
+		// one fully inside
+		const float* farX = plane.x >= 0.0f ? node.MaxX : node.MinX;
+		const float* farY = plane.y >= 0.0f ? node.MaxY : node.MinY;
+		const float* farZ = plane.z >= 0.0f ? node.MaxZ : node.MinZ;
+		const float* nearX = plane.x >= 0.0f ? node.MinX : node.MaxX;
+		const float* nearY = plane.y >= 0.0f ? node.MinY : node.MaxY;
+		const float* nearZ = plane.z >= 0.0f ? node.MinZ : node.MaxZ;
+
+		__m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z), d = _mm_set1_ps(plane.w);
+		__m128 farDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_load_ps(farX)), _mm_mul_ps(ny, _mm_load_ps(farY))),
+			_mm_add_ps(_mm_mul_ps(nz, _mm_load_ps(farZ)), d));
+		__m128 nearDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_load_ps(nearX)), _mm_mul_ps(ny, _mm_load_ps(nearY))),
+			_mm_add_ps(_mm_mul_ps(nz, _mm_load_ps(nearZ)), d));
+		anyOutside = _mm_or_ps(anyOutside, _mm_cmplt_ps(farDistance, zero));
+		allInside = _mm_and_ps(allInside, _mm_cmpge_ps(nearDistance, zero));
+	}
+	outside = _mm_movemask_ps(anyOutside);
+	inside = _mm_movemask_ps(allInside) & ~outside;
+#else
+	outside = 0;
+	inside = 0;
+	for (int lane = 0; lane < 4; lane++) {
+		bool laneOutside = false, laneInside = true;
+		for (const Vec4& plane : frustum.Planes) {
+			float farDistance = plane.w
+				+ plane.x * (plane.x >= 0.0f ? node.MaxX[lane] : node.MinX[lane])
+				+ plane.y * (plane.y >= 0.0f ? node.MaxY[lane] : node.MinY[lane])
+				+ plane.z * (plane.z >= 0.0f ? node.MaxZ[lane] : node.MinZ[lane]);
+			float nearDistance = plane.w
+				+ plane.x * (plane.x >= 0.0f ? node.MinX[lane] : node.MaxX[lane])
+				+ plane.y * (plane.y >= 0.0f ? node.MinY[lane] : node.MaxY[lane])
+				+ plane.z * (plane.z >= 0.0f ? node.MinZ[lane] : node.MaxZ[lane]);
+			laneOutside |= farDistance < 0.0f;
+			laneInside &= nearDistance >= 0.0f;
+		}
+		if (laneOutside)
+			outside |= 1 << lane;
+		else if (laneInside)
+			inside |= 1 << lane;
+	}
+#endif
+}
+
+void BVH::AppendAll(uint32_t child, std::vector<uint32_t>& visible) const
+{
+	uint32_t stack[MaxStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = child;
+	while (stackSize > 0) {
+		uint32_t current = stack[--stackSize];
+		if (IsLeaf(current)) {
+			const uint32_t* objects = m_Leaves[GetLeafIndex(current)].Objects;
+			visible.insert(visible.end(), objects, objects + GetLeafCount(current));
+			continue;
+		}
+		const Node& node = m_Nodes[current];
+		for (int lane = 3; lane >= 0; lane--) {
+			if (node.Children[lane] != Empty)
+				stack[stackSize++] = node.Children[lane];
+		}
+	}
+}
+
+void BVH::CullChild(uint32_t child, bool inside, const Frustum& frustum, std::vector<uint32_t>& visible, Stats& stats) const
+{
+	Task stack[MaxStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = { child, inside };
+	while (stackSize > 0) {
+		Task task = stack[--stackSize];
+		uint32_t current = task.Child;
+
+		if (task.Inside) {
+			AppendAll(current, visible);
+			continue;
+		}
+
+		if (IsLeaf(current)) {
+			const Leaf& leaf = m_Leaves[GetLeafIndex(current)];
+			uint32_t count = GetLeafCount(current);
+			stats.ObjectsTested += count;
+#if MATH_SSE
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			__m128 cx = _mm_load_ps(leaf.CenterX);
+			__m128 cy = _mm_load_ps(leaf.CenterY);
+			__m128 cz = _mm_load_ps(leaf.CenterZ);
+			__m128 ex = _mm_load_ps(leaf.ExtentX);
+			__m128 ey = _mm_load_ps(leaf.ExtentY);
+			__m128 ez = _mm_load_ps(leaf.ExtentZ);
+			__m128 anyOutside = zero;
+			for (const Vec4& plane : frustum.Planes) {
+				__m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z);
+				// Same test as Frustum::Intersects
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+					_mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(plane.w)));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex), _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+					_mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+				anyOutside = _mm_or_ps(anyOutside, _mm_cmplt_ps(distance, _mm_sub_ps(zero, radius)));
+			}
+			int visibleMask = ~_mm_movemask_ps(anyOutside) & ((1 << count) - 1);
+#else
+			int visibleMask = 0;
+			for (uint32_t i = 0; i < count; i++) {
+				Vec3 center(leaf.CenterX[i], leaf.CenterY[i], leaf.CenterZ[i]);
+				Vec3 extent(leaf.ExtentX[i], leaf.ExtentY[i], leaf.ExtentZ[i]);
+				if (frustum.Intersects(center, extent))
+					visibleMask |= 1 << i;
+			}
+#endif
+			for (uint32_t i = 0; i < count; i++) {
+				if (visibleMask & (1 << i))
+					visible.push_back(leaf.Objects[i]);
+			}
+			continue;
+		}
+
+		const Node& node = m_Nodes[current];
+		stats.NodesTested++;
+		int outside, insideMask;
+		TestNode(node, frustum, outside, insideMask);
+		// Pushed in reverse so the lanes come off the stack in order. Subtrees
+		// fully inside are appended when they come off without more tests.
+		for (int lane = 3; lane >= 0; lane--) {
+			if (!(outside & (1 << lane)))
+				stack[stackSize++] = { node.Children[lane], (insideMask & (1 << lane)) != 0 };
+		}
+	}
+}
+
+void BVH::Cull(const Frustum& frustum, std::vector<uint32_t>& visible, ThreadPool* pool)
+{
+	Timer timer;
+	m_Stats = Stats();
+	m_Stats.Objects = m_ObjectCount;
+	visible.clear();
+	if (m_Nodes.empty())
+		return;
+
+	if (!pool || pool->GetWorkerCount() == 0) {
+		CullChild(0, false, frustum, visible, m_Stats);
+	}
+	else {
+		// Test the first levels here until there are enough subtrees to give
+		// every thread several of them, then cull those in parallel
+		size_t target = (pool->GetWorkerCount() + 1) * 8;
+		m_Tasks.clear();
+		m_Tasks.push_back({ 0, false });
+		bool expanded = true;
+		while (m_Tasks.size() < target && expanded) {
+			expanded = false;
+			m_NextTasks.clear();
+			for (const Task& task : m_Tasks) {
+				if (task.Inside || IsLeaf(task.Child)) {
+					m_NextTasks.push_back(task);
+					continue;
+				}
+				const Node& node = m_Nodes[task.Child];
+				m_Stats.NodesTested++;
+				int outside, inside;
+				TestNode(node, frustum, outside, inside);
+				for (int lane = 0; lane < 4; lane++) {
+					if (!(outside & (1 << lane)))
+						m_NextTasks.push_back({ node.Children[lane], (inside & (1 << lane)) != 0 });
+				}
+				expanded = true;
+			}
+			std::swap(m_Tasks, m_NextTasks);
+		}
+
+		size_t taskCount = m_Tasks.size();
+		if (m_TaskVisible.size() < taskCount)
+			m_TaskVisible.resize(taskCount);
+		m_TaskStats.assign(taskCount, Stats());
+		pool->ParallelFor(taskCount, 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				m_TaskVisible[i].clear();
+				CullChild(m_Tasks[i].Child, m_Tasks[i].Inside, frustum, m_TaskVisible[i], m_TaskStats[i]);
+			}
+		});
+
+		size_t total = 0;
+		for (size_t i = 0; i < taskCount; i++)
+			total += m_TaskVisible[i].size();
+		visible.reserve(total);
+		for (size_t i = 0; i < taskCount; i++) {
+			visible.insert(visible.end(), m_TaskVisible[i].begin(), m_TaskVisible[i].end());
+			m_Stats.NodesTested += m_TaskStats[i].NodesTested;
+			m_Stats.ObjectsTested += m_TaskStats[i].ObjectsTested;
+		}
+	}
+
+	m_Stats.Visible = (unsigned int)visible.size();
+	m_Stats.Culled = m_ObjectCount - m_Stats.Visible;
+	m_Stats.Milliseconds = timer.ElapsedMilliseconds();
+}
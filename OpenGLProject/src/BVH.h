@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "VecMath.h"
+#include "TransformKernels.h"
+
+class ThreadPool;
+
+// Bounding volume hierarchy over the world space boxes of a scene's objects,
+// e.g. the WorldBounds written by TransformKernels. Nodes have four children
+// with their boxes side by side, so one SSE compare tests all four against a
+// frustum plane; leaves hold up to LeafSize objects whose boxes are copied in
+// leaf order for the same reason.
+//
+// Build() once for a set of objects. When they move, Refit() updates the
+// boxes without changing the tree, for every object or only the ones given.
+// Refitting lets boxes overlap more and more; once GetRefitCostRatio() has
+// grown well past 1, another Build() pays for itself.
+class BVH {
+public:
+	static const unsigned int LeafSize = 4;
+
+	struct Stats
+	{
+		unsigned int Objects = 0;
+		unsigned int NodesTested = 0;
+		unsigned int ObjectsTested = 0;
+		unsigned int Visible = 0;
+		unsigned int Culled = 0;
+		double Milliseconds = 0.0;
+	};
+private:
+	struct alignas(16) Node
+	{
+		float MinX[4], MinY[4], MinZ[4];
+		float MaxX[4], MaxY[4], MaxZ[4];
+		// A node index, LeafFlag | leaf index << 3 | object count, or Empty
+		uint32_t Children[4];
+		// Parent node * 4 + lane, Empty for the root
+		uint32_t Parent;
+	};
+
+	// Boxes of up to LeafSize objects side by side, like a Node's children
+	struct alignas(16) Leaf
+	{
+		float CenterX[4], CenterY[4], CenterZ[4];
+		float ExtentX[4], ExtentY[4], ExtentZ[4];
+		uint32_t Objects[4];
+		uint32_t Parent;
+	};
+
+	struct Task
+	{
+		uint32_t Child;
+		bool Inside;
+	};
+
+	std::vector<Node> m_Nodes;
+	std::vector<Leaf> m_Leaves;
+	// Leaf * LeafSize + slot of every object
+	std::vector<uint32_t> m_ObjectSlots;
+	uint32_t m_ObjectCount;
+
+	double m_BuildCost;
+	double m_Cost;
+
+	std::vector<Task> m_Tasks;
+	std::vector<Task> m_NextTasks;
+	std::vector<std::vector<uint32_t>> m_TaskVisible;
+	std::vector<Stats> m_TaskStats;
+	std::vector<uint32_t> m_DirtyNodes;
+	std::vector<unsigned char> m_NodeDirty;
+	Stats m_Stats;
+
+	struct BuildItem;
+
+	uint32_t BuildNode(BuildItem* items, size_t count, uint32_t parent);
+	void SetSlot(uint32_t slot, const BoundsArrays& bounds, uint32_t object);
+	void RefitNode(uint32_t node);
+	double ComputeCost() const;
+
+	// Bit n of the masks is lane n
+	void TestNode(const Node& node, const Frustum& frustum, int& outside, int& inside) const;
+	void AppendAll(uint32_t child, std::vector<uint32_t>& visible) const;
+	void CullChild(uint32_t child, bool inside, const Frustum& frustum, std::vector<uint32_t>& visible, Stats& stats) const;
+public:
+	BVH();
+
+	void Build(const BoundsArrays& bounds);
+	// bounds has to hold the same objects as at Build()
+	void Refit(const BoundsArrays& bounds);
+	// Only updates the boxes of moved and the nodes above them
+	void Refit(const BoundsArrays& bounds, const uint32_t* moved, size_t movedCount);
+
+	// Replaces visible with the indices of the objects whose box intersects
+	// the frustum, in tree order. With a pool the subtrees below the first
+	// levels are traversed in parallel.
+	void Cull(const Frustum& frustum, std::vector<uint32_t>& visible, ThreadPool* pool = nullptr);
+
+	inline unsigned int GetObjectCount() const { return m_ObjectCount; }
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_Nodes.size(); }
+	// Surface area of every box now over the same sum at Build(), updated by
+	// the full Refit()
+	inline double GetRefitCostRatio() const { return m_BuildCost > 0.0 ? m_Cost / m_BuildCost : 1.0; }
+	// Of the last Cull()
+	inline const Stats& GetStats() const { return m_Stats; }
+};
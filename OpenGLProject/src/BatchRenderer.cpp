@@ -0,0 +1,163 @@
+#include "BatchRenderer.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+static const float s_White[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+static const float s_FullTexCoords[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+BatchRenderer::BatchRenderer(unsigned int maxQuads)
+	: m_MaxQuads(maxQuads), m_VertexPtr(nullptr), m_QuadCount(0), m_TextureSlotCount(1)
+{
+	// 4 vertices per quad have to stay addressable by 32-bit indices
+	ASSERT(maxQuads > 0 && maxQuads <= 0x3FFFFFFF / 6);
+
+	m_Vertices.resize((size_t)maxQuads * 4);
+	m_VertexBuffer = std::make_unique<VertexBuffer>((unsigned int)(m_Vertices.size() * sizeof(QuadVertex)));
+
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	layout.Push<float>(4);
+	layout.Push<float>(2);
+	layout.Push<float>(1);
+	m_VertexArray.AddBuffer(*m_VertexBuffer, layout);
+
+	// Every quad uses the same index pattern, so the index buffer is built once
+	std::vector<unsigned int> indices((size_t)maxQuads * 6);
+	unsigned int vertex = 0;
+	for (size_t i = 0; i < indices.size(); i += 6) {
+		indices[i + 0] = vertex + 0;
+		indices[i + 1] = vertex + 1;
+		indices[i + 2] = vertex + 2;
+		indices[i + 3] = vertex + 2;
+		indices[i + 4] = vertex + 3;
+		indices[i + 5] = vertex + 0;
+		vertex += 4;
+	}
+	// The element buffer binding is stored in the VAO
+	m_VertexArray.Bind();
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+	m_VertexArray.Unbind();
+
+	// Slot 0 is a 1x1 white texture so flat colored and textured quads share a batch
+	unsigned int white = 0xFFFFFFFF;
+	GLCall(glGenTextures(1, &m_WhiteTexture));
+	GLState::BindTextureUnit(0, GL_TEXTURE_2D, m_WhiteTexture);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white));
+
+	int maxUnits = 0;
+	GLCall(glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits));
+	m_SlotLimit = maxUnits < (int)MaxTextureSlots ? (unsigned int)maxUnits : MaxTextureSlots;
+
+	m_TextureSlots.fill(0);
+	m_TextureSlots[0] = m_WhiteTexture;
+
+	Begin();
+}
+
+BatchRenderer::~BatchRenderer()
+{
+	GLCall(glDeleteTextures(1, &m_WhiteTexture));
+	GLState::OnTextureDeleted(m_WhiteTexture);
+}
+
+void BatchRenderer::Begin()
+{
+	m_VertexPtr = m_Vertices.data();
+	m_QuadCount = 0;
+	m_TextureSlotCount = 1;
+}
+
+void BatchRenderer::End()
+{
+	Flush();
+}
+
+void BatchRenderer::Flush()
+{
+	if (m_QuadCount == 0)
+		return;
+
+	PROFILE_FUNCTION();
+	unsigned int size = (unsigned int)((unsigned char*)m_VertexPtr - (unsigned char*)m_Vertices.data());
+	m_VertexBuffer->SetData(m_Vertices.data(), size);
+
+	for (unsigned int i = 0; i < m_TextureSlotCount; i++)
+		GLState::BindTextureUnit(i, GL_TEXTURE_2D, m_TextureSlots[i]);
+
+	m_VertexArray.Bind();
+	GLCall(glDrawElements(GL_TRIANGLES, m_QuadCount * 6, m_IndexBuffer->GetType(), nullptr));
+
+	m_Stats.FlushCount++;
+	m_Stats.BytesUploaded += size;
+
+	Begin();
+}
+
+float BatchRenderer::FindTextureSlot(unsigned int textureID)
+{
+	for (unsigned int i = 0; i < m_TextureSlotCount; i++) {
+		if (m_TextureSlots[i] == textureID)
+			return (float)i;
+	}
+
+	if (m_TextureSlotCount >= m_SlotLimit)
+		Flush();
+
+	m_TextureSlots[m_TextureSlotCount] = textureID;
+	return (float)m_TextureSlotCount++;
+}
+
+void BatchRenderer::PushQuad(float x, float y, float z, float width, float height, const float color[4], const float texCoords[4], float texIndex)
+{
+	const float positions[4][2] = {
+		{ x,         y          },
+		{ x + width, y          },
+		{ x + width, y + height },
+		{ x,         y + height }
+	};
+	const float uvs[4][2] = {
+		{ texCoords[0], texCoords[1] },
+		{ texCoords[2], texCoords[1] },
+		{ texCoords[2], texCoords[3] },
+		{ texCoords[0], texCoords[3] }
+	};
+
+	for (int i = 0; i < 4; i++) {
+		QuadVertex& v = m_VertexPtr[i];
+		v.Position[0] = positions[i][0];
+		v.Position[1] = positions[i][1];
+		v.Position[2] = z;
+		v.Color[0] = color[0];
+		v.Color[1] = color[1];
+		v.Color[2] = color[2];
+		v.Color[3] = color[3];
+		v.TexCoord[0] = uvs[i][0];
+		v.TexCoord[1] = uvs[i][1];
+		v.TexIndex = texIndex;
+	}
+
+	m_VertexPtr += 4;
+	m_QuadCount++;
+	m_Stats.QuadCount++;
+}
+
+void BatchRenderer::DrawQuad(float x, float y, float z, float width, float height, const float color[4])
+{
+	if (m_QuadCount >= m_MaxQuads)
+		Flush();
+
+	PushQuad(x, y, z, width, height, color, s_FullTexCoords, 0.0f);
+}
+
+void BatchRenderer::DrawQuad(float x, float y, float z, float width, float height, unsigned int textureID, const float texCoords[4], const float tint[4])
+{
+	if (m_QuadCount >= m_MaxQuads)
+		Flush();
+
+	// Looking up the slot may flush, which resets the quad count as well
+	float texIndex = FindTextureSlot(textureID);
+	PushQuad(x, y, z, width, height, tint ? tint : s_White, texCoords ? texCoords : s_FullTexCoords, texIndex);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+struct QuadVertex
+{
+	float Position[3];
+	float Color[4];
+	float TexCoord[2];
+	float TexIndex;
+};
+
+// Collects quads into one CPU-side vertex array and draws them with as few
+// glDrawElements calls as possible. A flush happens when the vertex array is
+// full, when every texture slot is in use, or when End() is called.
+//
+// The caller binds the shader program (see Batch.shader.*) before End() and
+// sets its u_Textures sampler array to 0..MaxTextureSlots-1 once.
+class BatchRenderer {
+public:
+	static const unsigned int MaxTextureSlots = 16;
+
+	struct Stats
+	{
+		unsigned int QuadCount = 0;
+		unsigned int FlushCount = 0;
+		unsigned long long BytesUploaded = 0;
+	};
+private:
+	unsigned int m_MaxQuads;
+
+	VertexArray m_VertexArray;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+	std::vector<QuadVertex> m_Vertices;
+	QuadVertex* m_VertexPtr;
+	unsigned int m_QuadCount;
+
+	unsigned int m_WhiteTexture;
+	std::array<unsigned int, MaxTextureSlots> m_TextureSlots;
+	unsigned int m_TextureSlotCount;
+	unsigned int m_SlotLimit;
+
+	Stats m_Stats;
+
+	float FindTextureSlot(unsigned int textureID);
+	void PushQuad(float x, float y, float z, float width, float height, const float color[4], const float texCoords[4], float texIndex);
+public:
+	BatchRenderer(unsigned int maxQuads = 10000);
+	~BatchRenderer();
+
+	BatchRenderer(const BatchRenderer&) = delete;
+	BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+	void Begin();
+	void End();
+	void Flush();
+
+	// Flat colored quad; (x, y, z) is the bottom-left corner
+	void DrawQuad(float x, float y, float z, float width, float height, const float color[4]);
+	// Textured quad; texCoords is { u0, v0, u1, v1 } or nullptr for the whole texture
+	void DrawQuad(float x, float y, float z, float width, float height, unsigned int textureID, const float texCoords[4] = nullptr, const float tint[4] = nullptr);
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+	inline unsigned int GetMaxQuads() const { return m_MaxQuads; }
+};
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+
+	struct Entry
+	{
+		const char* name;
+		BenchmarkFn fn;
+	};
+
+	// Function-local so registration works regardless of static init order
+	static std::vector<Entry>& GetRegistry()
+	{
+		static std::vector<Entry> registry;
+		return registry;
+	}
+
+	static const char* s_Current = "";
+	static unsigned int s_FailedChecks = 0;
+
+	bool Register(const char* name, BenchmarkFn fn)
+	{
+		GetRegistry().push_back({ name, fn });
+		return true;
+	}
+
+	int Run(const std::string& filter)
+	{
+		int ran = 0;
+		for (const Entry& entry : GetRegistry()) {
+			if (!filter.empty() && std::string(entry.name).find(filter) == std::string::npos)
+				continue;
+
+			std::cout << "[" << entry.name << "]" << std::endl;
+			s_Current = entry.name;
+			entry.fn();
+			s_Current = "";
+			ran++;
+		}
+
+		if (ran == 0)
+			std::cout << "No benchmark matches '" << filter << "'" << std::endl;
+		if (s_FailedChecks > 0)
+			std::cout << s_FailedChecks << " checks failed" << std::endl;
+		return ran;
+	}
+
+	void Report(const std::string& metric, double value, const char* unit)
+	{
+		std::cout << "  " << std::left << std::setw(40) << metric << std::right
+			<< std::setw(14) << std::fixed << std::setprecision(3) << value << " " << unit << std::endl;
+	}
+
+	double TimeMilliseconds(const std::function<void()>& fn, int repeats)
+	{
+		fn();
+		Timer timer;
+		for (int i = 0; i < repeats; i++)
+			fn();
+		return timer.ElapsedMilliseconds() / repeats;
+	}
+
+	bool Check(const std::string& what, bool passed)
+	{
+		std::cout << "  " << std::left << std::setw(40) << what << std::right << std::setw(14) << (passed ? "ok" : "FAILED") << std::endl;
+		if (!passed) {
+			std::cout << "  check failed in " << s_Current << std::endl;
+			s_FailedChecks++;
+		}
+		return passed;
+	}
+
+	unsigned int GetFailedCheckCount()
+	{
+		return s_FailedChecks;
+	}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "Timer.h"
+
+// Benchmarks run inside the application after the GL context is created:
+//   OpenGLProject --benchmark [name filter]
+// Each BENCHMARK(Name) body is registered at static initialization time and
+// reports its measurements with Benchmark::Report(). Correctness checks go
+// through Benchmark::Check(); a failed check makes the run exit non-zero.
+
+namespace Benchmark {
+
+	typedef void (*BenchmarkFn)();
+
+	bool Register(const char* name, BenchmarkFn fn);
+	int Run(const std::string& filter);
+
+	void Report(const std::string& metric, double value, const char* unit);
+	// Average of repeats runs of fn, after one untimed run so every page fn
+	// writes is already touched
+	double TimeMilliseconds(const std::function<void()>& fn, int repeats = 5);
+	// Returns passed
+	bool Check(const std::string& what, bool passed);
+	unsigned int GetFailedCheckCount();
+
+}
+
+#define BENCHMARK(name) \
+	static void Benchmark_##name(); \
+	static bool s_Benchmark_##name##_Registered = Benchmark::Register(#name, Benchmark_##name); \
+	static void Benchmark_##name()
@@ -0,0 +1,323 @@
+#include <cstring>
+#include <new>
+
+#include "CommandBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "Mesh.h"
+#include "UniformBuffer.h"
+
+enum class CommandType : unsigned char
+{
+	Clear,
+	Viewport,
+	SetBlend,
+	SetDepthTest,
+	Uniform,
+	UniformBufferData,
+	Draw,
+	DrawInstanced,
+	Callback
+};
+
+enum UniformType : unsigned char
+{
+	Uniform1i,
+	Uniform1iv,
+	Uniform1f,
+	Uniform2f,
+	Uniform3f,
+	Uniform4f,
+	UniformMat4
+};
+
+struct CommandBuffer::Command
+{
+	CommandType Type;
+	Command* Next;
+};
+
+namespace {
+
+	struct ClearCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::Clear;
+	};
+
+	struct ViewportCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::Viewport;
+		int X, Y, Width, Height;
+	};
+
+	struct SetBlendCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::SetBlend;
+		bool Enabled;
+	};
+
+	struct SetDepthTestCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::SetDepthTest;
+		bool Enabled;
+	};
+
+	// The value follows the name in the allocator
+	struct UniformCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::Uniform;
+		Shader* Target;
+		const char* Name;
+		const void* Value;
+		unsigned char ValueType;
+		int Count;
+	};
+
+	struct UniformBufferDataCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::UniformBufferData;
+		UniformBuffer* Buffer;
+		const void* Data;
+		unsigned int Size;
+		unsigned int Offset;
+	};
+
+	struct DrawCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::Draw;
+		const VertexArray* VAO;
+		const IndexBuffer* IBO;
+		const Shader* Program;
+	};
+
+	struct DrawInstancedCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::DrawInstanced;
+		Mesh* Target;
+		const VertexBuffer* Instances;
+		const VertexBufferLayout* Layout;
+		unsigned int InstanceCount;
+		const Shader* Program;
+	};
+
+	struct CallbackCommand : CommandBuffer::Command
+	{
+		static const CommandType Kind = CommandType::Callback;
+		CommandBuffer::CallbackFn Function;
+		const void* Data;
+	};
+
+}
+
+CommandBuffer::CommandBuffer(size_t pageSize)
+	: m_Allocator(pageSize), m_First(nullptr), m_Last(nullptr), m_CommandCount(0)
+{
+}
+
+template<typename T>
+T* CommandBuffer::Push()
+{
+	T* command = new (m_Allocator.Allocate(sizeof(T), alignof(T))) T();
+	command->Type = T::Kind;
+	command->Next = nullptr;
+	if (m_Last)
+		m_Last->Next = command;
+	else
+		m_First = command;
+	m_Last = command;
+	m_CommandCount++;
+	return command;
+}
+
+void CommandBuffer::PushUniform(Shader& shader, const std::string& name, unsigned char type, int count, const void* value, unsigned int size)
+{
+	UniformCommand* command = Push<UniformCommand>();
+	char* copiedName = (char*)m_Allocator.Allocate(name.size() + 1, 1);
+	memcpy(copiedName, name.c_str(), name.size() + 1);
+	void* copiedValue = m_Allocator.Allocate(size, 4);
+	memcpy(copiedValue, value, size);
+
+	command->Target = &shader;
+	command->Name = copiedName;
+	command->Value = copiedValue;
+	command->ValueType = type;
+	command->Count = count;
+}
+
+void CommandBuffer::Clear()
+{
+	Push<ClearCommand>();
+}
+
+void CommandBuffer::Viewport(int x, int y, int width, int height)
+{
+	ViewportCommand* command = Push<ViewportCommand>();
+	command->X = x;
+	command->Y = y;
+	command->Width = width;
+	command->Height = height;
+}
+
+void CommandBuffer::SetBlend(bool enabled)
+{
+	Push<SetBlendCommand>()->Enabled = enabled;
+}
+
+void CommandBuffer::SetDepthTest(bool enabled)
+{
+	Push<SetDepthTestCommand>()->Enabled = enabled;
+}
+
+void CommandBuffer::SetUniform1i(Shader& shader, const std::string& name, int value)
+{
+	PushUniform(shader, name, Uniform1i, 1, &value, sizeof(value));
+}
+
+void CommandBuffer::SetUniform1iv(Shader& shader, const std::string& name, int count, const int* values)
+{
+	PushUniform(shader, name, Uniform1iv, count, values, sizeof(int) * count);
+}
+
+void CommandBuffer::SetUniform1f(Shader& shader, const std::string& name, float value)
+{
+	PushUniform(shader, name, Uniform1f, 1, &value, sizeof(value));
+}
+
+void CommandBuffer::SetUniform2f(Shader& shader, const std::string& name, float v0, float v1)
+{
+	const float values[2] = { v0, v1 };
+	PushUniform(shader, name, Uniform2f, 1, values, sizeof(values));
+}
+
+void CommandBuffer::SetUniform3f(Shader& shader, const std::string& name, float v0, float v1, float v2)
+{
+	const float values[3] = { v0, v1, v2 };
+	PushUniform(shader, name, Uniform3f, 1, values, sizeof(values));
+}
+
+void CommandBuffer::SetUniform4f(Shader& shader, const std::string& name, float v0, float v1, float v2, float v3)
+{
+	const float values[4] = { v0, v1, v2, v3 };
+	PushUniform(shader, name, Uniform4f, 1, values, sizeof(values));
+}
+
+void CommandBuffer::SetUniformMat4(Shader& shader, const std::string& name, const float* matrix)
+{
+	PushUniform(shader, name, UniformMat4, 1, matrix, sizeof(float) * 16);
+}
+
+void CommandBuffer::SetUniformBufferData(UniformBuffer& buffer, const void* data, unsigned int size, unsigned int offset)
+{
+	UniformBufferDataCommand* command = Push<UniformBufferDataCommand>();
+	void* copied = m_Allocator.Allocate(size, 16);
+	memcpy(copied, data, size);
+
+	command->Buffer = &buffer;
+	command->Data = copied;
+	command->Size = size;
+	command->Offset = offset;
+}
+
+void CommandBuffer::Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader)
+{
+	DrawCommand* command = Push<DrawCommand>();
+	command->VAO = &vao;
+	command->IBO = &ibo;
+	command->Program = &shader;
+}
+
+void CommandBuffer::Draw(const Mesh& mesh, const Shader& shader)
+{
+	Draw(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader);
+}
+
+void CommandBuffer::DrawInstanced(Mesh& mesh, const VertexBuffer& instances, const VertexBufferLayout& layout, unsigned int instanceCount, const Shader& shader)
+{
+	DrawInstancedCommand* command = Push<DrawInstancedCommand>();
+	command->Target = &mesh;
+	command->Instances = &instances;
+	command->Layout = &layout;
+	command->InstanceCount = instanceCount;
+	command->Program = &shader;
+}
+
+void CommandBuffer::Callback(CallbackFn fn, const void* data, unsigned int size)
+{
+	CallbackCommand* command = Push<CallbackCommand>();
+	command->Function = fn;
+	command->Data = nullptr;
+	if (size > 0) {
+		void* copied = m_Allocator.Allocate(size);
+		memcpy(copied, data, size);
+		command->Data = copied;
+	}
+}
+
+static void ExecuteUniform(const UniformCommand& command)
+{
+	const float* f = (const float*)command.Value;
+	Shader& shader = *command.Target;
+	switch (command.ValueType) {
+	case Uniform1i:   shader.SetUniform1i(command.Name, *(const int*)command.Value); break;
+	case Uniform1iv:  shader.SetUniform1iv(command.Name, command.Count, (const int*)command.Value); break;
+	case Uniform1f:   shader.SetUniform1f(command.Name, f[0]); break;
+	case Uniform2f:   shader.SetUniform2f(command.Name, f[0], f[1]); break;
+	case Uniform3f:   shader.SetUniform3f(command.Name, f[0], f[1], f[2]); break;
+	case Uniform4f:   shader.SetUniform4f(command.Name, f[0], f[1], f[2], f[3]); break;
+	case UniformMat4: shader.SetUniformMat4(command.Name, f); break;
+	}
+}
+
+void CommandBuffer::Execute(const Renderer& renderer) const
+{
+	for (const Command* command = m_First; command; command = command->Next) {
+		switch (command->Type) {
+		case CommandType::Clear:
+			renderer.Clear();
+			break;
+		case CommandType::Viewport: {
+			const ViewportCommand* viewport = (const ViewportCommand*)command;
+			GLState::Viewport(viewport->X, viewport->Y, viewport->Width, viewport->Height);
+			break;
+		}
+		case CommandType::SetBlend:
+			GLState::SetBlend(((const SetBlendCommand*)command)->Enabled);
+			break;
+		case CommandType::SetDepthTest:
+			GLState::SetDepthTest(((const SetDepthTestCommand*)command)->Enabled);
+			break;
+		case CommandType::Uniform:
+			ExecuteUniform(*(const UniformCommand*)command);
+			break;
+		case CommandType::UniformBufferData: {
+			const UniformBufferDataCommand* data = (const UniformBufferDataCommand*)command;
+			data->Buffer->SetData(data->Data, data->Size, data->Offset);
+			break;
+		}
+		case CommandType::Draw: {
+			const DrawCommand* draw = (const DrawCommand*)command;
+			renderer.Draw(*draw->VAO, *draw->IBO, *draw->Program);
+			break;
+		}
+		case CommandType::DrawInstanced: {
+			const DrawInstancedCommand* draw = (const DrawInstancedCommand*)command;
+			renderer.DrawInstanced(*draw->Target, *draw->Instances, *draw->Layout, draw->InstanceCount, *draw->Program);
+			break;
+		}
+		case CommandType::Callback: {
+			const CallbackCommand* callback = (const CallbackCommand*)command;
+			callback->Function(callback->Data);
+			break;
+		}
+		}
+	}
+}
+
+void CommandBuffer::Reset()
+{
+	m_Allocator.Reset();
+	m_First = nullptr;
+	m_Last = nullptr;
+	m_CommandCount = 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+
+#include "LinearAllocator.h"
+
+class Renderer;
+class VertexArray;
+class IndexBuffer;
+class VertexBuffer;
+class VertexBufferLayout;
+class Shader;
+class Mesh;
+class UniformBuffer;
+
+// Draws, state changes and uniform updates recorded on any thread and
+// replayed by Execute() on the thread that owns the GL context. Commands
+// and everything they carry (uniform values, buffer contents, uniform
+// names) are copied into the buffer's LinearAllocator, so the recording
+// side may change its data right away. The objects commands refer to must
+// stay alive until the replay has finished.
+//
+// One CommandBuffer is recorded by one thread at a time; record on several
+// threads with one buffer each.
+class CommandBuffer {
+public:
+	typedef void (*CallbackFn)(const void* data);
+
+	struct Command;
+private:
+	LinearAllocator m_Allocator;
+	Command* m_First;
+	Command* m_Last;
+	unsigned int m_CommandCount;
+
+	template<typename T>
+	T* Push();
+	void PushUniform(Shader& shader, const std::string& name, unsigned char type, int count, const void* value, unsigned int size);
+public:
+	explicit CommandBuffer(size_t pageSize = 64 * 1024);
+
+	CommandBuffer(const CommandBuffer&) = delete;
+	CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+	void Clear();
+	void Viewport(int x, int y, int width, int height);
+	void SetBlend(bool enabled);
+	void SetDepthTest(bool enabled);
+
+	void SetUniform1i(Shader& shader, const std::string& name, int value);
+	void SetUniform1iv(Shader& shader, const std::string& name, int count, const int* values);
+	void SetUniform1f(Shader& shader, const std::string& name, float value);
+	void SetUniform2f(Shader& shader, const std::string& name, float v0, float v1);
+	void SetUniform3f(Shader& shader, const std::string& name, float v0, float v1, float v2);
+	void SetUniform4f(Shader& shader, const std::string& name, float v0, float v1, float v2, float v3);
+	void SetUniformMat4(Shader& shader, const std::string& name, const float* matrix);
+	void SetUniformBufferData(UniformBuffer& buffer, const void* data, unsigned int size, unsigned int offset = 0);
+
+	void Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader);
+	void Draw(const Mesh& mesh, const Shader& shader);
+	void DrawInstanced(Mesh& mesh, const VertexBuffer& instances, const VertexBufferLayout& layout, unsigned int instanceCount, const Shader& shader);
+
+	// Runs fn with a copy of size bytes of data during the replay, for GL
+	// work there is no command for
+	void Callback(CallbackFn fn, const void* data = nullptr, unsigned int size = 0);
+
+	void Execute(const Renderer& renderer) const;
+	// Drops every command and rewinds the allocator
+	void Reset();
+
+	inline unsigned int GetCommandCount() const { return m_CommandCount; }
+	inline size_t GetBytesUsed() const { return m_Allocator.GetBytesUsed(); }
+};
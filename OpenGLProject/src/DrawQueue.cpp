@@ -0,0 +1,178 @@
+#include <algorithm>
+
+#include "DrawQueue.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Timer.h"
+#include "Profiler.h"
+
+static const unsigned int DepthBits = 19;
+static const uint64_t DepthMax = (1u << DepthBits) - 1;
+
+DrawQueue::DrawQueue()
+	: m_MaterialUniforms(sizeof(MaterialUniforms), UniformBlock::Material)
+{
+}
+
+uint64_t DrawQueue::MakeKey(unsigned int pass, const Material& material, const VertexArray& vao, float depth)
+{
+	uint64_t quantized = (uint64_t)(std::min(std::max(depth, 0.0f), 1.0f) * DepthMax);
+	uint64_t shader = material.Program ? material.Program->GetRendererID() & 0xFFF : 0;
+	// Same texture first, then the same Material among those
+	uint64_t materialID = ((material.Texture & 0xFF) << 8) | (((uintptr_t)&material / sizeof(Material)) & 0xFF);
+	uint64_t vertexArray = vao.GetRendererID() & 0xFFF;
+
+	uint64_t key = (uint64_t)(pass & 0xF) << 60;
+	if (material.Translucent) {
+		key |= 1ull << 59;
+		key |= (DepthMax - quantized) << 40;
+		key |= shader << 28;
+		key |= materialID << 12;
+		key |= vertexArray;
+	}
+	else {
+		key |= shader << 47;
+		key |= materialID << 31;
+		key |= vertexArray << 19;
+		key |= quantized;
+	}
+	return key;
+}
+
+void DrawQueue::Submit(const VertexArray& vao, const IndexBuffer& ibo, const Material& material, float depth, unsigned int pass,
+	unsigned int indexCount, unsigned int firstIndex, int baseVertex)
+{
+	ASSERT(material.Program);
+	ASSERT(firstIndex + indexCount <= ibo.GetCount());
+
+	Item item;
+	item.VAO = &vao;
+	item.IBO = &ibo;
+	item.Mat = &material;
+	item.IndexCount = (int)(indexCount ? indexCount : ibo.GetCount() - firstIndex);
+	item.FirstIndex = firstIndex;
+	item.BaseVertex = baseVertex;
+
+	m_Entries.push_back({ MakeKey(pass, material, vao, depth), (uint32_t)m_Items.size() });
+	m_Items.push_back(item);
+}
+
+// LSD radix sort over bytes. Stable, so draws with equal keys keep their
+// submission order. Bytes that are the same in every key (e.g. the pass in
+// a single pass frame) are skipped.
+void DrawQueue::RadixSort()
+{
+	size_t count = m_Entries.size();
+	m_Scratch.resize(count);
+
+	uint32_t histograms[8][256] = {};
+	for (const SortEntry& entry : m_Entries) {
+		for (int digit = 0; digit < 8; digit++)
+			histograms[digit][(entry.Key >> (digit * 8)) & 0xFF]++;
+	}
+
+	SortEntry* source = m_Entries.data();
+	SortEntry* destination = m_Scratch.data();
+	for (int digit = 0; digit < 8; digit++) {
+		uint32_t* histogram = histograms[digit];
+		if (histogram[(source[0].Key >> (digit * 8)) & 0xFF] == count)
+			continue;
+
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+		for (size_t i = 0; i < count; i++) {
+			const SortEntry& entry = source[i];
+			destination[histogram[(entry.Key >> (digit * 8)) & 0xFF]++] = entry;
+		}
+		std::swap(source, destination);
+	}
+
+	if (source != m_Entries.data())
+		m_Entries.swap(m_Scratch);
+}
+
+static void CountStateChange(DrawQueue::StateChanges& changes, const Material* previous, const void* previousVAO, const Material& material, const void* vao)
+{
+	if (!previous || previous->Program != material.Program)
+		changes.Programs++;
+	if (previousVAO != vao)
+		changes.VertexArrays++;
+	if (!previous || previous->Texture != material.Texture)
+		changes.Textures++;
+	if (previous != &material)
+		changes.Materials++;
+}
+
+void DrawQueue::Flush(const Renderer& renderer, bool sort)
+{
+	PROFILE_FUNCTION();
+	if (m_Items.empty())
+		return;
+
+	const Material* previous = nullptr;
+	const VertexArray* previousVAO = nullptr;
+	for (const Item& item : m_Items) {
+		CountStateChange(m_Stats.Submitted, previous, previousVAO, *item.Mat, item.VAO);
+		previous = item.Mat;
+		previousVAO = item.VAO;
+	}
+
+	if (sort) {
+		Timer timer;
+		RadixSort();
+		m_Stats.SortMilliseconds += timer.ElapsedMilliseconds();
+	}
+
+	m_MaterialUniforms.Bind();
+	previous = nullptr;
+	previousVAO = nullptr;
+	size_t count = m_Entries.size();
+	for (size_t begin = 0; begin < count;) {
+		const Item& first = m_Items[m_Entries[begin].Index];
+		const Material& material = *first.Mat;
+
+		// Gather every following draw with the same state
+		m_Counts.clear();
+		m_Offsets.clear();
+		m_BaseVertices.clear();
+		size_t end = begin;
+		for (; end < count; end++) {
+			const Item& item = m_Items[m_Entries[end].Index];
+			if (item.VAO != first.VAO || item.IBO != first.IBO || item.Mat != first.Mat)
+				break;
+			m_Counts.push_back(item.IndexCount);
+			m_Offsets.push_back((const void*)((uintptr_t)item.FirstIndex * item.IBO->GetIndexSize()));
+			m_BaseVertices.push_back(item.BaseVertex);
+		}
+
+		CountStateChange(m_Stats.Issued, previous, previousVAO, material, first.VAO);
+		if (previous != &material) {
+			m_MaterialUniforms.SetData(&material.Uniforms, sizeof(MaterialUniforms));
+			GLState::BindTextureUnit(0, GL_TEXTURE_2D, material.Texture);
+			GLState::SetBlend(material.Translucent);
+			GLState::DepthMask(!material.Translucent);
+			if (material.Translucent)
+				GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+		previous = &material;
+		previousVAO = first.VAO;
+
+		renderer.MultiDraw(*first.VAO, *first.IBO, *material.Program,
+			m_Counts.data(), m_Offsets.data(), m_BaseVertices.data(), (unsigned int)m_Counts.size());
+		m_Stats.DrawCalls++;
+		begin = end;
+	}
+	m_Stats.Draws += (unsigned int)count;
+
+	GLState::SetBlend(false);
+	GLState::DepthMask(true);
+	m_Items.clear();
+	m_Entries.clear();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "UniformBuffer.h"
+
+class Renderer;
+class VertexArray;
+class IndexBuffer;
+class Shader;
+
+// Everything about a draw except its geometry. Draws with the same Material
+// share one upload of its uniforms to the Material block.
+struct Material
+{
+	Shader* Program = nullptr;
+	// GL texture name bound to unit 0, 0 for none
+	unsigned int Texture = 0;
+	MaterialUniforms Uniforms = {};
+	// Blended, without depth writes, after the opaque draws of its pass
+	bool Translucent = false;
+};
+
+// Collects the draws of a frame and submits them sorted by a packed 64-bit
+// key, so draws sharing state end up next to each other:
+//
+//   opaque       pass:4 | 0 | shader:12 | material:16 | vertex array:12 | depth:19
+//   translucent  pass:4 | 1 | far to near depth:19 | shader:12 | material:16 | vertex array:12
+//
+// The ids in the key are the low bits of GL names and only decide the order.
+// Neighbouring draws whose vertex array, index buffer and Material are
+// actually the same go out as one glMultiDrawElementsBaseVertex, with that
+// index buffer bound to the vertex array.
+class DrawQueue {
+public:
+	struct StateChanges
+	{
+		unsigned int Programs = 0;
+		unsigned int VertexArrays = 0;
+		unsigned int Textures = 0;
+		unsigned int Materials = 0;
+	};
+
+	struct Stats
+	{
+		unsigned int Draws = 0;
+		unsigned int DrawCalls = 0;
+		// Changes the draws would have needed in the order they were submitted
+		StateChanges Submitted;
+		StateChanges Issued;
+		double SortMilliseconds = 0.0;
+	};
+private:
+	struct Item
+	{
+		const VertexArray* VAO;
+		const IndexBuffer* IBO;
+		const Material* Mat;
+		int IndexCount;
+		unsigned int FirstIndex;
+		int BaseVertex;
+	};
+
+	struct SortEntry
+	{
+		uint64_t Key;
+		uint32_t Index;
+	};
+
+	std::vector<Item> m_Items;
+	std::vector<SortEntry> m_Entries;
+	std::vector<SortEntry> m_Scratch;
+	std::vector<int> m_Counts;
+	std::vector<const void*> m_Offsets;
+	std::vector<int> m_BaseVertices;
+	UniformBuffer m_MaterialUniforms;
+
+	Stats m_Stats;
+
+	void RadixSort();
+public:
+	DrawQueue();
+
+	DrawQueue(const DrawQueue&) = delete;
+	DrawQueue& operator=(const DrawQueue&) = delete;
+
+	// depth is the distance from the camera mapped to [0, 1]
+	static uint64_t MakeKey(unsigned int pass, const Material& material, const VertexArray& vao, float depth);
+
+	// indexCount 0 draws from firstIndex to the end of ibo. material and the
+	// buffers have to stay alive until Flush().
+	void Submit(const VertexArray& vao, const IndexBuffer& ibo, const Material& material, float depth = 0.0f, unsigned int pass = 0,
+		unsigned int indexCount = 0, unsigned int firstIndex = 0, int baseVertex = 0);
+
+	// Draws everything submitted since the last Flush(), sorted unless sort
+	// is false, and empties the queue. Leaves blending off and depth writes on.
+	void Flush(const Renderer& renderer, bool sort = true);
+
+	inline unsigned int GetDrawCount() const { return (unsigned int)m_Items.size(); }
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+};
@@ -0,0 +1,25 @@
+#include <fstream>
+
+#include "FileUtils.h"
+
+namespace FileUtils {
+
+	bool ReadFile(const std::string& filepath, std::string& contents)
+	{
+		std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+		if (!stream)
+			return false;
+
+		stream.seekg(0, std::ios::end);
+		std::streamoff size = stream.tellg();
+		if (size < 0)
+			return false;
+		stream.seekg(0, std::ios::beg);
+
+		contents.resize((size_t)size);
+		if (size > 0)
+			stream.read(&contents[0], size);
+		return (bool)stream;
+	}
+
+}
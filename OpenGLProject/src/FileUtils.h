@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+namespace FileUtils {
+
+	// Reads a whole file with a single read call
+	bool ReadFile(const std::string& filepath, std::string& contents);
+
+}
@@ -0,0 +1,60 @@
+#include "Framebuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+Framebuffer::Framebuffer(unsigned int width, unsigned int height)
+	: m_Width(width), m_Height(height)
+{
+	GLCall(glGenTextures(1, &m_ColorTexture));
+	GLState::BindTexture(GL_TEXTURE_2D, m_ColorTexture);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+
+	GLCall(glGenRenderbuffers(1, &m_DepthStencilBuffer));
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthStencilBuffer));
+	GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height));
+
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+	GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorTexture, 0));
+	GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthStencilBuffer));
+}
+
+Framebuffer::~Framebuffer()
+{
+	GLCall(glDeleteFramebuffers(1, &m_RendererID));
+	GLState::OnFramebufferDeleted(m_RendererID);
+	GLCall(glDeleteRenderbuffers(1, &m_DepthStencilBuffer));
+	GLCall(glDeleteTextures(1, &m_ColorTexture));
+	GLState::OnTextureDeleted(m_ColorTexture);
+}
+
+bool Framebuffer::IsComplete() const
+{
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+	GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void Framebuffer::Bind() const
+{
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+	GLState::Viewport(0, 0, m_Width, m_Height);
+}
+
+void Framebuffer::Unbind() const
+{
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Framebuffer::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+	pixels.resize((size_t)m_Width * m_Height * 4);
+	GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID);
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+}
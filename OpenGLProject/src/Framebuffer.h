@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+// Offscreen render target: an RGBA8 color texture and a 24-bit depth,
+// 8-bit stencil renderbuffer of the same size.
+class Framebuffer {
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorTexture;
+	unsigned int m_DepthStencilBuffer;
+	unsigned int m_Width;
+	unsigned int m_Height;
+public:
+	Framebuffer(unsigned int width, unsigned int height);
+	~Framebuffer();
+
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	bool IsComplete() const;
+
+	// Binds for drawing and reading and sets the viewport to the whole target
+	void Bind() const;
+	// Back to the default framebuffer; the viewport is left as it is
+	void Unbind() const;
+
+	// Waits for rendering to finish. Rows are bottom to top, 4 bytes per pixel.
+	void ReadPixels(std::vector<unsigned char>& pixels) const;
+
+	inline unsigned int GetColorTexture() const { return m_ColorTexture; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+};
@@ -0,0 +1,358 @@
+#include "GLState.h"
+#include "Renderer.h"
+
+namespace GLState {
+
+	static const unsigned int Unknown = 0xFFFFFFFF;
+
+	static const unsigned int s_BufferTargets[] = {
+		GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_COPY_READ_BUFFER,
+		GL_COPY_WRITE_BUFFER, GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_TEXTURE_BUFFER
+	};
+	static const unsigned int BufferTargetCount = sizeof(s_BufferTargets) / sizeof(s_BufferTargets[0]);
+
+	static const unsigned int s_TextureTargets[] = {
+		GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP
+	};
+	static const unsigned int TextureTargetCount = sizeof(s_TextureTargets) / sizeof(s_TextureTargets[0]);
+	static const unsigned int MaxTextureUnits = 32;
+	static const unsigned int MaxUniformBufferBindings = 16;
+
+	struct State
+	{
+		unsigned int Program;
+		unsigned int VertexArray;
+		unsigned int Buffers[BufferTargetCount];
+		unsigned int UniformBuffers[MaxUniformBufferBindings];
+		unsigned int ActiveUnit;
+		unsigned int Textures[MaxTextureUnits][TextureTargetCount];
+		unsigned int DrawFramebuffer;
+		unsigned int ReadFramebuffer;
+		unsigned int Blend;
+		unsigned int BlendSource, BlendDestination;
+		unsigned int DepthTest;
+		unsigned int DepthFunc;
+		unsigned int DepthMask;
+		int Viewport[4];
+		bool ViewportKnown;
+	};
+
+	static void DefaultUseProgram(unsigned int program) { GLCall(glUseProgram(program)); }
+	static void DefaultBindVertexArray(unsigned int vertexArray) { GLCall(glBindVertexArray(vertexArray)); }
+	static void DefaultBindBuffer(unsigned int target, unsigned int buffer) { GLCall(glBindBuffer(target, buffer)); }
+	static void DefaultBindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) { GLCall(glBindBufferBase(target, index, buffer)); }
+	static void DefaultActiveTexture(unsigned int unit) { GLCall(glActiveTexture(unit)); }
+	static void DefaultBindTexture(unsigned int target, unsigned int texture) { GLCall(glBindTexture(target, texture)); }
+	static void DefaultBindFramebuffer(unsigned int target, unsigned int framebuffer) { GLCall(glBindFramebuffer(target, framebuffer)); }
+	static void DefaultEnable(unsigned int capability) { GLCall(glEnable(capability)); }
+	static void DefaultDisable(unsigned int capability) { GLCall(glDisable(capability)); }
+	static void DefaultBlendFunc(unsigned int source, unsigned int destination) { GLCall(glBlendFunc(source, destination)); }
+	static void DefaultDepthFunc(unsigned int func) { GLCall(glDepthFunc(func)); }
+	static void DefaultDepthMask(unsigned char flag) { GLCall(glDepthMask(flag)); }
+	static void DefaultViewport(int x, int y, int width, int height) { GLCall(glViewport(x, y, width, height)); }
+
+	static const GLBackend s_DefaultBackend = {
+		DefaultUseProgram,
+		DefaultBindVertexArray,
+		DefaultBindBuffer,
+		DefaultBindBufferBase,
+		DefaultActiveTexture,
+		DefaultBindTexture,
+		DefaultBindFramebuffer,
+		DefaultEnable,
+		DefaultDisable,
+		DefaultBlendFunc,
+		DefaultDepthFunc,
+		DefaultDepthMask,
+		DefaultViewport
+	};
+
+	static const GLBackend* s_Backend = &s_DefaultBackend;
+	static State s_State;
+	static Stats s_Stats;
+	static bool s_Initialized = (Invalidate(), true);
+
+	static int BufferTargetIndex(unsigned int target)
+	{
+		for (unsigned int i = 0; i < BufferTargetCount; i++) {
+			if (s_BufferTargets[i] == target)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	static int TextureTargetIndex(unsigned int target)
+	{
+		for (unsigned int i = 0; i < TextureTargetCount; i++) {
+			if (s_TextureTargets[i] == target)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	// Returns true and updates the shadow value when the call has to be issued
+	static inline bool Update(unsigned int& current, unsigned int value)
+	{
+		if (current == value) {
+			s_Stats.Skipped++;
+			return false;
+		}
+		current = value;
+		s_Stats.Issued++;
+		return true;
+	}
+
+	const GLBackend& GetDefaultBackend()
+	{
+		return s_DefaultBackend;
+	}
+
+	void SetBackend(const GLBackend* backend)
+	{
+		s_Backend = backend ? backend : &s_DefaultBackend;
+		Invalidate();
+	}
+
+	void Invalidate()
+	{
+		s_State.Program = Unknown;
+		s_State.VertexArray = Unknown;
+		for (unsigned int i = 0; i < BufferTargetCount; i++)
+			s_State.Buffers[i] = Unknown;
+		for (unsigned int i = 0; i < MaxUniformBufferBindings; i++)
+			s_State.UniformBuffers[i] = Unknown;
+		s_State.ActiveUnit = Unknown;
+		for (unsigned int unit = 0; unit < MaxTextureUnits; unit++) {
+			for (unsigned int i = 0; i < TextureTargetCount; i++)
+				s_State.Textures[unit][i] = Unknown;
+		}
+		s_State.DrawFramebuffer = Unknown;
+		s_State.ReadFramebuffer = Unknown;
+		s_State.Blend = Unknown;
+		s_State.BlendSource = Unknown;
+		s_State.BlendDestination = Unknown;
+		s_State.DepthTest = Unknown;
+		s_State.DepthFunc = Unknown;
+		s_State.DepthMask = Unknown;
+		s_State.ViewportKnown = false;
+	}
+
+	void UseProgram(unsigned int program)
+	{
+		if (Update(s_State.Program, program))
+			s_Backend->UseProgram(program);
+	}
+
+	void BindVertexArray(unsigned int vertexArray)
+	{
+		if (Update(s_State.VertexArray, vertexArray)) {
+			s_Backend->BindVertexArray(vertexArray);
+			// The element array binding is part of the vertex array object
+			s_State.Buffers[BufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+		}
+	}
+
+	void BindBuffer(unsigned int target, unsigned int buffer)
+	{
+		int index = BufferTargetIndex(target);
+		if (index < 0) {
+			s_Stats.Issued++;
+			s_Backend->BindBuffer(target, buffer);
+			return;
+		}
+
+		if (Update(s_State.Buffers[index], buffer))
+			s_Backend->BindBuffer(target, buffer);
+	}
+
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+	{
+		if (target != GL_UNIFORM_BUFFER || index >= MaxUniformBufferBindings) {
+			s_Stats.Issued++;
+			s_Backend->BindBufferBase(target, index, buffer);
+			int generic = BufferTargetIndex(target);
+			if (generic >= 0)
+				s_State.Buffers[generic] = buffer;
+			return;
+		}
+
+		if (Update(s_State.UniformBuffers[index], buffer)) {
+			s_Backend->BindBufferBase(target, index, buffer);
+			s_State.Buffers[BufferTargetIndex(GL_UNIFORM_BUFFER)] = buffer;
+		}
+	}
+
+	void ActiveTexture(unsigned int unit)
+	{
+		if (Update(s_State.ActiveUnit, unit))
+			s_Backend->ActiveTexture(unit);
+	}
+
+	void BindTexture(unsigned int target, unsigned int texture)
+	{
+		unsigned int unit = s_State.ActiveUnit - GL_TEXTURE0;
+		int index = TextureTargetIndex(target);
+		if (s_State.ActiveUnit == Unknown || unit >= MaxTextureUnits || index < 0) {
+			s_Stats.Issued++;
+			s_Backend->BindTexture(target, texture);
+			return;
+		}
+
+		if (Update(s_State.Textures[unit][index], texture))
+			s_Backend->BindTexture(target, texture);
+	}
+
+	void BindTextureUnit(unsigned int slot, unsigned int target, unsigned int texture)
+	{
+		int index = TextureTargetIndex(target);
+		if (slot < MaxTextureUnits && index >= 0 && s_State.Textures[slot][index] == texture) {
+			s_Stats.Skipped++;
+			return;
+		}
+
+		ActiveTexture(GL_TEXTURE0 + slot);
+		BindTexture(target, texture);
+	}
+
+	void BindFramebuffer(unsigned int target, unsigned int framebuffer)
+	{
+		if (target == GL_DRAW_FRAMEBUFFER) {
+			if (Update(s_State.DrawFramebuffer, framebuffer))
+				s_Backend->BindFramebuffer(target, framebuffer);
+		}
+		else if (target == GL_READ_FRAMEBUFFER) {
+			if (Update(s_State.ReadFramebuffer, framebuffer))
+				s_Backend->BindFramebuffer(target, framebuffer);
+		}
+		else if (s_State.DrawFramebuffer == framebuffer && s_State.ReadFramebuffer == framebuffer) {
+			s_Stats.Skipped++;
+		}
+		else {
+			s_State.DrawFramebuffer = framebuffer;
+			s_State.ReadFramebuffer = framebuffer;
+			s_Stats.Issued++;
+			s_Backend->BindFramebuffer(target, framebuffer);
+		}
+	}
+
+	static void SetCapability(unsigned int& current, unsigned int capability, bool enabled)
+	{
+		if (!Update(current, enabled ? 1 : 0))
+			return;
+
+		if (enabled)
+			s_Backend->Enable(capability);
+		else
+			s_Backend->Disable(capability);
+	}
+
+	void SetBlend(bool enabled)
+	{
+		SetCapability(s_State.Blend, GL_BLEND, enabled);
+	}
+
+	void BlendFunc(unsigned int source, unsigned int destination)
+	{
+		if (s_State.BlendSource == source && s_State.BlendDestination == destination) {
+			s_Stats.Skipped++;
+			return;
+		}
+
+		s_State.BlendSource = source;
+		s_State.BlendDestination = destination;
+		s_Stats.Issued++;
+		s_Backend->BlendFunc(source, destination);
+	}
+
+	void SetDepthTest(bool enabled)
+	{
+		SetCapability(s_State.DepthTest, GL_DEPTH_TEST, enabled);
+	}
+
+	void DepthFunc(unsigned int func)
+	{
+		if (Update(s_State.DepthFunc, func))
+			s_Backend->DepthFunc(func);
+	}
+
+	void DepthMask(bool enabled)
+	{
+		if (Update(s_State.DepthMask, enabled ? 1 : 0))
+			s_Backend->DepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+
+	void Viewport(int x, int y, int width, int height)
+	{
+		int* viewport = s_State.Viewport;
+		if (s_State.ViewportKnown && viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height) {
+			s_Stats.Skipped++;
+			return;
+		}
+
+		viewport[0] = x;
+		viewport[1] = y;
+		viewport[2] = width;
+		viewport[3] = height;
+		s_State.ViewportKnown = true;
+		s_Stats.Issued++;
+		s_Backend->Viewport(x, y, width, height);
+	}
+
+	void OnProgramDeleted(unsigned int program)
+	{
+		// A deleted program stays in use until another one is bound, so the
+		// binding only has to be forgotten, not reset to 0
+		if (s_State.Program == program)
+			s_State.Program = Unknown;
+	}
+
+	void OnVertexArrayDeleted(unsigned int vertexArray)
+	{
+		if (s_State.VertexArray == vertexArray) {
+			s_State.VertexArray = 0;
+			s_State.Buffers[BufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+		}
+	}
+
+	void OnBufferDeleted(unsigned int buffer)
+	{
+		for (unsigned int i = 0; i < BufferTargetCount; i++) {
+			if (s_State.Buffers[i] == buffer)
+				s_State.Buffers[i] = 0;
+		}
+		for (unsigned int i = 0; i < MaxUniformBufferBindings; i++) {
+			if (s_State.UniformBuffers[i] == buffer)
+				s_State.UniformBuffers[i] = 0;
+		}
+	}
+
+	void OnTextureDeleted(unsigned int texture)
+	{
+		for (unsigned int unit = 0; unit < MaxTextureUnits; unit++) {
+			for (unsigned int i = 0; i < TextureTargetCount; i++) {
+				if (s_State.Textures[unit][i] == texture)
+					s_State.Textures[unit][i] = 0;
+			}
+		}
+	}
+
+	void OnFramebufferDeleted(unsigned int framebuffer)
+	{
+		// Deleting a bound framebuffer reverts the binding to the default one
+		if (s_State.DrawFramebuffer == framebuffer)
+			s_State.DrawFramebuffer = 0;
+		if (s_State.ReadFramebuffer == framebuffer)
+			s_State.ReadFramebuffer = 0;
+	}
+
+	const Stats& GetStats()
+	{
+		return s_Stats;
+	}
+
+	void ResetStats()
+	{
+		s_Stats = Stats();
+	}
+
+}
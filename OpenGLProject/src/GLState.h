@@ -0,0 +1,70 @@
+#pragma once
+
+// Entry points the state cache forwards to. The default backend calls the
+// real GL functions; a mock backend can be installed with GLState::SetBackend
+// to exercise the cache without a GPU or context.
+struct GLBackend
+{
+	void (*UseProgram)(unsigned int program);
+	void (*BindVertexArray)(unsigned int vertexArray);
+	void (*BindBuffer)(unsigned int target, unsigned int buffer);
+	void (*BindBufferBase)(unsigned int target, unsigned int index, unsigned int buffer);
+	void (*ActiveTexture)(unsigned int unit);
+	void (*BindTexture)(unsigned int target, unsigned int texture);
+	void (*BindFramebuffer)(unsigned int target, unsigned int framebuffer);
+	void (*Enable)(unsigned int capability);
+	void (*Disable)(unsigned int capability);
+	void (*BlendFunc)(unsigned int source, unsigned int destination);
+	void (*DepthFunc)(unsigned int func);
+	void (*DepthMask)(unsigned char flag);
+	void (*Viewport)(int x, int y, int width, int height);
+};
+
+// Shadow copy of the GL binding and fixed-function state. Every bind in the
+// renderer goes through here so calls that would not change anything never
+// reach the driver. State starts out unknown, so the first call always goes
+// through; call Invalidate() after GL code that bypasses the cache.
+namespace GLState {
+
+	struct Stats
+	{
+		unsigned long long Issued = 0;
+		unsigned long long Skipped = 0;
+	};
+
+	const GLBackend& GetDefaultBackend();
+	// Pass nullptr to restore the default backend. Invalidates the cache.
+	void SetBackend(const GLBackend* backend);
+	void Invalidate();
+
+	void UseProgram(unsigned int program);
+	void BindVertexArray(unsigned int vertexArray);
+	void BindBuffer(unsigned int target, unsigned int buffer);
+	// Indexed binding; also changes the generic binding of target
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+	// unit is GL_TEXTURE0 + n
+	void ActiveTexture(unsigned int unit);
+	// Binds to the active texture unit
+	void BindTexture(unsigned int target, unsigned int texture);
+	void BindTextureUnit(unsigned int slot, unsigned int target, unsigned int texture);
+	// GL_FRAMEBUFFER sets both the draw and the read binding
+	void BindFramebuffer(unsigned int target, unsigned int framebuffer);
+
+	void SetBlend(bool enabled);
+	void BlendFunc(unsigned int source, unsigned int destination);
+	void SetDepthTest(bool enabled);
+	void DepthFunc(unsigned int func);
+	void DepthMask(bool enabled);
+	void Viewport(int x, int y, int width, int height);
+
+	// GL drops bindings of deleted objects; keep the cache in sync
+	void OnProgramDeleted(unsigned int program);
+	void OnVertexArrayDeleted(unsigned int vertexArray);
+	void OnBufferDeleted(unsigned int buffer);
+	void OnTextureDeleted(unsigned int texture);
+	void OnFramebufferDeleted(unsigned int framebuffer);
+
+	const Stats& GetStats();
+	void ResetStats();
+
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Image.h"
+#include "FileUtils.h"
+
+static const size_t s_TGAHeaderSize = 18;
+static const unsigned char s_TGATopToBottom = 0x20;
+
+bool LoadTGA(const std::string& filepath, Image& image)
+{
+	std::string file;
+	if (!FileUtils::ReadFile(filepath, file) || file.size() < s_TGAHeaderSize) {
+		std::cout << "Could not read " << filepath << std::endl;
+		return false;
+	}
+
+	const unsigned char* header = (const unsigned char*)file.data();
+	unsigned int idLength = header[0];
+	unsigned int colorMapType = header[1];
+	unsigned int imageType = header[2];
+	unsigned int width = header[12] | (header[13] << 8);
+	unsigned int height = header[14] | (header[15] << 8);
+	unsigned int bitsPerPixel = header[16];
+	unsigned char descriptor = header[17];
+
+	bool rle = imageType == 10;
+	if (colorMapType != 0 || (imageType != 2 && !rle) || (bitsPerPixel != 24 && bitsPerPixel != 32) || width == 0 || height == 0) {
+		std::cout << "Unsupported TGA " << filepath << ", only truecolor 24 and 32-bit images are read" << std::endl;
+		return false;
+	}
+
+	unsigned int bytesPerPixel = bitsPerPixel / 8;
+	size_t pixelCount = (size_t)width * height;
+	const unsigned char* data = header + s_TGAHeaderSize + idLength;
+	const unsigned char* end = (const unsigned char*)file.data() + file.size();
+
+	image.Width = width;
+	image.Height = height;
+	image.Pixels.resize(pixelCount * 4);
+
+	// TGA stores BGR(A)
+	unsigned char* out = image.Pixels.data();
+	auto writePixel = [&out, bytesPerPixel](const unsigned char* pixel) {
+		out[0] = pixel[2];
+		out[1] = pixel[1];
+		out[2] = pixel[0];
+		out[3] = bytesPerPixel == 4 ? pixel[3] : 255;
+		out += 4;
+	};
+
+	size_t written = 0;
+	while (written < pixelCount) {
+		unsigned int count = 1;
+		bool repeat = false;
+		if (rle) {
+			if (data >= end)
+				break;
+			count = (*data & 0x7F) + 1;
+			repeat = (*data & 0x80) != 0;
+			data++;
+		}
+		count = (unsigned int)std::min<size_t>(count, pixelCount - written);
+
+		size_t bytes = (size_t)(repeat ? 1 : count) * bytesPerPixel;
+		if ((size_t)(end - data) < bytes)
+			break;
+		for (unsigned int i = 0; i < count; i++)
+			writePixel(repeat ? data : data + (size_t)i * bytesPerPixel);
+		data += bytes;
+		written += count;
+	}
+
+	if (written < pixelCount) {
+		std::cout << "Truncated TGA " << filepath << std::endl;
+		return false;
+	}
+
+	if (descriptor & s_TGATopToBottom) {
+		size_t rowBytes = (size_t)width * 4;
+		std::vector<unsigned char> row(rowBytes);
+		for (unsigned int y = 0; y < height / 2; y++) {
+			unsigned char* top = &image.Pixels[y * rowBytes];
+			unsigned char* bottom = &image.Pixels[(height - 1 - y) * rowBytes];
+			memcpy(row.data(), top, rowBytes);
+			memcpy(top, bottom, rowBytes);
+			memcpy(bottom, row.data(), rowBytes);
+		}
+	}
+	return true;
+}
+
+bool WriteTGA(const std::string& filepath, const Image& image)
+{
+	std::ofstream stream(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!stream)
+		return false;
+
+	unsigned char header[s_TGAHeaderSize] = {};
+	header[2] = 2;
+	header[12] = image.Width & 0xFF;
+	header[13] = (image.Width >> 8) & 0xFF;
+	header[14] = image.Height & 0xFF;
+	header[15] = (image.Height >> 8) & 0xFF;
+	header[16] = 32;
+	header[17] = 8;
+	stream.write((const char*)header, sizeof(header));
+
+	std::vector<unsigned char> bgra(image.Pixels.size());
+	for (size_t i = 0; i < bgra.size(); i += 4) {
+		bgra[i + 0] = image.Pixels[i + 2];
+		bgra[i + 1] = image.Pixels[i + 1];
+		bgra[i + 2] = image.Pixels[i + 0];
+		bgra[i + 3] = image.Pixels[i + 3];
+	}
+	stream.write((const char*)bgra.data(), (std::streamsize)bgra.size());
+	return (bool)stream;
+}
+
+bool CompareImages(const Image& a, const Image& b, unsigned int tolerance, ImageDifference& difference)
+{
+	difference = ImageDifference();
+	if (a.Width != b.Width || a.Height != b.Height || a.Pixels.size() != b.Pixels.size())
+		return false;
+
+	size_t pixelCount = (size_t)a.Width * a.Height;
+	for (size_t i = 0; i < pixelCount; i++) {
+		unsigned int pixelDifference = 0;
+		for (int c = 0; c < 4; c++) {
+			unsigned int channel = (unsigned int)std::abs((int)a.Pixels[i * 4 + c] - (int)b.Pixels[i * 4 + c]);
+			pixelDifference = channel > pixelDifference ? channel : pixelDifference;
+		}
+		if (pixelDifference > difference.MaxChannelDifference)
+			difference.MaxChannelDifference = pixelDifference;
+		if (pixelDifference > tolerance)
+			difference.MismatchedPixels++;
+	}
+	difference.MismatchedFraction = pixelCount ? (double)difference.MismatchedPixels / pixelCount : 0.0;
+	return true;
+}
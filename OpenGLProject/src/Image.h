@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// 8-bit RGBA pixels with the bottom row first, the order glReadPixels
+// returns and glTexImage2D expects
+struct Image
+{
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	std::vector<unsigned char> Pixels;
+};
+
+struct ImageDifference
+{
+	// Largest difference of any channel, 0 - 255
+	unsigned int MaxChannelDifference = 0;
+	// Pixels with a channel more than the tolerance apart
+	unsigned long long MismatchedPixels = 0;
+	double MismatchedFraction = 0.0;
+};
+
+// Truecolor TGA, 24 or 32 bits, uncompressed or run-length encoded
+bool LoadTGA(const std::string& filepath, Image& image);
+// Writes an uncompressed 32-bit TGA
+bool WriteTGA(const std::string& filepath, const Image& image);
+
+// Returns false when the sizes differ
+bool CompareImages(const Image& a, const Image& b, unsigned int tolerance, ImageDifference& difference);
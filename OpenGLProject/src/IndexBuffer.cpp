@@ -1,28 +1,73 @@
+#include <vector>
+
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
 
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	: m_Count(count)
 {
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
+	unsigned int maxIndex = 0;
+	for (unsigned int i = 0; i < count; i++)
+		maxIndex = data[i] > maxIndex ? data[i] : maxIndex;
+
+	unsigned int type = SelectType(maxIndex);
+	if (type == GL_UNSIGNED_SHORT) {
+		std::vector<GLushort> narrowed(data, data + count);
+		Create(narrowed.data(), count, type);
+	}
+	else {
+		Create(data, count, type);
+	}
+}
+
+IndexBuffer::IndexBuffer(const void* data, unsigned int count, unsigned int type)
+{
+	ASSERT(GetSizeOfType(type) != 0);
+	Create(data, count, type);
+}
+
+void IndexBuffer::Create(const void* data, unsigned int count, unsigned int type)
+{
+	m_Count = count;
+	m_Type = type;
+
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * m_Count, data, GL_STATIC_DRAW));
+	Bind();
+	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)GetSizeOfType(type) * m_Count, data, GL_STATIC_DRAW));
 }
 
 IndexBuffer::~IndexBuffer()
 {
 	GLCall(glDeleteBuffers(1, &m_RendererID));
+	GLState::OnBufferDeleted(m_RendererID);
 }
 
 void IndexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+unsigned int IndexBuffer::SelectType(unsigned int maxIndex)
+{
+	// Primitive restart is never enabled, so 0xFFFF is an ordinary index
+	return maxIndex <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int type)
+{
+	switch (type)
+	{
+		case GL_UNSIGNED_BYTE:  return 1;
+		case GL_UNSIGNED_SHORT: return 2;
+		case GL_UNSIGNED_INT:   return 4;
+	}
+	return 0;
+}
@@ -1,15 +1,33 @@
 #pragma once
 
+// Triangle indices stored in the smallest type that can address every
+// vertex. Draw calls have to pass GetType() instead of GL_UNSIGNED_INT.
 class IndexBuffer {
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+	unsigned int m_Type;
+
+	void Create(const void* data, unsigned int count, unsigned int type);
 public:
+	// Narrows to GL_UNSIGNED_SHORT when every index fits in 16 bits
 	IndexBuffer(const unsigned int* data, unsigned int count);
+	// Uploads indices that are already GL_UNSIGNED_BYTE, _SHORT or _INT
+	IndexBuffer(const void* data, unsigned int count, unsigned int type);
 	~IndexBuffer();
 
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+
 	void Bind() const;
 	void Unbind() const;
 
 	inline unsigned int GetCount() const { return m_Count; }
-};
\ No newline at end of file
+	inline unsigned int GetType() const { return m_Type; }
+	inline unsigned int GetIndexSize() const { return GetSizeOfType(m_Type); }
+
+	// GL_UNSIGNED_BYTE is never picked: several drivers convert byte indices
+	// on the CPU at draw time, and the memory saved is at most 512 bytes
+	static unsigned int SelectType(unsigned int maxIndex);
+	static unsigned int GetSizeOfType(unsigned int type);
+};
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "LinearAllocator.h"
+
+LinearAllocator::LinearAllocator(size_t pageSize)
+	: m_PageSize(pageSize), m_Page(0), m_Offset(0), m_BytesUsed(0)
+{
+}
+
+void* LinearAllocator::Allocate(size_t size, size_t alignment)
+{
+	while (m_Page < m_Pages.size()) {
+		Page& page = m_Pages[m_Page];
+		uintptr_t base = (uintptr_t)page.Data.get();
+		size_t offset = ((base + m_Offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+		if (offset + size <= page.Size) {
+			m_Offset = offset + size;
+			m_BytesUsed += size;
+			return page.Data.get() + offset;
+		}
+		m_Page++;
+		m_Offset = 0;
+	}
+
+	// Out of pages; new[] is aligned for any fundamental type, larger
+	// alignments get the extra room to align within the page
+	size_t pageSize = std::max(m_PageSize, size + alignment);
+	m_Pages.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[pageSize]), pageSize });
+	m_Page = m_Pages.size() - 1;
+	m_Offset = 0;
+	return Allocate(size, alignment);
+}
+
+void LinearAllocator::Reset()
+{
+	m_Page = 0;
+	m_Offset = 0;
+	m_BytesUsed = 0;
+}
+
+size_t LinearAllocator::GetCapacity() const
+{
+	size_t capacity = 0;
+	for (const Page& page : m_Pages)
+		capacity += page.Size;
+	return capacity;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator over a list of pages. Allocations are never freed one by
+// one; Reset() rewinds to the first page and keeps every page, so once the
+// pages have grown to a frame's worth of data nothing is allocated anymore.
+// Not thread safe, give each recording thread its own allocator.
+class LinearAllocator {
+private:
+	struct Page
+	{
+		std::unique_ptr<unsigned char[]> Data;
+		size_t Size;
+	};
+
+	std::vector<Page> m_Pages;
+	size_t m_PageSize;
+	size_t m_Page;
+	size_t m_Offset;
+	size_t m_BytesUsed;
+public:
+	explicit LinearAllocator(size_t pageSize = 64 * 1024);
+
+	LinearAllocator(const LinearAllocator&) = delete;
+	LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+	// alignment must be a power of two. Requests larger than the page size
+	// get a page of their own.
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	void Reset();
+
+	inline size_t GetBytesUsed() const { return m_BytesUsed; }
+	size_t GetCapacity() const;
+};
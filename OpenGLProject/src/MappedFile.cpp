@@ -0,0 +1,118 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: m_Data(nullptr), m_Size(0), m_File(INVALID_HANDLE_VALUE), m_Mapping(nullptr)
+{
+}
+
+bool MappedFile::Open(const std::string& filepath)
+{
+	Close();
+
+	m_File = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_Mapping) {
+		Close();
+		return false;
+	}
+
+	m_Data = (const unsigned char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_Data) {
+		Close();
+		return false;
+	}
+
+	m_Size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_Mapping)
+		CloseHandle(m_Mapping);
+	if (m_File != INVALID_HANDLE_VALUE)
+		CloseHandle(m_File);
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Mapping = nullptr;
+	m_File = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: m_Data(nullptr), m_Size(0), m_Descriptor(-1)
+{
+}
+
+bool MappedFile::Open(const std::string& filepath)
+{
+	Close();
+
+	m_Descriptor = open(filepath.c_str(), O_RDONLY);
+	if (m_Descriptor < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(m_Descriptor, &info) != 0 || info.st_size == 0) {
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_Descriptor, 0);
+	if (data == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	// The whole file is about to be read front to back
+	madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+	m_Data = (const unsigned char*)data;
+	m_Size = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+		munmap((void*)m_Data, m_Size);
+	if (m_Descriptor >= 0)
+		close(m_Descriptor);
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Descriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+
+#include "Mesh.h"
+#include "Renderer.h"
+#include "MeshFile.h"
+#include "Profiler.h"
+
+Mesh::Mesh(const void* vertices, unsigned int size, const VertexBufferLayout& layout, const unsigned int* indices, unsigned int count)
+	: m_InstanceBufferGeneration(0)
+{
+	m_VertexBuffer = std::make_unique<VertexBuffer>(vertices, size);
+	m_VertexArray.AddBuffer(*m_VertexBuffer, layout);
+	CreateIndexBuffer(indices, count);
+}
+
+Mesh::Mesh(const void* vertices, unsigned int size, const VertexBufferLayout& layout, const void* indices, unsigned int count, unsigned int indexType)
+	: m_InstanceBufferGeneration(0)
+{
+	m_VertexBuffer = std::make_unique<VertexBuffer>(vertices, size);
+	m_VertexArray.AddBuffer(*m_VertexBuffer, layout);
+	CreateIndexBuffer(indices, count, indexType);
+}
+
+void Mesh::CreateIndexBuffer(const unsigned int* indices, unsigned int count)
+{
+	m_InstanceAttributeBase = m_VertexArray.GetAttributeCount();
+
+	// The element array binding is stored in the vertex array
+	m_VertexArray.Bind();
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices, count);
+}
+
+void Mesh::CreateIndexBuffer(const void* indices, unsigned int count, unsigned int indexType)
+{
+	m_InstanceAttributeBase = m_VertexArray.GetAttributeCount();
+
+	m_VertexArray.Bind();
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices, count, indexType);
+}
+
+void Mesh::AttachInstanceBuffer(const VertexBuffer& instances, const VertexBufferLayout& layout)
+{
+	if (m_InstanceBufferGeneration == instances.GetGeneration() && m_InstanceLayout == layout)
+		return;
+
+	m_VertexArray.AddBuffer(instances, layout, 1, m_InstanceAttributeBase);
+	m_InstanceBufferGeneration = instances.GetGeneration();
+	m_InstanceLayout = layout;
+}
+
+std::unique_ptr<Mesh> Mesh::LoadFromFile(const std::string& filepath)
+{
+	PROFILE_FUNCTION();
+	MeshFile file;
+	if (!file.Open(filepath))
+		return nullptr;
+
+	const MeshFileHeader& header = file.GetHeader();
+	unsigned int indexType = header.IndexSize == 1 ? GL_UNSIGNED_BYTE : header.IndexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	VertexBufferLayout layout;
+	for (uint32_t i = 0; i < header.AttributeCount; i++) {
+		const MeshFileAttribute& attribute = header.Attributes[i];
+		if (attribute.Offset != layout.GetStride()) {
+			std::cout << "Unsupported vertex layout in " << filepath << std::endl;
+			return nullptr;
+		}
+		layout.Push(attribute.Type, attribute.Count, attribute.Normalized != 0, attribute.Integer != 0);
+	}
+	if (layout.GetStride() != header.VertexStride) {
+		std::cout << "Unsupported vertex layout in " << filepath << std::endl;
+		return nullptr;
+	}
+
+	return std::make_unique<Mesh>(file.GetVertices(), (unsigned int)header.VertexBytes, layout,
+		file.GetIndices(), header.IndexCount, indexType);
+}
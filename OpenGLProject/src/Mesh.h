@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+// Indexed geometry with its own vertex array. Per-instance buffers are
+// attached after the mesh attributes, so instanced shaders read the
+// instance data starting at location GetInstanceAttributeBase().
+class Mesh {
+private:
+	VertexArray m_VertexArray;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	unsigned int m_InstanceAttributeBase;
+	// What the instance attributes point at. Neither the buffer's address
+	// nor its GL name identify it, a new buffer can get either again.
+	uint64_t m_InstanceBufferGeneration;
+	VertexBufferLayout m_InstanceLayout;
+
+	void CreateIndexBuffer(const unsigned int* indices, unsigned int count);
+	void CreateIndexBuffer(const void* indices, unsigned int count, unsigned int indexType);
+public:
+	Mesh(const void* vertices, unsigned int size, const VertexBufferLayout& layout, const unsigned int* indices, unsigned int count);
+	// indices are already in indexType (see IndexBuffer)
+	Mesh(const void* vertices, unsigned int size, const VertexBufferLayout& layout, const void* indices, unsigned int count, unsigned int indexType);
+
+	template<typename... Attributes>
+	Mesh(const void* vertices, unsigned int size, const StaticVertexLayout<Attributes...>& layout, const unsigned int* indices, unsigned int count)
+		: m_InstanceBufferGeneration(0)
+	{
+		m_VertexBuffer = std::make_unique<VertexBuffer>(vertices, size);
+		m_VertexArray.AddBuffer(*m_VertexBuffer, layout);
+		CreateIndexBuffer(indices, count);
+	}
+
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+
+	// Points the instance attributes at instances. Only touches the vertex
+	// array when the buffer or the layout differ from last time.
+	void AttachInstanceBuffer(const VertexBuffer& instances, const VertexBufferLayout& layout);
+
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
+	inline unsigned int GetInstanceAttributeBase() const { return m_InstanceAttributeBase; }
+
+	// Loads a .mesh file (see MeshFile.h). The vertex and index sections are
+	// uploaded straight from the memory mapping without being parsed or copied.
+	static std::unique_ptr<Mesh> LoadFromFile(const std::string& filepath);
+};
@@ -0,0 +1,151 @@
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+#include "MeshFile.h"
+#include "VertexBufferLayout.h"
+
+static_assert(std::is_trivially_copyable<MeshFileHeader>::value, "MeshFileHeader is read straight from the mapping");
+static_assert(sizeof(MeshFileHeader) % 8 == 0, "MeshFileHeader must not need tail padding");
+
+static const char s_MeshMagic[4] = { 'M', 'E', 'S', 'H' };
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Aligned, after the header and inside the file, without overflowing
+static bool IsValidSection(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+	return offset >= sizeof(MeshFileHeader) && offset % MeshFileAlignment == 0 &&
+		bytes <= fileSize && offset <= fileSize - bytes;
+}
+
+MeshFile::MeshFile()
+	: m_Header(nullptr)
+{
+}
+
+// Attributes become glVertexAttrib(I)Pointer calls as they are
+static bool IsValidAttribute(const MeshFileAttribute& attribute) {
+	if (!VertexBufferElement::IsSupportedType(attribute.Type) || attribute.Count < 1 || attribute.Count > 4)
+		return false;
+	if (VertexBufferElement::IsPackedType(attribute.Type) && attribute.Count != 4)
+		return false;
+	return !attribute.Integer || VertexBufferElement::IsIntegerType(attribute.Type);
+}
+
+template<typename T>
+static bool IndicesInRange(const unsigned char* data, uint32_t count, uint32_t vertexCount) {
+	for (uint32_t i = 0; i < count; i++) {
+		T index;
+		memcpy(&index, data + (size_t)i * sizeof(T), sizeof(T));
+		if (index >= vertexCount)
+			return false;
+	}
+	return true;
+}
+
+bool MeshFile::Open(const std::string& filepath)
+{
+	Close();
+
+	if (!m_File.Open(filepath)) {
+		std::cout << "Could not map mesh " << filepath << std::endl;
+		return false;
+	}
+
+	const MeshFileHeader* header = (const MeshFileHeader*)m_File.GetData();
+	uint64_t size = m_File.GetSize();
+	bool valid = size >= sizeof(MeshFileHeader) &&
+		memcmp(header->Magic, s_MeshMagic, sizeof(s_MeshMagic)) == 0 &&
+		header->Version == MeshFileVersion &&
+		header->AttributeCount > 0 && header->AttributeCount <= MeshFileMaxAttributes &&
+		(header->IndexSize == 1 || header->IndexSize == 2 || header->IndexSize == 4) &&
+		header->VertexBytes == (uint64_t)header->VertexCount * header->VertexStride &&
+		header->IndexBytes == (uint64_t)header->IndexCount * header->IndexSize &&
+		IsValidSection(header->VertexOffset, header->VertexBytes, size) &&
+		IsValidSection(header->IndexOffset, header->IndexBytes, size) &&
+		// Indices follow the vertices, the way Write() lays them out
+		header->IndexOffset >= header->VertexOffset + header->VertexBytes &&
+		// Vertex data is uploaded with a 32-bit size
+		header->VertexBytes <= UINT_MAX;
+
+	for (uint32_t i = 0; valid && i < header->AttributeCount; i++)
+		valid = IsValidAttribute(header->Attributes[i]);
+
+	if (valid) {
+		const unsigned char* indices = m_File.GetData() + header->IndexOffset;
+		switch (header->IndexSize) {
+		case 1: valid = IndicesInRange<uint8_t>(indices, header->IndexCount, header->VertexCount); break;
+		case 2: valid = IndicesInRange<uint16_t>(indices, header->IndexCount, header->VertexCount); break;
+		case 4: valid = IndicesInRange<uint32_t>(indices, header->IndexCount, header->VertexCount); break;
+		}
+	}
+
+	if (!valid) {
+		std::cout << "Invalid or incompatible mesh file " << filepath << std::endl;
+		m_File.Close();
+		return false;
+	}
+
+	m_Header = header;
+	return true;
+}
+
+void MeshFile::Close()
+{
+	m_File.Close();
+	m_Header = nullptr;
+}
+
+bool MeshFile::Write(const std::string& filepath, const MeshData& mesh)
+{
+	if (mesh.Attributes.empty() || mesh.Attributes.size() > MeshFileMaxAttributes || mesh.VertexStride == 0)
+		return false;
+
+	MeshFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.Magic, s_MeshMagic, sizeof(s_MeshMagic));
+	header.Version = MeshFileVersion;
+	header.VertexCount = mesh.GetVertexCount();
+	header.VertexStride = mesh.VertexStride;
+	header.IndexCount = (uint32_t)mesh.Indices.size();
+	header.AttributeCount = (uint32_t)mesh.Attributes.size();
+	for (size_t i = 0; i < mesh.Attributes.size(); i++)
+		header.Attributes[i] = mesh.Attributes[i];
+	memcpy(header.BoundsMin, mesh.BoundsMin, sizeof(header.BoundsMin));
+	memcpy(header.BoundsMax, mesh.BoundsMax, sizeof(header.BoundsMax));
+
+	// Same choice IndexBuffer makes at load time, so the mapped section can be uploaded as is
+	uint32_t maxIndex = 0;
+	for (uint32_t index : mesh.Indices)
+		maxIndex = index > maxIndex ? index : maxIndex;
+	std::vector<uint16_t> narrowed;
+	if (maxIndex <= 0xFFFF) {
+		narrowed.assign(mesh.Indices.begin(), mesh.Indices.end());
+		header.IndexSize = sizeof(uint16_t);
+	}
+	else {
+		header.IndexSize = sizeof(uint32_t);
+	}
+	const void* indices = narrowed.empty() ? (const void*)mesh.Indices.data() : (const void*)narrowed.data();
+
+	header.VertexOffset = AlignUp(sizeof(MeshFileHeader), MeshFileAlignment);
+	header.VertexBytes = (uint64_t)header.VertexCount * header.VertexStride;
+	header.IndexOffset = AlignUp(header.VertexOffset + header.VertexBytes, MeshFileAlignment);
+	header.IndexBytes = (uint64_t)header.IndexCount * header.IndexSize;
+
+	std::ofstream stream(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!stream)
+		return false;
+
+	static const char padding[MeshFileAlignment] = {};
+	stream.write((const char*)&header, sizeof(header));
+	stream.write(padding, (std::streamsize)(header.VertexOffset - sizeof(header)));
+	stream.write((const char*)mesh.Vertices.data(), (std::streamsize)header.VertexBytes);
+	stream.write(padding, (std::streamsize)(header.IndexOffset - header.VertexOffset - header.VertexBytes));
+	stream.write((const char*)indices, (std::streamsize)header.IndexBytes);
+	return (bool)stream;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Binary mesh asset (.mesh), little-endian:
+//
+//   MeshFileHeader
+//   vertex section   interleaved vertices, starts at VertexOffset
+//   index section    IndexSize bytes per index, starts at IndexOffset
+//
+// Both sections start on a MeshFileAlignment boundary so they can be handed
+// to the GL straight out of a memory mapping. Attribute types are GL enums.
+
+const uint32_t MeshFileVersion = 1;
+const uint32_t MeshFileAlignment = 64;
+const uint32_t MeshFileMaxAttributes = 8;
+
+struct MeshFileAttribute
+{
+	uint32_t Type;
+	uint32_t Count;
+	uint8_t Normalized;
+	uint8_t Integer;
+	uint16_t Reserved;
+	uint32_t Offset;
+};
+
+struct MeshFileHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t VertexCount;
+	uint32_t VertexStride;
+	uint32_t IndexCount;
+	uint32_t IndexSize;
+	uint32_t AttributeCount;
+	uint32_t Reserved;
+	uint64_t VertexOffset;
+	uint64_t VertexBytes;
+	uint64_t IndexOffset;
+	uint64_t IndexBytes;
+	float BoundsMin[3];
+	float BoundsMax[3];
+	MeshFileAttribute Attributes[MeshFileMaxAttributes];
+};
+
+// Mesh in CPU memory, as produced by importers and written by MeshFile::Write
+struct MeshData
+{
+	std::vector<unsigned char> Vertices;
+	uint32_t VertexStride = 0;
+	std::vector<MeshFileAttribute> Attributes;
+	std::vector<uint32_t> Indices;
+	float BoundsMin[3] = { 0.0f, 0.0f, 0.0f };
+	float BoundsMax[3] = { 0.0f, 0.0f, 0.0f };
+
+	inline uint32_t GetVertexCount() const { return VertexStride ? (uint32_t)(Vertices.size() / VertexStride) : 0; }
+};
+
+// A validated, memory mapped .mesh file: attributes are ones the GL accepts
+// and every index is below VertexCount. The section pointers stay valid
+// until the MeshFile is closed or destroyed.
+class MeshFile {
+private:
+	MappedFile m_File;
+	const MeshFileHeader* m_Header;
+public:
+	MeshFile();
+
+	bool Open(const std::string& filepath);
+	void Close();
+
+	inline const MeshFileHeader& GetHeader() const { return *m_Header; }
+	inline const void* GetVertices() const { return m_File.GetData() + m_Header->VertexOffset; }
+	inline const void* GetIndices() const { return m_File.GetData() + m_Header->IndexOffset; }
+
+	static bool Write(const std::string& filepath, const MeshData& mesh);
+};
@@ -0,0 +1,430 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+// GL enum value; the optimizer itself has no GL dependency
+static const uint32_t s_Float = 0x1406;
+
+static const uint32_t s_InvalidIndex = 0xFFFFFFFF;
+
+// Forsyth's constants, tuned for an LRU cache of 32 entries
+static const unsigned int s_ForsythCacheSize = 32;
+static const unsigned int s_ForsythMaxValence = 64;
+
+// Triangles optimized independently of each other. Seams between chunks
+// cost one cache restart each, which is noise at this size.
+static const size_t s_TrianglesPerChunk = 65536;
+
+struct ForsythScoreTable
+{
+	float Cache[s_ForsythCacheSize];
+	float Valence[s_ForsythMaxValence];
+
+	ForsythScoreTable()
+	{
+		for (unsigned int i = 0; i < s_ForsythCacheSize; i++) {
+			// The last triangle's vertices score the same whatever order they were added in
+			Cache[i] = i < 3 ? 0.75f : std::pow(1.0f - (float)(i - 3) / (s_ForsythCacheSize - 3), 1.5f);
+		}
+		Valence[0] = 0.0f;
+		for (unsigned int i = 1; i < s_ForsythMaxValence; i++)
+			Valence[i] = 2.0f * std::pow((float)i, -0.5f);
+	}
+
+	inline float Score(int cachePosition, uint32_t remaining) const
+	{
+		if (remaining == 0)
+			return -1.0f;
+		float score = cachePosition >= 0 ? Cache[cachePosition] : 0.0f;
+		score += remaining < s_ForsythMaxValence ? Valence[remaining] : 2.0f * std::pow((float)remaining, -0.5f);
+		return score;
+	}
+};
+
+static const ForsythScoreTable s_ForsythScores;
+
+static void OptimizeVertexCacheChunk(uint32_t* indices, size_t triangleCount)
+{
+	size_t indexCount = triangleCount * 3;
+
+	// Number the chunk's vertices densely so the working set stays small
+	std::vector<uint32_t> vertices(indices, indices + indexCount);
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	uint32_t vertexCount = (uint32_t)vertices.size();
+
+	std::vector<uint32_t> local(indexCount);
+	for (size_t i = 0; i < indexCount; i++)
+		local[i] = (uint32_t)(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+
+	// Triangles using each vertex; the first remaining[v] entries are the ones not yet emitted
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t vertex : local)
+		remaining[vertex]++;
+	std::vector<uint32_t> offsets(vertexCount);
+	uint32_t offset = 0;
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		offsets[v] = offset;
+		offset += remaining[v];
+	}
+	std::vector<uint32_t> adjacency(indexCount);
+	std::vector<uint32_t> fill(offsets);
+	for (size_t i = 0; i < indexCount; i++)
+		adjacency[fill[local[i]]++] = (uint32_t)(i / 3);
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; v++)
+		vertexScore[v] = s_ForsythScores.Score(-1, remaining[v]);
+
+	std::vector<unsigned char> emitted(triangleCount, 0);
+	std::vector<uint32_t> output;
+	output.reserve(indexCount);
+
+	uint32_t cache[s_ForsythCacheSize + 3];
+	unsigned int cacheCount = 0;
+	size_t nextUnemitted = 0;
+	int64_t best = -1;
+
+	while (output.size() < indexCount) {
+		// Nothing in the cache has triangles left: continue in input order
+		if (best < 0) {
+			while (emitted[nextUnemitted])
+				nextUnemitted++;
+			best = (int64_t)nextUnemitted;
+		}
+
+		const uint32_t* triangle = &local[(size_t)best * 3];
+		emitted[(size_t)best] = 1;
+
+		uint32_t newCache[s_ForsythCacheSize + 3];
+		unsigned int newCount = 0;
+		for (int k = 0; k < 3; k++) {
+			uint32_t v = triangle[k];
+			output.push_back(vertices[v]);
+
+			uint32_t* list = &adjacency[offsets[v]];
+			for (uint32_t i = 0; i < remaining[v]; i++) {
+				if (list[i] == (uint32_t)best) {
+					std::swap(list[i], list[remaining[v] - 1]);
+					break;
+				}
+			}
+			remaining[v]--;
+
+			if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+				newCache[newCount++] = v;
+		}
+		for (unsigned int i = 0; i < cacheCount; i++) {
+			if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+				newCache[newCount++] = cache[i];
+		}
+
+		// Rescore everything that moved in or fell out of the cache, then pick
+		// the best triangle among the ones those vertices still have
+		for (unsigned int i = 0; i < newCount; i++) {
+			uint32_t v = newCache[i];
+			cachePosition[v] = i < s_ForsythCacheSize ? (int)i : -1;
+			vertexScore[v] = s_ForsythScores.Score(cachePosition[v], remaining[v]);
+		}
+
+		best = -1;
+		float bestScore = -1.0f;
+		for (unsigned int i = 0; i < newCount; i++) {
+			uint32_t v = newCache[i];
+			const uint32_t* list = &adjacency[offsets[v]];
+			for (uint32_t j = 0; j < remaining[v]; j++) {
+				uint32_t t = list[j];
+				float score = vertexScore[local[t * 3 + 0]] + vertexScore[local[t * 3 + 1]] + vertexScore[local[t * 3 + 2]];
+				if (score > bestScore) {
+					bestScore = score;
+					best = t;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, s_ForsythCacheSize);
+		memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+	}
+
+	memcpy(indices, output.data(), indexCount * sizeof(uint32_t));
+}
+
+namespace MeshOptimizer {
+
+	VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, unsigned int cacheSize)
+	{
+		VertexCacheStats stats;
+		if (indexCount == 0)
+			return stats;
+
+		// A vertex is cached while fewer than cacheSize misses happened since it was loaded
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t time = cacheSize + 1;
+		uint32_t referenced = 0;
+		for (size_t i = 0; i < indexCount; i++) {
+			uint32_t v = indices[i];
+			if (timestamps[v] == 0)
+				referenced++;
+			if (time - timestamps[v] > cacheSize) {
+				timestamps[v] = time++;
+				stats.Transforms++;
+			}
+		}
+
+		stats.ACMR = (float)stats.Transforms / (float)(indexCount / 3);
+		stats.ATVR = (float)stats.Transforms / (float)referenced;
+		return stats;
+	}
+
+	uint32_t WeldVertices(MeshData& mesh)
+	{
+		uint32_t vertexCount = mesh.GetVertexCount();
+		uint32_t stride = mesh.VertexStride;
+		if (vertexCount == 0)
+			return 0;
+
+		// Open addressing over the welded vertices, keyed by their bytes
+		size_t tableSize = 1;
+		while (tableSize < (size_t)vertexCount * 2)
+			tableSize *= 2;
+		std::vector<uint32_t> table(tableSize, s_InvalidIndex);
+
+		std::vector<unsigned char> welded;
+		welded.reserve(mesh.Vertices.size());
+		std::vector<uint32_t> remap(vertexCount);
+		uint32_t weldedCount = 0;
+
+		for (uint32_t v = 0; v < vertexCount; v++) {
+			const unsigned char* vertex = &mesh.Vertices[(size_t)v * stride];
+
+			uint64_t hash = 14695981039346656037ull;
+			for (uint32_t i = 0; i < stride; i++) {
+				hash ^= vertex[i];
+				hash *= 1099511628211ull;
+			}
+
+			size_t slot = (size_t)hash & (tableSize - 1);
+			while (table[slot] != s_InvalidIndex && memcmp(&welded[(size_t)table[slot] * stride], vertex, stride) != 0)
+				slot = (slot + 1) & (tableSize - 1);
+
+			if (table[slot] == s_InvalidIndex) {
+				table[slot] = weldedCount++;
+				welded.insert(welded.end(), vertex, vertex + stride);
+			}
+			remap[v] = table[slot];
+		}
+
+		for (uint32_t& index : mesh.Indices)
+			index = remap[index];
+		mesh.Vertices.swap(welded);
+		return vertexCount - weldedCount;
+	}
+
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount, ThreadPool* pool)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+			return;
+
+		// Chunks have to be connected patches for the per-chunk optimization to
+		// find anything, so first order the triangles breadth first over shared
+		// vertices. Input order alone falls apart on meshes stored unsorted.
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+			offsets[indices[i] + 1]++;
+		for (uint32_t v = 0; v < vertexCount; v++)
+			offsets[v + 1] += offsets[v];
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+			adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+
+		std::vector<uint32_t> order;
+		order.reserve(triangleCount);
+		std::vector<unsigned char> visited(triangleCount, 0);
+		std::vector<unsigned char> vertexVisited(vertexCount, 0);
+		for (size_t seed = 0; seed < triangleCount; seed++) {
+			if (visited[seed])
+				continue;
+			visited[seed] = 1;
+			order.push_back((uint32_t)seed);
+			for (size_t head = order.size() - 1; head < order.size(); head++) {
+				for (int k = 0; k < 3; k++) {
+					uint32_t v = indices[(size_t)order[head] * 3 + k];
+					if (vertexVisited[v])
+						continue;
+					vertexVisited[v] = 1;
+					for (uint32_t i = offsets[v]; i < offsets[v + 1]; i++) {
+						uint32_t t = adjacency[i];
+						if (!visited[t]) {
+							visited[t] = 1;
+							order.push_back(t);
+						}
+					}
+				}
+			}
+		}
+
+		std::vector<uint32_t> ordered(triangleCount * 3);
+		for (size_t i = 0; i < triangleCount; i++)
+			memcpy(&ordered[i * 3], &indices[(size_t)order[i] * 3], sizeof(uint32_t) * 3);
+
+		size_t chunkCount = (triangleCount + s_TrianglesPerChunk - 1) / s_TrianglesPerChunk;
+		auto optimizeChunks = [&ordered, triangleCount](size_t begin, size_t end) {
+			for (size_t chunk = begin; chunk < end; chunk++) {
+				size_t first = chunk * s_TrianglesPerChunk;
+				size_t count = std::min(s_TrianglesPerChunk, triangleCount - first);
+				OptimizeVertexCacheChunk(&ordered[first * 3], count);
+			}
+		};
+
+		if (pool)
+			pool->ParallelFor(chunkCount, 1, optimizeChunks);
+		else
+			optimizeChunks(0, chunkCount);
+
+		memcpy(indices, ordered.data(), ordered.size() * sizeof(uint32_t));
+	}
+
+	void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const unsigned char* positions, size_t positionStride, uint32_t vertexCount)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+			return;
+
+		auto position = [positions, positionStride](uint32_t v, float* out) {
+			memcpy(out, positions + (size_t)v * positionStride, sizeof(float) * 3);
+		};
+
+		// A triangle that misses on all three vertices starts a cluster, so
+		// clusters can be reordered without costing extra cache misses
+		const unsigned int cacheSize = 16;
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t time = cacheSize + 1;
+		std::vector<size_t> clusterStarts;
+		for (size_t t = 0; t < triangleCount; t++) {
+			unsigned int misses = 0;
+			for (int k = 0; k < 3; k++) {
+				uint32_t v = indices[t * 3 + k];
+				if (time - timestamps[v] > cacheSize) {
+					timestamps[v] = time++;
+					misses++;
+				}
+			}
+			if (misses == 3 || t == 0)
+				clusterStarts.push_back(t);
+		}
+		clusterStarts.push_back(triangleCount);
+		size_t clusterCount = clusterStarts.size() - 1;
+
+		// Area weighted centroid and normal per cluster
+		std::vector<float> clusterData(clusterCount * 6, 0.0f);
+		float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		float meshArea = 0.0f;
+		for (size_t c = 0; c < clusterCount; c++) {
+			float* centroid = &clusterData[c * 6];
+			float* normal = centroid + 3;
+			float area = 0.0f;
+			for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+				float a[3], b[3], d[3];
+				position(indices[t * 3 + 0], a);
+				position(indices[t * 3 + 1], b);
+				position(indices[t * 3 + 2], d);
+
+				float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+				float e1[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+				float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+				float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+				for (int axis = 0; axis < 3; axis++) {
+					centroid[axis] += (a[axis] + b[axis] + d[axis]) / 3.0f * triangleArea;
+					normal[axis] += n[axis];
+				}
+				area += triangleArea;
+			}
+
+			for (int axis = 0; axis < 3; axis++)
+				meshCentroid[axis] += centroid[axis];
+			meshArea += area;
+			if (area > 0.0f) {
+				for (int axis = 0; axis < 3; axis++)
+					centroid[axis] /= area;
+			}
+		}
+		if (meshArea > 0.0f) {
+			for (int axis = 0; axis < 3; axis++)
+				meshCentroid[axis] /= meshArea;
+		}
+
+		// Clusters facing away from the centre occlude the ones facing inward
+		std::vector<float> keys(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++) {
+			const float* centroid = &clusterData[c * 6];
+			const float* normal = centroid + 3;
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			float dot = 0.0f;
+			for (int axis = 0; axis < 3; axis++)
+				dot += (centroid[axis] - meshCentroid[axis]) * normal[axis];
+			keys[c] = length > 0.0f ? dot / length : 0.0f;
+		}
+
+		std::vector<uint32_t> order(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++)
+			order[c] = (uint32_t)c;
+		std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+		std::vector<uint32_t> sorted;
+		sorted.reserve(triangleCount * 3);
+		for (uint32_t c : order)
+			sorted.insert(sorted.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+		memcpy(indices, sorted.data(), sorted.size() * sizeof(uint32_t));
+	}
+
+	void OptimizeVertexFetch(MeshData& mesh)
+	{
+		uint32_t stride = mesh.VertexStride;
+		std::vector<uint32_t> remap(mesh.GetVertexCount(), s_InvalidIndex);
+		std::vector<unsigned char> vertices;
+		vertices.reserve(mesh.Vertices.size());
+
+		uint32_t next = 0;
+		for (uint32_t& index : mesh.Indices) {
+			if (remap[index] == s_InvalidIndex) {
+				remap[index] = next++;
+				const unsigned char* vertex = &mesh.Vertices[(size_t)index * stride];
+				vertices.insert(vertices.end(), vertex, vertex + stride);
+			}
+			index = remap[index];
+		}
+		mesh.Vertices.swap(vertices);
+	}
+
+	Report Optimize(MeshData& mesh, ThreadPool* pool)
+	{
+		Timer timer;
+		Report report;
+		report.VerticesBefore = mesh.GetVertexCount();
+		report.Before = AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.GetVertexCount());
+
+		WeldVertices(mesh);
+		OptimizeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.GetVertexCount(), pool);
+
+		bool hasPositions = !mesh.Attributes.empty() && mesh.Attributes[0].Type == s_Float &&
+			mesh.Attributes[0].Count >= 3 && mesh.Attributes[0].Offset == 0;
+		if (hasPositions)
+			OptimizeOverdraw(mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.data(), mesh.VertexStride, mesh.GetVertexCount());
+
+		OptimizeVertexFetch(mesh);
+
+		report.VerticesAfter = mesh.GetVertexCount();
+		report.After = AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.GetVertexCount());
+		report.Milliseconds = timer.ElapsedMilliseconds();
+		return report;
+	}
+
+}
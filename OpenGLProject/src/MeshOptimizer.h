@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MeshFile.h"
+
+class ThreadPool;
+
+// Offline reordering of MeshData for the GPU, run by MeshConverter before a
+// .mesh file is written. Optimize() applies, in order:
+//
+//   WeldVertices         merges vertices whose bytes are identical
+//   OptimizeVertexCache  Forsyth's linear-speed triangle order for a
+//                        post-transform cache, on independent chunks of
+//                        triangles so large meshes use every thread
+//   OptimizeOverdraw     splits the result where the cache restarts and
+//                        draws outward facing clusters first
+//   OptimizeVertexFetch  renumbers vertices in first-use order
+namespace MeshOptimizer {
+
+	// ACMR: vertex shader invocations per triangle, ideally 0.5 - 0.7
+	// ATVR: invocations per vertex, 1.0 is the minimum
+	struct VertexCacheStats
+	{
+		uint32_t Transforms = 0;
+		float ACMR = 0.0f;
+		float ATVR = 0.0f;
+	};
+
+	struct Report
+	{
+		VertexCacheStats Before;
+		VertexCacheStats After;
+		uint32_t VerticesBefore = 0;
+		uint32_t VerticesAfter = 0;
+		double Milliseconds = 0.0;
+	};
+
+	// Simulates a FIFO post-transform cache of cacheSize entries
+	VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, unsigned int cacheSize = 16);
+
+	// Returns the number of vertices removed
+	uint32_t WeldVertices(MeshData& mesh);
+	// pool nullptr runs the chunks on the calling thread with the same result
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount, ThreadPool* pool = nullptr);
+	// positions points at the first float3 position, positionStride bytes apart
+	void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const unsigned char* positions, size_t positionStride, uint32_t vertexCount);
+	// Also drops vertices no index refers to
+	void OptimizeVertexFetch(MeshData& mesh);
+
+	// Overdraw ordering is skipped unless attribute 0 is a float3 position
+	Report Optimize(MeshData& mesh, ThreadPool* pool = nullptr);
+
+}
@@ -0,0 +1,196 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#include "ObjLoader.h"
+#include "FileUtils.h"
+
+// GL enum values; the importer itself has no GL dependency
+static const uint32_t s_Float = 0x1406;
+
+struct ObjVertex
+{
+	float Position[3];
+	float Normal[3];
+	float TexCoord[2];
+};
+
+struct ObjIndexKey
+{
+	int Position;
+	int TexCoord;
+	int Normal;
+
+	bool operator==(const ObjIndexKey& other) const
+	{
+		return Position == other.Position && TexCoord == other.TexCoord && Normal == other.Normal;
+	}
+};
+
+struct ObjIndexKeyHash
+{
+	size_t operator()(const ObjIndexKey& key) const
+	{
+		size_t hash = (size_t)key.Position * 73856093u;
+		hash ^= (size_t)key.TexCoord * 19349663u;
+		hash ^= (size_t)key.Normal * 83492791u;
+		return hash;
+	}
+};
+
+static inline const char* SkipSpaces(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+static inline const char* NextLine(const char* p, const char* end) {
+	while (p < end && *p != '\n')
+		p++;
+	return p < end ? p + 1 : end;
+}
+
+static const char* ParseFloats(const char* p, const char* end, float* out, int count) {
+	for (int i = 0; i < count; i++) {
+		p = SkipSpaces(p, end);
+		char* next = nullptr;
+		out[i] = std::strtof(p, &next);
+		if (next == p)
+			out[i] = 0.0f;
+		p = next;
+	}
+	return p;
+}
+
+// Parses "v", "v/vt", "v//vn" or "v/vt/vn"; indices are made 0-based and
+// negative (relative) indices resolved. Absent components become -1.
+static const char* ParseFaceVertex(const char* p, const char* end, int positions, int texCoords, int normals, ObjIndexKey& key) {
+	auto resolve = [](long index, int count) { return (int)(index < 0 ? count + index : index - 1); };
+
+	char* next = nullptr;
+	key.Position = resolve(std::strtol(p, &next, 10), positions);
+	key.TexCoord = -1;
+	key.Normal = -1;
+	p = next;
+
+	if (p < end && *p == '/') {
+		p++;
+		if (p < end && *p != '/') {
+			key.TexCoord = resolve(std::strtol(p, &next, 10), texCoords);
+			p = next;
+		}
+		if (p < end && *p == '/') {
+			p++;
+			key.Normal = resolve(std::strtol(p, &next, 10), normals);
+			p = next;
+		}
+	}
+	return p;
+}
+
+bool ObjLoader::Load(const std::string& filepath, MeshData& mesh)
+{
+	std::string contents;
+	if (!FileUtils::ReadFile(filepath, contents)) {
+		std::cout << "Could not read " << filepath << std::endl;
+		return false;
+	}
+	return Parse(contents.c_str(), contents.size(), mesh);
+}
+
+bool ObjLoader::Parse(const char* text, size_t length, MeshData& mesh)
+{
+	std::vector<float> positions, normals, texCoords;
+	std::vector<ObjVertex> vertices;
+	std::vector<uint32_t>& indices = mesh.Indices;
+	std::unordered_map<ObjIndexKey, uint32_t, ObjIndexKeyHash> lookup;
+	indices.clear();
+
+	const char* p = text;
+	const char* end = text + length;
+	std::vector<uint32_t> polygon;
+	while (p < end) {
+		p = SkipSpaces(p, end);
+		if (end - p >= 2 && p[0] == 'v' && p[1] == ' ') {
+			float value[3];
+			p = ParseFloats(p + 2, end, value, 3);
+			positions.insert(positions.end(), value, value + 3);
+		}
+		else if (end - p >= 3 && p[0] == 'v' && p[1] == 'n' && p[2] == ' ') {
+			float value[3];
+			p = ParseFloats(p + 3, end, value, 3);
+			normals.insert(normals.end(), value, value + 3);
+		}
+		else if (end - p >= 3 && p[0] == 'v' && p[1] == 't' && p[2] == ' ') {
+			float value[2];
+			p = ParseFloats(p + 3, end, value, 2);
+			texCoords.insert(texCoords.end(), value, value + 2);
+		}
+		else if (end - p >= 2 && p[0] == 'f' && p[1] == ' ') {
+			p += 2;
+			polygon.clear();
+			int positionCount = (int)positions.size() / 3, texCoordCount = (int)texCoords.size() / 2, normalCount = (int)normals.size() / 3;
+			while (true) {
+				p = SkipSpaces(p, end);
+				if (p >= end || *p == '\n' || *p == '\r' || *p == '#')
+					break;
+
+				ObjIndexKey key;
+				const char* next = ParseFaceVertex(p, end, positionCount, texCoordCount, normalCount, key);
+				if (next == p || key.Position < 0 || key.Position >= positionCount) {
+					std::cout << "Malformed OBJ face" << std::endl;
+					return false;
+				}
+				p = next;
+
+				auto it = lookup.find(key);
+				if (it == lookup.end()) {
+					ObjVertex vertex = {};
+					memcpy(vertex.Position, &positions[key.Position * 3], sizeof(vertex.Position));
+					if (key.Normal >= 0 && key.Normal < normalCount)
+						memcpy(vertex.Normal, &normals[key.Normal * 3], sizeof(vertex.Normal));
+					if (key.TexCoord >= 0 && key.TexCoord < texCoordCount)
+						memcpy(vertex.TexCoord, &texCoords[key.TexCoord * 2], sizeof(vertex.TexCoord));
+
+					it = lookup.emplace(key, (uint32_t)vertices.size()).first;
+					vertices.push_back(vertex);
+				}
+				polygon.push_back(it->second);
+			}
+
+			for (size_t i = 2; i < polygon.size(); i++) {
+				indices.push_back(polygon[0]);
+				indices.push_back(polygon[i - 1]);
+				indices.push_back(polygon[i]);
+			}
+		}
+		p = NextLine(p, end);
+	}
+
+	if (vertices.empty() || indices.empty()) {
+		std::cout << "OBJ contains no faces" << std::endl;
+		return false;
+	}
+
+	mesh.VertexStride = sizeof(ObjVertex);
+	mesh.Attributes = {
+		{ s_Float, 3, 0, 0, 0, 0 },
+		{ s_Float, 3, 0, 0, 0, 12 },
+		{ s_Float, 2, 0, 0, 0, 24 }
+	};
+	mesh.Vertices.resize(vertices.size() * sizeof(ObjVertex));
+	memcpy(mesh.Vertices.data(), vertices.data(), mesh.Vertices.size());
+
+	for (int axis = 0; axis < 3; axis++) {
+		mesh.BoundsMin[axis] = vertices[0].Position[axis];
+		mesh.BoundsMax[axis] = vertices[0].Position[axis];
+	}
+	for (const ObjVertex& vertex : vertices) {
+		for (int axis = 0; axis < 3; axis++) {
+			if (vertex.Position[axis] < mesh.BoundsMin[axis]) mesh.BoundsMin[axis] = vertex.Position[axis];
+			if (vertex.Position[axis] > mesh.BoundsMax[axis]) mesh.BoundsMax[axis] = vertex.Position[axis];
+		}
+	}
+	return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+#include "MeshFile.h"
+
+// Wavefront OBJ importer. Produces interleaved position (float3), normal
+// (float3) and texture coordinate (float2) vertices with one vertex per
+// unique v/vt/vn combination; polygons are triangulated as fans. Missing
+// normals or texture coordinates are written as zero.
+class ObjLoader {
+public:
+	static bool Load(const std::string& filepath, MeshData& mesh);
+	static bool Parse(const char* text, size_t length, MeshData& mesh);
+};
@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Profiler.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "VertexBuffer.h"
+#include "UniformBuffer.h"
+
+struct CpuEvent
+{
+	const char* Name;
+	uint64_t Start;
+	uint64_t End;
+};
+
+// A ring slot, copied by WriteChromeTrace while its thread may be writing it.
+// Sequence is 2 * index + 1 while event index is being written and
+// 2 * index + 2 once it is complete, so a copy that raced a write is detected.
+struct CpuEventSlot
+{
+	std::atomic<const char*> Name{ nullptr };
+	std::atomic<uint64_t> Start{ 0 };
+	std::atomic<uint64_t> End{ 0 };
+	std::atomic<uint64_t> Sequence{ 0 };
+};
+
+// Written only by its own thread. Written counts every event ever recorded,
+// so an event lives at Written % EventsPerThread until it is overwritten.
+struct ThreadEvents
+{
+	std::unique_ptr<CpuEventSlot[]> Events;
+	std::atomic<uint64_t> Written{ 0 };
+	unsigned int Id = 0;
+	std::string Name;
+};
+
+struct GpuEvent
+{
+	const char* Name;
+	unsigned int BeginQuery;
+	unsigned int EndQuery;
+};
+
+// Queries of one frame in flight
+struct GpuFrame
+{
+	uint64_t Frame = 0;
+	bool Pending = false;
+	unsigned int FrameQuery = 0;
+	std::vector<unsigned int> Queries;
+	unsigned int QueriesUsed = 0;
+	std::vector<GpuEvent> Events;
+};
+
+struct ResolvedGpuEvent
+{
+	const char* Name;
+	uint64_t Start;
+	uint64_t End;
+};
+
+// Counters the per-frame stats are computed from, as deltas between frames
+struct FrameCounters
+{
+	unsigned int DrawCalls = 0;
+	unsigned long long StateChanges = 0;
+	unsigned long long BufferBytes = 0;
+};
+
+static std::atomic<bool> s_Enabled{ false };
+static const uint64_t s_Epoch = Profiler::GetTime();
+
+static std::mutex s_ThreadsMutex;
+static std::vector<std::unique_ptr<ThreadEvents>> s_Threads;
+static thread_local ThreadEvents* t_Events = nullptr;
+
+static Profiler::FrameStats s_Frames[Profiler::FrameHistory];
+static uint64_t s_FrameIndex = 0;
+static uint64_t s_FrameStart = 0;
+static bool s_InFrame = false;
+static FrameCounters s_FrameCounters;
+
+static bool s_GpuInitialized = false;
+static int64_t s_GpuClockOffset = 0;
+static GpuFrame s_GpuFrames[Profiler::GpuLatency];
+static GpuFrame* s_CurrentGpuFrame = nullptr;
+static std::vector<ResolvedGpuEvent> s_GpuEvents;
+static uint64_t s_GpuEventsWritten = 0;
+static unsigned int s_DroppedGpuFrames = 0;
+
+static ThreadEvents& GetThreadEvents() {
+	if (!t_Events) {
+		std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+		std::unique_ptr<ThreadEvents> events = std::make_unique<ThreadEvents>();
+		events->Events = std::make_unique<CpuEventSlot[]>(Profiler::EventsPerThread);
+		events->Id = (unsigned int)s_Threads.size() + 1;
+		t_Events = events.get();
+		s_Threads.push_back(std::move(events));
+	}
+	return *t_Events;
+}
+
+static FrameCounters ReadFrameCounters() {
+	FrameCounters counters;
+	counters.DrawCalls = Renderer::GetStats().DrawCalls;
+	counters.StateChanges = GLState::GetStats().Issued;
+	counters.BufferBytes = VertexBuffer::GetStats().BytesUploaded + UniformBuffer::GetStats().BytesUploaded;
+	return counters;
+}
+
+// A counter that went backwards was reset during the frame
+template<typename T>
+static T CounterDelta(T now, T before) {
+	return now >= before ? now - before : now;
+}
+
+static void CalibrateGpuClock() {
+	GLint64 gpuTime = 0;
+	GLCall(glGetInteger64v(GL_TIMESTAMP, &gpuTime));
+	s_GpuClockOffset = (int64_t)Profiler::GetTime() - (int64_t)gpuTime;
+}
+
+static unsigned int AcquireQuery(GpuFrame& frame) {
+	if (frame.QueriesUsed == frame.Queries.size()) {
+		unsigned int query;
+		GLCall(glGenQueries(1, &query));
+		frame.Queries.push_back(query);
+	}
+	return frame.Queries[frame.QueriesUsed++];
+}
+
+static void ResolveGpuFrame(GpuFrame& frame) {
+	frame.Pending = false;
+
+	// Results arrive in submission order, so the last query decides for all
+	GLint available = 0;
+	unsigned int lastQuery = frame.QueriesUsed > 0 ? frame.Queries[frame.QueriesUsed - 1] : frame.FrameQuery;
+	GLCall(glGetQueryObjectiv(frame.FrameQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+	if (available) {
+		GLCall(glGetQueryObjectiv(lastQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+	}
+
+	if (!available) {
+		// Still in flight after GpuLatency frames. Waiting would stall, and
+		// reusing the objects might, so give up on the frame and start over.
+		GLCall(glDeleteQueries(1, &frame.FrameQuery));
+		if (!frame.Queries.empty()) {
+			GLCall(glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data()));
+		}
+		frame.Queries.clear();
+		GLCall(glGenQueries(1, &frame.FrameQuery));
+		s_DroppedGpuFrames++;
+		return;
+	}
+
+	GLuint64 elapsed = 0;
+	GLCall(glGetQueryObjectui64v(frame.FrameQuery, GL_QUERY_RESULT, &elapsed));
+	Profiler::FrameStats& stats = s_Frames[frame.Frame % Profiler::FrameHistory];
+	if (stats.Frame == frame.Frame)
+		stats.GpuMilliseconds = elapsed / 1000000.0;
+
+	for (const GpuEvent& event : frame.Events) {
+		if (event.EndQuery == 0)
+			continue;
+
+		GLuint64 begin = 0, end = 0;
+		GLCall(glGetQueryObjectui64v(event.BeginQuery, GL_QUERY_RESULT, &begin));
+		GLCall(glGetQueryObjectui64v(event.EndQuery, GL_QUERY_RESULT, &end));
+		ResolvedGpuEvent& resolved = s_GpuEvents[s_GpuEventsWritten++ % Profiler::GpuEventCapacity];
+		resolved.Name = event.Name;
+		resolved.Start = (uint64_t)((int64_t)begin + s_GpuClockOffset);
+		resolved.End = (uint64_t)((int64_t)end + s_GpuClockOffset);
+	}
+}
+
+static void WriteJsonString(std::ostream& stream, const char* text) {
+	stream << '"';
+	for (const char* c = text; *c; c++) {
+		if (*c == '"' || *c == '\\')
+			stream << '\\' << *c;
+		else if ((unsigned char)*c < 0x20)
+			stream << ' ';
+		else
+			stream << *c;
+	}
+	stream << '"';
+}
+
+// Trace timestamps are microseconds since the profiler started
+static double ToTraceTime(uint64_t time) {
+	return time > s_Epoch ? (time - s_Epoch) / 1000.0 : 0.0;
+}
+
+static void WriteCompleteEvent(std::ostream& stream, const char* name, const char* category, uint64_t start, uint64_t end, unsigned int thread) {
+	stream << ",\n{\"name\":";
+	WriteJsonString(stream, name);
+	stream << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"ts\":" << ToTraceTime(start)
+		<< ",\"dur\":" << (end > start ? (end - start) / 1000.0 : 0.0) << ",\"pid\":1,\"tid\":" << thread << "}";
+}
+
+static void WriteThreadName(std::ostream& stream, unsigned int thread, const char* name) {
+	stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":";
+	WriteJsonString(stream, name);
+	stream << "}}";
+}
+
+namespace Profiler {
+
+	void SetEnabled(bool enabled)
+	{
+		if (enabled && !s_Enabled && s_GpuInitialized)
+			CalibrateGpuClock();
+		s_Enabled = enabled;
+	}
+
+	bool IsEnabled()
+	{
+		return s_Enabled.load(std::memory_order_relaxed);
+	}
+
+	bool InitGpu()
+	{
+		if (s_GpuInitialized)
+			return true;
+		if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query) {
+			std::cout << "Timer queries are not supported, GPU scopes will not be recorded" << std::endl;
+			return false;
+		}
+
+		for (GpuFrame& frame : s_GpuFrames) {
+			GLCall(glGenQueries(1, &frame.FrameQuery));
+		}
+		s_GpuEvents.resize(GpuEventCapacity);
+		CalibrateGpuClock();
+		s_GpuInitialized = true;
+		return true;
+	}
+
+	void ShutdownGpu()
+	{
+		if (!s_GpuInitialized)
+			return;
+
+		for (GpuFrame& frame : s_GpuFrames) {
+			GLCall(glDeleteQueries(1, &frame.FrameQuery));
+			if (!frame.Queries.empty()) {
+				GLCall(glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data()));
+			}
+			frame = GpuFrame();
+		}
+		s_CurrentGpuFrame = nullptr;
+		s_GpuInitialized = false;
+	}
+
+	void BeginFrame()
+	{
+		if (!IsEnabled())
+			return;
+
+		s_InFrame = true;
+		s_FrameStart = GetTime();
+		s_FrameCounters = ReadFrameCounters();
+
+		if (s_GpuInitialized) {
+			GpuFrame& frame = s_GpuFrames[s_FrameIndex % GpuLatency];
+			if (frame.Pending)
+				ResolveGpuFrame(frame);
+
+			frame.Frame = s_FrameIndex;
+			frame.QueriesUsed = 0;
+			frame.Events.clear();
+			GLCall(glBeginQuery(GL_TIME_ELAPSED, frame.FrameQuery));
+			s_CurrentGpuFrame = &frame;
+		}
+	}
+
+	void EndFrame()
+	{
+		if (!s_InFrame)
+			return;
+
+		uint64_t end = GetTime();
+		if (s_CurrentGpuFrame) {
+			GLCall(glEndQuery(GL_TIME_ELAPSED));
+			s_CurrentGpuFrame->Pending = true;
+			s_CurrentGpuFrame = nullptr;
+		}
+		RecordCpuEvent("Frame", s_FrameStart, end);
+
+		FrameCounters counters = ReadFrameCounters();
+		FrameStats& stats = s_Frames[s_FrameIndex % FrameHistory];
+		stats = FrameStats();
+		stats.Frame = s_FrameIndex;
+		stats.StartNanoseconds = s_FrameStart;
+		stats.CpuMilliseconds = (end - s_FrameStart) / 1000000.0;
+		stats.DrawCalls = CounterDelta(counters.DrawCalls, s_FrameCounters.DrawCalls);
+		stats.StateChanges = CounterDelta(counters.StateChanges, s_FrameCounters.StateChanges);
+		stats.BufferBytes = CounterDelta(counters.BufferBytes, s_FrameCounters.BufferBytes);
+
+		s_FrameIndex++;
+		s_InFrame = false;
+	}
+
+	void SetThreadName(const char* name)
+	{
+		ThreadEvents& events = GetThreadEvents();
+		std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+		events.Name = name;
+	}
+
+	uint64_t GetTime()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void RecordCpuEvent(const char* name, uint64_t start, uint64_t end)
+	{
+		if (!IsEnabled())
+			return;
+
+		ThreadEvents& events = GetThreadEvents();
+		uint64_t index = events.Written.load(std::memory_order_relaxed);
+		CpuEventSlot& slot = events.Events[index % EventsPerThread];
+		slot.Sequence.store(index * 2 + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.Name.store(name, std::memory_order_relaxed);
+		slot.Start.store(start, std::memory_order_relaxed);
+		slot.End.store(end, std::memory_order_relaxed);
+		slot.Sequence.store(index * 2 + 2, std::memory_order_release);
+		events.Written.store(index + 1, std::memory_order_release);
+	}
+
+	int BeginGpuEvent(const char* name)
+	{
+		if (!s_CurrentGpuFrame || !IsEnabled())
+			return -1;
+
+		unsigned int query = AcquireQuery(*s_CurrentGpuFrame);
+		GLCall(glQueryCounter(query, GL_TIMESTAMP));
+		s_CurrentGpuFrame->Events.push_back({ name, query, 0 });
+		return (int)s_CurrentGpuFrame->Events.size() - 1;
+	}
+
+	void EndGpuEvent(int event)
+	{
+		if (event < 0 || !s_CurrentGpuFrame || (size_t)event >= s_CurrentGpuFrame->Events.size())
+			return;
+
+		unsigned int query = AcquireQuery(*s_CurrentGpuFrame);
+		GLCall(glQueryCounter(query, GL_TIMESTAMP));
+		s_CurrentGpuFrame->Events[event].EndQuery = query;
+	}
+
+	unsigned int GetFrameCount()
+	{
+		return (unsigned int)std::min<uint64_t>(s_FrameIndex, FrameHistory);
+	}
+
+	const FrameStats& GetFrameStats(unsigned int framesAgo)
+	{
+		ASSERT(framesAgo < GetFrameCount());
+		return s_Frames[(s_FrameIndex - 1 - framesAgo) % FrameHistory];
+	}
+
+	double GetFrameTimePercentile(double percentile)
+	{
+		unsigned int count = GetFrameCount();
+		if (count == 0)
+			return 0.0;
+
+		std::vector<double> times(count);
+		for (unsigned int i = 0; i < count; i++)
+			times[i] = GetFrameStats(i).CpuMilliseconds;
+		std::sort(times.begin(), times.end());
+
+		size_t rank = (size_t)(percentile / 100.0 * count + 0.5);
+		return times[std::min<size_t>(rank > 0 ? rank - 1 : 0, count - 1)];
+	}
+
+	void PrintSummary()
+	{
+		unsigned int count = GetFrameCount();
+		if (count == 0)
+			return;
+
+		double gpuTotal = 0.0, drawCalls = 0.0, stateChanges = 0.0, bufferBytes = 0.0;
+		unsigned int gpuFrames = 0;
+		for (unsigned int i = 0; i < count; i++) {
+			const FrameStats& stats = GetFrameStats(i);
+			if (stats.GpuMilliseconds >= 0.0) {
+				gpuTotal += stats.GpuMilliseconds;
+				gpuFrames++;
+			}
+			drawCalls += stats.DrawCalls;
+			stateChanges += stats.StateChanges;
+			bufferBytes += stats.BufferBytes;
+		}
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< "Last " << count << " frames:" << std::endl
+			<< "  CPU frame time p50 " << GetFrameTimePercentile(50.0) << " ms, p95 " << GetFrameTimePercentile(95.0)
+			<< " ms, p99 " << GetFrameTimePercentile(99.0) << " ms, max " << GetFrameTimePercentile(100.0) << " ms" << std::endl;
+		if (gpuFrames > 0)
+			std::cout << "  GPU frame time avg " << gpuTotal / gpuFrames << " ms (" << s_DroppedGpuFrames << " frames dropped)" << std::endl;
+		std::cout << "  per frame: " << drawCalls / count << " draw calls, " << stateChanges / count << " state changes, "
+			<< bufferBytes / count / 1024.0 << " KiB uploaded" << std::endl;
+		std::cout << std::defaultfloat;
+	}
+
+	bool WriteChromeTrace(const std::string& filepath)
+	{
+		std::ofstream stream(filepath, std::ios::out | std::ios::trunc);
+		if (!stream) {
+			std::cout << "Could not write trace " << filepath << std::endl;
+			return false;
+		}
+
+		stream << std::fixed << std::setprecision(3);
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"OpenGLProject\"}}";
+
+		std::vector<CpuEvent> events;
+		{
+			std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+			for (const std::unique_ptr<ThreadEvents>& thread : s_Threads) {
+				uint64_t written = thread->Written.load(std::memory_order_acquire);
+				uint64_t first = written > EventsPerThread ? written - EventsPerThread : 0;
+				events.clear();
+				for (uint64_t i = first; i < written; i++) {
+					// Keep the copy only if the slot still held event i, unchanged, around it
+					const CpuEventSlot& slot = thread->Events[i % EventsPerThread];
+					uint64_t sequence = slot.Sequence.load(std::memory_order_acquire);
+					CpuEvent event = { slot.Name.load(std::memory_order_relaxed), slot.Start.load(std::memory_order_relaxed), slot.End.load(std::memory_order_relaxed) };
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (sequence == i * 2 + 2 && slot.Sequence.load(std::memory_order_relaxed) == sequence)
+						events.push_back(event);
+				}
+
+				std::string name = thread->Name.empty() ? "Thread " + std::to_string(thread->Id) : thread->Name;
+				WriteThreadName(stream, thread->Id, name.c_str());
+				for (const CpuEvent& event : events)
+					WriteCompleteEvent(stream, event.Name, "cpu", event.Start, event.End, thread->Id);
+			}
+		}
+
+		if (s_GpuEventsWritten > 0) {
+			WriteThreadName(stream, 0, "GPU");
+			uint64_t first = s_GpuEventsWritten > GpuEventCapacity ? s_GpuEventsWritten - GpuEventCapacity : 0;
+			for (uint64_t i = first; i < s_GpuEventsWritten; i++) {
+				const ResolvedGpuEvent& event = s_GpuEvents[i % GpuEventCapacity];
+				WriteCompleteEvent(stream, event.Name, "gpu", event.Start, event.End, 0);
+			}
+		}
+
+		unsigned int frames = GetFrameCount();
+		for (unsigned int i = frames; i-- > 0;) {
+			const FrameStats& stats = GetFrameStats(i);
+			stream << ",\n{\"name\":\"Frame stats\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ToTraceTime(stats.StartNanoseconds)
+				<< ",\"args\":{\"CPU ms\":" << stats.CpuMilliseconds;
+			if (stats.GpuMilliseconds >= 0.0)
+				stream << ",\"GPU ms\":" << stats.GpuMilliseconds;
+			stream << ",\"Draw calls\":" << stats.DrawCalls << ",\"State changes\":" << stats.StateChanges
+				<< ",\"Buffer KiB\":" << stats.BufferBytes / 1024.0 << "}}";
+		}
+
+		stream << "\n]}\n";
+		return (bool)stream;
+	}
+
+}
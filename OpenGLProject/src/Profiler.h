@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Frame profiler. CPU scopes are written to a fixed ring per thread without
+// locking; GPU scopes are GL_TIMESTAMP query pairs that are read back
+// GpuLatency frames later, and only once available, so profiling never
+// waits on the GPU. Every frame between BeginFrame() and EndFrame() also
+// leaves a FrameStats entry in a ring of FrameHistory frames.
+//
+// Recording is off until SetEnabled(true). WriteChromeTrace() exports what
+// the rings still hold as trace_event JSON for chrome://tracing or Perfetto.
+//
+// Define PROFILING as 0 to compile every PROFILE_ macro away.
+#ifndef PROFILING
+	#define PROFILING 1
+#endif
+
+namespace Profiler {
+
+	const unsigned int FrameHistory = 256;
+	const unsigned int EventsPerThread = 1 << 16;
+	const unsigned int GpuEventCapacity = 1 << 14;
+	const unsigned int GpuLatency = 3;
+
+	struct FrameStats
+	{
+		uint64_t Frame = 0;
+		uint64_t StartNanoseconds = 0;
+		double CpuMilliseconds = 0.0;
+		// Negative until the frame's queries have been read back
+		double GpuMilliseconds = -1.0;
+		unsigned int DrawCalls = 0;
+		unsigned long long StateChanges = 0;
+		unsigned long long BufferBytes = 0;
+	};
+
+	void SetEnabled(bool enabled);
+	bool IsEnabled();
+
+	// Needs the GL context current on the calling thread, which is the only
+	// thread GPU scopes may be used from. Returns false without timer queries.
+	bool InitGpu();
+	void ShutdownGpu();
+
+	void BeginFrame();
+	void EndFrame();
+
+	// Shown as the thread's name in the trace
+	void SetThreadName(const char* name);
+
+	// Nanoseconds on the clock every CPU and GPU event is converted to
+	uint64_t GetTime();
+
+	// name must outlive the profiler, e.g. a string literal
+	void RecordCpuEvent(const char* name, uint64_t start, uint64_t end);
+	// Returns a handle for EndGpuEvent, or -1 when nothing is recorded
+	int BeginGpuEvent(const char* name);
+	void EndGpuEvent(int event);
+
+	// framesAgo 0 is the last completed frame
+	unsigned int GetFrameCount();
+	const FrameStats& GetFrameStats(unsigned int framesAgo);
+	// CPU frame time at percentile (0 - 100) over the recorded frames
+	double GetFrameTimePercentile(double percentile);
+	void PrintSummary();
+
+	// Call between frames; events overwritten while exporting are left out
+	bool WriteChromeTrace(const std::string& filepath);
+
+}
+
+class ProfileScope {
+private:
+	const char* m_Name;
+	uint64_t m_Start;
+public:
+	ProfileScope(const char* name)
+		: m_Name(name), m_Start(Profiler::IsEnabled() ? Profiler::GetTime() : 0) {}
+	~ProfileScope()
+	{
+		if (m_Start)
+			Profiler::RecordCpuEvent(m_Name, m_Start, Profiler::GetTime());
+	}
+};
+
+class GpuProfileScope {
+private:
+	int m_Event;
+public:
+	GpuProfileScope(const char* name)
+		: m_Event(Profiler::BeginGpuEvent(name)) {}
+	~GpuProfileScope() { Profiler::EndGpuEvent(m_Event); }
+};
+
+#if PROFILING
+	#define PROFILE_CONCAT2(a, b) a##b
+	#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+	#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+	#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+	#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+	#define PROFILE_SCOPE(name)
+	#define PROFILE_FUNCTION()
+	#define PROFILE_GPU_SCOPE(name)
+#endif
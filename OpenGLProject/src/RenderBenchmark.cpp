@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "RenderBenchmark.h"
+#include "Benchmark.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Framebuffer.h"
+#include "Image.h"
+#include "Profiler.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+#include "VertexBuffer.h"
+
+namespace RenderBenchmark {
+
+	struct Entry
+	{
+		const char* name;
+		SceneFactory factory;
+	};
+
+	// Function-local so registration works regardless of static init order
+	static std::vector<Entry>& GetRegistry()
+	{
+		static std::vector<Entry> registry;
+		return registry;
+	}
+
+	struct Counters
+	{
+		unsigned int DrawCalls = 0;
+		unsigned long long StateChanges = 0;
+		unsigned long long StateChangesSkipped = 0;
+		unsigned long long BufferBytes = 0;
+		unsigned long long UniformUploads = 0;
+		unsigned long long TextureBytes = 0;
+	};
+
+	struct Distribution
+	{
+		double Mean = 0.0;
+		double P50 = 0.0;
+		double P95 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+	static Counters ReadCounters()
+	{
+		Counters counters;
+		counters.DrawCalls = Renderer::GetStats().DrawCalls;
+		counters.StateChanges = GLState::GetStats().Issued;
+		counters.StateChangesSkipped = GLState::GetStats().Skipped;
+		counters.BufferBytes = VertexBuffer::GetStats().BytesUploaded + UniformBuffer::GetStats().BytesUploaded;
+		counters.UniformUploads = Shader::GetUniformStats().Uploads;
+		counters.TextureBytes = Texture::GetStats().BytesUploaded;
+		return counters;
+	}
+
+	static Distribution Summarize(std::vector<double> values)
+	{
+		Distribution distribution;
+		if (values.empty())
+			return distribution;
+
+		std::sort(values.begin(), values.end());
+		auto percentile = [&values](double p) {
+			size_t rank = (size_t)(p / 100.0 * values.size() + 0.5);
+			return values[std::min(rank > 0 ? rank - 1 : 0, values.size() - 1)];
+		};
+		for (double value : values)
+			distribution.Mean += value;
+		distribution.Mean /= values.size();
+		distribution.P50 = percentile(50.0);
+		distribution.P95 = percentile(95.0);
+		distribution.P99 = percentile(99.0);
+		distribution.Max = values.back();
+		return distribution;
+	}
+
+	static std::string JsonString(const std::string& text)
+	{
+		std::string quoted = "\"";
+		for (char c : text) {
+			if (c == '"' || c == '\\')
+				quoted += '\\';
+			quoted += (unsigned char)c < 0x20 ? ' ' : c;
+		}
+		return quoted + "\"";
+	}
+
+	static void WriteDistribution(std::ostream& json, const char* name, const Distribution& distribution)
+	{
+		json << "\"" << name << "\": { \"mean\": " << distribution.Mean << ", \"p50\": " << distribution.P50
+			<< ", \"p95\": " << distribution.P95 << ", \"p99\": " << distribution.P99 << ", \"max\": " << distribution.Max << " }";
+	}
+
+	static void PrintUsage()
+	{
+		std::cout << "Usage: OpenGLProject --headless [--scene filter] [--frames n] [--size WxH] [--json file]" << std::endl
+			<< "                                  [--golden dir] [--update-golden] [--tolerance n]" << std::endl;
+	}
+
+	bool ParseOptions(int argc, char* args[], Options& options)
+	{
+		for (int i = 0; i < argc; i++) {
+			std::string option = args[i];
+			bool hasValue = i + 1 < argc;
+			if (option == "--update-golden") {
+				options.UpdateGolden = true;
+			}
+			else if (option == "--scene" && hasValue) {
+				options.Filter = args[++i];
+			}
+			else if (option == "--frames" && hasValue) {
+				options.Frames = (unsigned int)std::max(1, atoi(args[++i]));
+			}
+			else if (option == "--size" && hasValue) {
+				if (sscanf(args[++i], "%ux%u", &options.Width, &options.Height) != 2 || options.Width == 0 || options.Height == 0) {
+					PrintUsage();
+					return false;
+				}
+			}
+			else if (option == "--json" && hasValue) {
+				options.JsonPath = args[++i];
+			}
+			else if (option == "--golden" && hasValue) {
+				options.GoldenDirectory = args[++i];
+			}
+			else if (option == "--tolerance" && hasValue) {
+				options.Tolerance = (unsigned int)std::max(0, atoi(args[++i]));
+			}
+			else {
+				std::cout << "Unknown or incomplete option " << option << std::endl;
+				PrintUsage();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool RegisterScene(const char* name, SceneFactory factory)
+	{
+		GetRegistry().push_back({ name, factory });
+		return true;
+	}
+
+	// Runs one scene and appends its JSON object. Returns false on failure.
+	static bool RunScene(const Entry& entry, const Options& options, const Framebuffer& target, unsigned int frames, std::ostream& json)
+	{
+		json << "    { \"name\": " << JsonString(entry.name) << ", ";
+
+		// Every scene starts from the same fixed-function state
+		target.Bind();
+		GLState::SetBlend(false);
+		GLState::SetDepthTest(false);
+		GLState::DepthMask(true);
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+
+		std::unique_ptr<RenderScene> scene = entry.factory();
+		if (!scene->Init(options.Width, options.Height)) {
+			std::cout << "  setup failed" << std::endl;
+			json << "\"status\": \"setup failed\" }";
+			return false;
+		}
+
+		for (unsigned int i = 0; i < options.WarmupFrames; i++)
+			scene->Render(i);
+		GLCall(glFinish());
+
+		Counters before = ReadCounters();
+		std::vector<double> cpuTimes;
+		cpuTimes.reserve(frames);
+		// Without a swap nothing stops the CPU from running ahead of the GPU.
+		// The profiler reuses a frame's timer queries GpuLatency frames later,
+		// so wait for that frame to finish first or its GPU time is dropped.
+		GLsync frameFences[Profiler::GpuLatency] = {};
+		Timer timer;
+		bool waitFailed = false;
+		for (unsigned int i = 0; i < frames; i++) {
+			GLsync& fence = frameFences[i % Profiler::GpuLatency];
+			if (fence) {
+				GLCall(GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull));
+				waitFailed = waitFailed || result == GL_WAIT_FAILED;
+				GLCall(glDeleteSync(fence));
+			}
+
+			Profiler::BeginFrame();
+			scene->Render(options.WarmupFrames + i);
+			Profiler::EndFrame();
+			cpuTimes.push_back(Profiler::GetFrameStats(0).CpuMilliseconds);
+			GLCall(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		}
+		GLCall(glFinish());
+		for (GLsync fence : frameFences) {
+			if (fence) {
+				GLCall(glDeleteSync(fence));
+			}
+		}
+		double wallMs = timer.ElapsedMilliseconds();
+		Counters after = ReadCounters();
+
+		// Empty frames so the profiler reads back the last frames' timer queries
+		for (unsigned int i = 0; i < Profiler::GpuLatency; i++) {
+			Profiler::BeginFrame();
+			Profiler::EndFrame();
+		}
+		std::vector<double> gpuTimes;
+		for (unsigned int i = 0; i < frames; i++) {
+			const Profiler::FrameStats& stats = Profiler::GetFrameStats(Profiler::GpuLatency + i);
+			if (stats.GpuMilliseconds >= 0.0)
+				gpuTimes.push_back(stats.GpuMilliseconds);
+		}
+
+		unsigned int missingGpuFrames = frames - (unsigned int)gpuTimes.size();
+		Distribution cpu = Summarize(cpuTimes);
+		Distribution gpu = Summarize(gpuTimes);
+		double frameMs = wallMs / frames;
+		double drawCalls = (double)(after.DrawCalls - before.DrawCalls) / frames;
+		double stateChanges = (double)(after.StateChanges - before.StateChanges) / frames;
+		double stateChangesSkipped = (double)(after.StateChangesSkipped - before.StateChangesSkipped) / frames;
+		double bufferBytes = (double)(after.BufferBytes - before.BufferBytes) / frames;
+		double uniformUploads = (double)(after.UniformUploads - before.UniformUploads) / frames;
+		double textureBytes = (double)(after.TextureBytes - before.TextureBytes) / frames;
+
+		Benchmark::Report("frame time (wall)", frameMs, "ms");
+		Benchmark::Report("frames per second", 1000.0 / frameMs, "");
+		Benchmark::Report("CPU frame p50", cpu.P50, "ms");
+		Benchmark::Report("CPU frame p99", cpu.P99, "ms");
+		if (!gpuTimes.empty()) {
+			Benchmark::Report("GPU frame p50", gpu.P50, "ms");
+			Benchmark::Report("GPU frame p99", gpu.P99, "ms");
+		}
+		Benchmark::Report("frames without GPU time", missingGpuFrames, "");
+		Benchmark::Report("draw calls per frame", drawCalls, "");
+		Benchmark::Report("state changes per frame", stateChanges, "");
+		Benchmark::Report("buffer uploads per frame", bufferBytes / 1024.0, "KiB");
+		Benchmark::Report("texture uploads per frame", textureBytes / 1024.0, "KiB");
+		Benchmark::Report("texture memory", Texture::GetMemoryUsage() / (1024.0 * 1024.0), "MiB");
+
+		json << "\"frames\": " << frames << ", \"frame_ms\": " << frameMs << ", \"fps\": " << 1000.0 / frameMs << ",\n      ";
+		WriteDistribution(json, "cpu_ms", cpu);
+		if (!gpuTimes.empty()) {
+			json << ",\n      ";
+			WriteDistribution(json, "gpu_ms", gpu);
+		}
+		json << ",\n      \"gpu_missing_frames\": " << missingGpuFrames;
+		json << ",\n      \"counters_per_frame\": { \"draw_calls\": " << drawCalls << ", \"state_changes\": " << stateChanges
+			<< ", \"state_changes_skipped\": " << stateChangesSkipped << ", \"buffer_bytes\": " << bufferBytes
+			<< ", \"uniform_uploads\": " << uniformUploads << ", \"texture_bytes\": " << textureBytes << " },\n      "
+			<< "\"texture_memory_bytes\": " << Texture::GetMemoryUsage() << ",\n      ";
+
+		// Compared frame and file name must not depend on --frames, and the
+		// image only matches goldens rendered at the same size
+		scene->Render(GoldenFrame);
+		Image image;
+		image.Width = options.Width;
+		image.Height = options.Height;
+		target.ReadPixels(image.Pixels);
+		std::string size = std::to_string(options.Width) + "x" + std::to_string(options.Height);
+		std::string goldenPath = options.GoldenDirectory + "/" + entry.name + "_" + size + ".tga";
+		std::string actualPath = std::string(entry.name) + "_" + size + ".actual.tga";
+
+		std::error_code error;
+		bool passed = true;
+		std::string status;
+		ImageDifference difference;
+		if (waitFailed) {
+			passed = false;
+			status = "frame fence wait failed";
+		}
+		else if (options.UpdateGolden) {
+			std::filesystem::create_directories(options.GoldenDirectory, error);
+			passed = WriteTGA(goldenPath, image);
+			status = passed ? "golden updated" : "could not write golden";
+		}
+		else if (!std::filesystem::exists(goldenPath, error)) {
+			// Otherwise a checkout without goldens could never fail
+			passed = false;
+			status = "no golden";
+			WriteTGA(actualPath, image);
+		}
+		else {
+			Image golden;
+			if (!LoadTGA(goldenPath, golden))
+				passed = false;
+			else if (!CompareImages(image, golden, options.Tolerance, difference))
+				passed = false;
+			else
+				passed = difference.MismatchedFraction <= options.MaxMismatchedFraction;
+			status = passed ? "passed" : "image mismatch";
+
+			// Keep what was rendered next to where it was run, for inspection
+			if (!passed)
+				WriteTGA(actualPath, image);
+		}
+
+		std::cout << "  image: " << status;
+		if (difference.MismatchedPixels > 0)
+			std::cout << " (" << difference.MismatchedPixels << " pixels differ, max channel difference " << difference.MaxChannelDifference << ")";
+		std::cout << std::endl;
+
+		json << "\"image\": { \"golden\": " << JsonString(goldenPath) << ", \"status\": " << JsonString(status)
+			<< ", \"mismatched_pixels\": " << difference.MismatchedPixels << ", \"max_channel_difference\": " << difference.MaxChannelDifference << " },\n      "
+			<< "\"status\": " << JsonString(passed ? "ok" : "failed") << " }";
+		return passed;
+	}
+
+	int Run(const Options& options)
+	{
+		// GPU times of a frame come back GpuLatency frames later and have to
+		// still be in the profiler's frame history
+		unsigned int frames = std::min(options.Frames, Profiler::FrameHistory - Profiler::GpuLatency);
+		if (frames < options.Frames)
+			std::cout << "Limiting the run to " << frames << " frames per scene" << std::endl;
+
+		Framebuffer target(options.Width, options.Height);
+		if (!target.IsComplete()) {
+			std::cout << "Could not create a " << options.Width << "x" << options.Height << " offscreen framebuffer" << std::endl;
+			return 1;
+		}
+
+		Profiler::InitGpu();
+		bool wasEnabled = Profiler::IsEnabled();
+		Profiler::SetEnabled(true);
+
+		std::ostringstream json;
+		json << "{\n  \"device\": { \"vendor\": " << JsonString((const char*)glGetString(GL_VENDOR))
+			<< ", \"renderer\": " << JsonString((const char*)glGetString(GL_RENDERER))
+			<< ", \"version\": " << JsonString((const char*)glGetString(GL_VERSION)) << " },\n"
+			<< "  \"width\": " << options.Width << ", \"height\": " << options.Height << ",\n"
+			<< "  \"scenes\": [\n";
+
+		int ran = 0, failed = 0;
+		for (const Entry& entry : GetRegistry()) {
+			if (!options.Filter.empty() && std::string(entry.name).find(options.Filter) == std::string::npos)
+				continue;
+
+			std::cout << "[" << entry.name << "]" << std::endl;
+			if (ran > 0)
+				json << ",\n";
+			if (!RunScene(entry, options, target, frames, json))
+				failed++;
+			ran++;
+		}
+		json << "\n  ],\n  \"failed\": " << failed << "\n}\n";
+
+		Profiler::SetEnabled(wasEnabled);
+		target.Unbind();
+
+		if (ran == 0) {
+			std::cout << "No scene matches '" << options.Filter << "'" << std::endl;
+			return 1;
+		}
+
+		if (options.JsonPath.empty()) {
+			std::cout << json.str();
+		}
+		else {
+			std::ofstream stream(options.JsonPath, std::ios::out | std::ios::trunc);
+			stream << json.str();
+			if (!stream) {
+				std::cout << "Could not write " << options.JsonPath << std::endl;
+				return 1;
+			}
+			std::cout << "Wrote " << options.JsonPath << std::endl;
+		}
+
+		std::cout << ran - failed << " of " << ran << " scenes passed" << std::endl;
+		return failed > 0 ? 1 : 0;
+	}
+
+}
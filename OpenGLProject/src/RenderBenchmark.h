@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+// One workload of the headless render benchmark. Render() must only depend
+// on frame, not on time, so a frame can be compared to a golden image.
+class RenderScene {
+public:
+	virtual ~RenderScene() {}
+
+	// Called with the offscreen target bound. Returning false fails the scene.
+	virtual bool Init(unsigned int width, unsigned int height) = 0;
+	virtual void Render(unsigned int frame) = 0;
+};
+
+// Headless benchmark mode:
+//   OpenGLProject --headless [--scene filter] [--frames n] [--size WxH]
+//                            [--json file] [--golden dir] [--update-golden]
+// Every RENDER_SCENE renders into a Framebuffer for a fixed number of frames
+// without vsync. Frame time statistics and per-frame subsystem counters are
+// printed and written as JSON. Afterwards frame GoldenFrame of every scene is
+// rendered again and compared with <golden dir>/<scene>_<W>x<H>.tga.
+namespace RenderBenchmark {
+
+	typedef std::unique_ptr<RenderScene> (*SceneFactory)();
+
+	const unsigned int GoldenFrame = 0;
+
+	struct Options
+	{
+		std::string Filter;
+		unsigned int Frames = 200;
+		unsigned int WarmupFrames = 10;
+		unsigned int Width = 1280;
+		unsigned int Height = 720;
+		// Empty writes the JSON to stdout
+		std::string JsonPath;
+		std::string GoldenDirectory = "assets/golden";
+		bool UpdateGolden = false;
+		// A pixel mismatches when a channel differs by more than Tolerance;
+		// a scene fails when more than MaxMismatchedFraction of them do
+		unsigned int Tolerance = 8;
+		double MaxMismatchedFraction = 0.001;
+	};
+
+	// Parses the arguments following --headless
+	bool ParseOptions(int argc, char* args[], Options& options);
+
+	bool RegisterScene(const char* name, SceneFactory factory);
+
+	// Returns the process exit code: non-zero when a scene failed to set up
+	// or its golden frame does not match the golden image or has none. Run
+	// with --update-golden once to create the goldens.
+	int Run(const Options& options);
+
+}
+
+#define RENDER_SCENE(name, type) \
+	static bool s_RenderScene_##name##_Registered = RenderBenchmark::RegisterScene(#name, \
+		[]() -> std::unique_ptr<RenderScene> { return std::make_unique<type>(); })
@@ -0,0 +1,174 @@
+#include "RenderThread.h"
+#include "Timer.h"
+#include "Profiler.h"
+
+RenderFrame::RenderFrame()
+	: m_Count(0)
+{
+	SetCommandBufferCount(1);
+}
+
+void RenderFrame::SetCommandBufferCount(unsigned int count)
+{
+	while (m_CommandBuffers.size() < count)
+		m_CommandBuffers.emplace_back(new CommandBuffer());
+	m_Count = count;
+}
+
+CommandBuffer& RenderFrame::GetCommandBuffer(unsigned int index)
+{
+	ASSERT(index < m_Count);
+	return *m_CommandBuffers[index];
+}
+
+void RenderFrame::Execute(const Renderer& renderer) const
+{
+	for (unsigned int i = 0; i < m_Count; i++)
+		m_CommandBuffers[i]->Execute(renderer);
+}
+
+void RenderFrame::Reset()
+{
+	for (unsigned int i = 0; i < m_Count; i++)
+		m_CommandBuffers[i]->Reset();
+	m_Count = 1;
+}
+
+unsigned int RenderFrame::GetCommandCount() const
+{
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < m_Count; i++)
+		count += m_CommandBuffers[i]->GetCommandCount();
+	return count;
+}
+
+size_t RenderFrame::GetBytesUsed() const
+{
+	size_t bytes = 0;
+	for (unsigned int i = 0; i < m_Count; i++)
+		bytes += m_CommandBuffers[i]->GetBytesUsed();
+	return bytes;
+}
+
+RenderThread::RenderThread(SDL_Window* window, SDL_GLContext context, bool threaded)
+	: m_Window(window), m_Context(context), m_Submitted(0), m_Completed(0), m_Threaded(threaded), m_Stopping(false)
+{
+	if (m_Threaded) {
+		// A context can only be current on one thread at a time
+		SDL_GL_MakeCurrent(m_Window, nullptr);
+		m_Thread = std::thread(&RenderThread::ThreadLoop, this);
+	}
+}
+
+RenderThread::~RenderThread()
+{
+	if (!m_Threaded)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	SDL_GL_MakeCurrent(m_Window, m_Context);
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+	GLInstallDebugOutput(false);
+#endif
+}
+
+void RenderThread::ThreadLoop()
+{
+	SDL_GL_MakeCurrent(m_Window, m_Context);
+	Profiler::SetThreadName("Render");
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+	// Report this thread's call sites with debug messages
+	GLInstallDebugOutput(false);
+#endif
+
+	while (true) {
+		const RenderFrame* frame;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return m_Stopping || m_Submitted != m_Completed; });
+			// Frames submitted before stopping are still drawn
+			if (m_Submitted == m_Completed)
+				break;
+			frame = &m_Frames[m_Completed % FramesInFlight];
+		}
+
+		ExecuteFrame(*frame);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Completed++;
+		}
+		m_Condition.notify_all();
+	}
+
+	SDL_GL_MakeCurrent(m_Window, nullptr);
+}
+
+void RenderThread::ExecuteFrame(const RenderFrame& frame)
+{
+	GL_ERROR_SCOPE("frame");
+	Profiler::BeginFrame();
+
+	{
+		PROFILE_SCOPE("Render");
+		PROFILE_GPU_SCOPE("Render");
+		frame.Execute(m_Renderer);
+	}
+
+	{
+		PROFILE_SCOPE("Swap");
+		SDL_GL_SwapWindow(m_Window);
+	}
+
+	Profiler::EndFrame();
+}
+
+RenderFrame& RenderThread::BeginFrame()
+{
+	if (m_Threaded) {
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		if (m_Submitted - m_Completed >= FramesInFlight) {
+			PROFILE_SCOPE("Wait for render thread");
+			Timer timer;
+			m_Condition.wait(lock, [this]() { return m_Submitted - m_Completed < FramesInFlight; });
+			m_Stats.Stalls++;
+			m_Stats.StallMilliseconds += timer.ElapsedMilliseconds();
+		}
+	}
+
+	RenderFrame& frame = m_Frames[m_Submitted % FramesInFlight];
+	frame.Reset();
+	return frame;
+}
+
+void RenderThread::Submit()
+{
+	m_Stats.Frames++;
+	if (!m_Threaded) {
+		ExecuteFrame(m_Frames[m_Submitted % FramesInFlight]);
+		m_Submitted++;
+		m_Completed++;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Submitted++;
+	}
+	m_Condition.notify_all();
+}
+
+void RenderThread::Flush()
+{
+	if (!m_Threaded)
+		return;
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return m_Submitted == m_Completed; });
+}
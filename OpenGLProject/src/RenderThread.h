@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <SDL.h>
+
+#include "CommandBuffer.h"
+#include "Renderer.h"
+
+// The command buffers of one frame, replayed in index order. Buffer 0 always
+// exists; to record on several threads set the count first and give every
+// thread its own index.
+class RenderFrame {
+private:
+	std::vector<std::unique_ptr<CommandBuffer>> m_CommandBuffers;
+	unsigned int m_Count;
+public:
+	RenderFrame();
+
+	// Not thread safe, buffers are only created here
+	void SetCommandBufferCount(unsigned int count);
+	CommandBuffer& GetCommandBuffer(unsigned int index = 0);
+	inline unsigned int GetCommandBufferCount() const { return m_Count; }
+
+	void Execute(const Renderer& renderer) const;
+	// Back to one empty buffer; memory is kept for the next frame
+	void Reset();
+
+	unsigned int GetCommandCount() const;
+	size_t GetBytesUsed() const;
+};
+
+// Owns the GL context on a thread of its own. The caller records frame N + 1
+// while frame N is replayed and swapped there, which takes simulation and
+// recording off the driver and SwapWindow critical path:
+//
+//   RenderFrame& frame = renderThread.BeginFrame();  // waits for a free frame
+//   frame.GetCommandBuffer().Draw(vao, ibo, shader);
+//   renderThread.Submit();                           // returns right away
+//
+// The context moves to the render thread in the constructor and back to the
+// constructing thread in the destructor, so GL objects are created before
+// and destroyed after its lifetime. Events stay on the caller, which SDL
+// requires to be the main thread. Profiler frames are those of the render
+// thread.
+class RenderThread {
+public:
+	static const unsigned int FramesInFlight = 2;
+
+	struct Stats
+	{
+		unsigned long long Frames = 0;
+		unsigned int Stalls = 0;
+		double StallMilliseconds = 0.0;
+	};
+private:
+	SDL_Window* m_Window;
+	SDL_GLContext m_Context;
+	Renderer m_Renderer;
+	RenderFrame m_Frames[FramesInFlight];
+
+	std::thread m_Thread;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	unsigned long long m_Submitted;
+	unsigned long long m_Completed;
+	bool m_Threaded;
+	bool m_Stopping;
+
+	Stats m_Stats;
+
+	void ThreadLoop();
+	void ExecuteFrame(const RenderFrame& frame);
+public:
+	// threaded false replays every frame on the calling thread in Submit()
+	RenderThread(SDL_Window* window, SDL_GLContext context, bool threaded = true);
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	// Blocks while FramesInFlight frames are still waiting for the render thread
+	RenderFrame& BeginFrame();
+	void Submit();
+	// Returns once every submitted frame has been swapped
+	void Flush();
+
+	inline bool IsThreaded() const { return m_Threaded; }
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+};
@@ -1,16 +1,195 @@
 #include <iostream>
 
 #include "Renderer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Mesh.h"
+
+thread_local GLCallSite g_GLCallSites[GLCallSiteHistory];
+thread_local unsigned int g_GLCallSiteIndex = 0;
+std::atomic<bool> g_GLCheckEveryCall(false);
+std::atomic<bool> g_GLDebugOutputError(false);
+
+static unsigned int DefaultGetError() {
+	return glGetError();
+}
+
+static unsigned int (*s_GetError)() = DefaultGetError;
+
+void GLSetErrorSource(unsigned int (*getError)()) {
+	s_GetError = getError ? getError : DefaultGetError;
+}
 
 void GLClearError() {
-	while (glGetError());
+	while (s_GetError());
 }
 
 bool GLLogCall(const char* function, const char* file, int line) {
-	while (GLenum error = glGetError()) {
+	while (GLenum error = s_GetError()) {
 		std::cout << "OpenGL Error (" << error << "): " << function <<
 			" " << file << ":" << line << std::endl;
+		// Found the failing call site, deferred checking can resume
+		g_GLCheckEveryCall.store(false, std::memory_order_relaxed);
 		return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+bool GLTakeDebugOutputError(const char* function, const char* file, int line) {
+	if (!g_GLDebugOutputError.exchange(false, std::memory_order_relaxed))
+		return true;
+	std::cout << "  Raised at GL call: " << function << " " << file << ":" << line << std::endl;
+	return false;
+}
+
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEFERRED
+static void PrintRecentCallSites(const GLCallSite* sites, unsigned int index) {
+	unsigned int count = index < GLCallSiteHistory ? index : GLCallSiteHistory;
+	std::cout << "  Most recent GL calls:" << std::endl;
+	for (unsigned int i = 1; i <= count; i++) {
+		const GLCallSite& site = sites[(index - i) & (GLCallSiteHistory - 1)];
+		std::cout << "    " << site.function << " " << site.file << ":" << site.line << std::endl;
+	}
+}
+#endif
+
+bool GLCheckErrors(const char* scope) {
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEFERRED
+	bool ok = true;
+	while (GLenum error = s_GetError()) {
+		std::cout << "OpenGL Error (" << error << ") in " << scope << std::endl;
+		ok = false;
+	}
+
+	if (!ok) {
+		PrintRecentCallSites(g_GLCallSites, g_GLCallSiteIndex);
+		std::cout << "  Checking every GL call until the failing one is found" << std::endl;
+		g_GLCheckEveryCall.store(true, std::memory_order_relaxed);
+	}
+	return ok;
+#else
+	(void)scope;
+	return true;
+#endif
+}
+
+static const char* DebugSourceName(GLenum source) {
+	switch (source) {
+	case GL_DEBUG_SOURCE_API:             return "API";
+	case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "Window System";
+	case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+	case GL_DEBUG_SOURCE_THIRD_PARTY:     return "Third Party";
+	case GL_DEBUG_SOURCE_APPLICATION:     return "Application";
+	}
+	return "Other";
+}
+
+static const char* DebugSeverityName(GLenum severity) {
+	switch (severity) {
+	case GL_DEBUG_SEVERITY_HIGH:   return "high";
+	case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+	case GL_DEBUG_SEVERITY_LOW:    return "low";
+	}
+	return "notification";
+}
+
+struct DebugOutputHistory
+{
+	const GLCallSite* sites;
+	const unsigned int* index;
+};
+
+static DebugOutputHistory s_DebugOutputHistory;
+
+static void GLAPIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei, const GLchar* message, const void* userParam) {
+	if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+		return;
+
+	std::cout << "OpenGL " << DebugSourceName(source) << " (" << DebugSeverityName(severity) << ", " << id << "): "
+		<< message << std::endl;
+
+	// userParam is the call site history of the thread that owns the context.
+	// With asynchronous output the report may arrive a few calls late.
+	const DebugOutputHistory* history = (const DebugOutputHistory*)userParam;
+	const GLCallSite& last = history->sites[(*history->index - 1) & (GLCallSiteHistory - 1)];
+	if (last.function)
+		std::cout << "  Last GL call: " << last.function << " " << last.file << ":" << last.line << std::endl;
+
+	// Breaking here would stop a driver thread; the GL thread raises it instead
+	if (type == GL_DEBUG_TYPE_ERROR && severity == GL_DEBUG_SEVERITY_HIGH)
+		g_GLDebugOutputError.store(true, std::memory_order_relaxed);
+}
+
+bool GLInstallDebugOutput(bool synchronous) {
+	if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+		return false;
+
+	glEnable(GL_DEBUG_OUTPUT);
+	if (synchronous)
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	else
+		glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	// The callback may run on a driver thread, so hand it this thread's history
+	s_DebugOutputHistory.sites = g_GLCallSites;
+	s_DebugOutputHistory.index = &g_GLCallSiteIndex;
+	glDebugMessageCallback(DebugMessageCallback, &s_DebugOutputHistory);
+	return true;
+}
+
+Renderer::Stats Renderer::s_Stats;
+
+void Renderer::Clear() const {
+	GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+}
+
+void Renderer::Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader) const {
+	shader.Bind();
+	vao.Bind();
+	ibo.Bind();
+	GLCall(glDrawElements(GL_TRIANGLES, ibo.GetCount(), ibo.GetType(), nullptr));
+
+	s_Stats.DrawCalls++;
+	s_Stats.Instances++;
+	s_Stats.Indices += ibo.GetCount();
+}
+
+void Renderer::Draw(const Mesh& mesh, const Shader& shader) const {
+	Draw(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader);
+}
+
+void Renderer::MultiDraw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader,
+	const int* counts, const void* const* offsets, const int* baseVertices, unsigned int drawCount) const {
+	if (drawCount == 0)
+		return;
+
+	shader.Bind();
+	vao.Bind();
+	ibo.Bind();
+	if (drawCount == 1) {
+		GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, counts[0], ibo.GetType(), (void*)offsets[0], baseVertices[0]));
+	}
+	else {
+		// GLEW declares the arrays without const
+		GLCall(glMultiDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei*)counts, ibo.GetType(), (void**)offsets, drawCount, (GLint*)baseVertices));
+	}
+
+	s_Stats.DrawCalls++;
+	s_Stats.Instances += drawCount;
+	for (unsigned int i = 0; i < drawCount; i++)
+		s_Stats.Indices += counts[i];
+}
+
+void Renderer::DrawInstanced(Mesh& mesh, const VertexBuffer& instances, const VertexBufferLayout& layout, unsigned int instanceCount, const Shader& shader) const {
+	mesh.AttachInstanceBuffer(instances, layout);
+
+	shader.Bind();
+	mesh.GetVertexArray().Bind();
+	const IndexBuffer& ibo = mesh.GetIndexBuffer();
+	GLCall(glDrawElementsInstanced(GL_TRIANGLES, ibo.GetCount(), ibo.GetType(), nullptr, instanceCount));
+
+	s_Stats.DrawCalls++;
+	s_Stats.Instances += instanceCount;
+	s_Stats.Indices += (unsigned long long)ibo.GetCount() * instanceCount;
+}
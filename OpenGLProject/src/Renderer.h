@@ -1,12 +1,162 @@
 #pragma once
 
+#include <atomic>
+
 #include <glew.h>
 
-// TODO: rewrite this assert. __debugbreak() is compiler intrinsic
-//       and should be rewritten in a non-platform specific way
-#define ASSERT(x) if (!(x)) __debugbreak();
-#define GLCall(x) GLClearError(); x; ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#if defined(_MSC_VER)
+	#define DEBUG_BREAK() __debugbreak()
+#elif defined(__GNUC__) || defined(__clang__)
+	#include <csignal>
+	#define DEBUG_BREAK() std::raise(SIGTRAP)
+#else
+	#include <cstdlib>
+	#define DEBUG_BREAK() std::abort()
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+// How GLCall checks for errors. Pick one by defining GL_ERROR_CHECK;
+// by default debug builds check every call and release builds check nothing.
+//
+//   GL_ERROR_CHECK_NONE          GLCall(x) is just x
+//   GL_ERROR_CHECK_CALL          glGetError before and after every call
+//   GL_ERROR_CHECK_DEFERRED      GLCall only records its call site; errors are
+//                                read once per GLCheckErrors()/GL_ERROR_SCOPE.
+//                                After a failed check every call is checked
+//                                until the first failing call site is found.
+//   GL_ERROR_CHECK_DEBUG_OUTPUT  errors come from the KHR_debug callback
+//                                installed by GLInstallDebugOutput(), which
+//                                reports the last recorded call site; the
+//                                next GLCall on the GL thread then asserts
+#define GL_ERROR_CHECK_NONE         0
+#define GL_ERROR_CHECK_CALL         1
+#define GL_ERROR_CHECK_DEFERRED     2
+#define GL_ERROR_CHECK_DEBUG_OUTPUT 3
+
+#ifndef GL_ERROR_CHECK
+	#ifdef NDEBUG
+		#define GL_ERROR_CHECK GL_ERROR_CHECK_NONE
+	#else
+		#define GL_ERROR_CHECK GL_ERROR_CHECK_CALL
+	#endif
+#endif
+
+struct GLCallSite
+{
+	const char* function;
+	const char* file;
+	int line;
+};
+
+// Most recent GLCall sites of the calling thread, newest at
+// g_GLCallSiteIndex - 1. Only written in the deferred and debug output modes.
+const unsigned int GLCallSiteHistory = 16;
+extern thread_local GLCallSite g_GLCallSites[GLCallSiteHistory];
+extern thread_local unsigned int g_GLCallSiteIndex;
+// Set by GLCheckErrors() on whichever thread finds an error; read by every
+// deferred GLCall
+extern std::atomic<bool> g_GLCheckEveryCall;
+// Set by the debug output callback, which may run on a driver thread
+extern std::atomic<bool> g_GLDebugOutputError;
+
+inline void GLRecordCallSite(const char* function, const char* file, int line)
+{
+	GLCallSite& site = g_GLCallSites[g_GLCallSiteIndex++ & (GLCallSiteHistory - 1)];
+	site.function = function;
+	site.file = file;
+	site.line = line;
+}
 
 void GLClearError();
 
-bool GLLogCall(const char* function, const char* file, int line);
\ No newline at end of file
+bool GLLogCall(const char* function, const char* file, int line);
+
+// Clears an error recorded by the debug output callback. Returns false if
+// there was one.
+bool GLTakeDebugOutputError(const char* function, const char* file, int line);
+
+// Reads all pending errors and reports them together with the recent call
+// sites. Returns false if there was an error.
+bool GLCheckErrors(const char* scope);
+
+// Requires GL 4.3 or KHR_debug. Returns false if neither is available.
+bool GLInstallDebugOutput(bool synchronous);
+
+// Replaces glGetError, e.g. with a stub when measuring checking overhead
+void GLSetErrorSource(unsigned int (*getError)());
+
+// Each mode's expansion is available by name so all of them can be compared
+// in one build; GLCall picks the configured one.
+#define GLCALL_NONE(x) x
+#define GLCALL_CALL(x) GLClearError(); x; ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#define GLCALL_DEFERRED(x) x; if (g_GLCheckEveryCall.load(std::memory_order_relaxed)) { ASSERT(GLLogCall(#x, __FILE__, __LINE__)) } else GLRecordCallSite(#x, __FILE__, __LINE__)
+#define GLCALL_DEBUG_OUTPUT(x) GLRecordCallSite(#x, __FILE__, __LINE__); x; \
+	if (g_GLDebugOutputError.load(std::memory_order_relaxed)) { ASSERT(GLTakeDebugOutputError(#x, __FILE__, __LINE__)) }
+
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_NONE
+	#define GLCall(x) GLCALL_NONE(x)
+#elif GL_ERROR_CHECK == GL_ERROR_CHECK_CALL
+	#define GLCall(x) GLCALL_CALL(x)
+#elif GL_ERROR_CHECK == GL_ERROR_CHECK_DEFERRED
+	#define GLCall(x) GLCALL_DEFERRED(x)
+#elif GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+	#define GLCall(x) GLCALL_DEBUG_OUTPUT(x)
+#else
+	#error Unknown GL_ERROR_CHECK mode
+#endif
+
+// Checks for errors when the scope ends. Compiles away unless the mode is
+// GL_ERROR_CHECK_DEFERRED.
+class GLErrorScope {
+private:
+	const char* m_Name;
+public:
+	GLErrorScope(const char* name)
+		: m_Name(name) {}
+	~GLErrorScope() { GLCheckErrors(m_Name); }
+};
+
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEFERRED
+	#define GL_ERROR_SCOPE_CONCAT2(a, b) a##b
+	#define GL_ERROR_SCOPE_CONCAT(a, b) GL_ERROR_SCOPE_CONCAT2(a, b)
+	#define GL_ERROR_SCOPE(name) GLErrorScope GL_ERROR_SCOPE_CONCAT(glErrorScope, __LINE__)(name)
+#else
+	#define GL_ERROR_SCOPE(name)
+#endif
+
+class VertexArray;
+class IndexBuffer;
+class VertexBuffer;
+class VertexBufferLayout;
+class Shader;
+class Mesh;
+
+class Renderer {
+public:
+	struct Stats
+	{
+		unsigned int DrawCalls = 0;
+		unsigned long long Instances = 0;
+		unsigned long long Indices = 0;
+	};
+private:
+	static Stats s_Stats;
+public:
+	void Clear() const;
+
+	// ibo becomes the element buffer of vao. GLState skips the bind when vao
+	// already has it, as a Mesh's vertex array does.
+	void Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader) const;
+	void Draw(const Mesh& mesh, const Shader& shader) const;
+	// drawCount index ranges of ibo in one glMultiDrawElementsBaseVertex;
+	// offsets are byte offsets into ibo, which is bound like in Draw()
+	void MultiDraw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader,
+		const int* counts, const void* const* offsets, const int* baseVertices, unsigned int drawCount) const;
+	// One draw call for instanceCount copies of mesh; instances supplies the
+	// per-instance attributes described by layout
+	void DrawInstanced(Mesh& mesh, const VertexBuffer& instances, const VertexBufferLayout& layout, unsigned int instanceCount, const Shader& shader) const;
+
+	static const Stats& GetStats() { return s_Stats; }
+	static void ResetStats() { s_Stats = Stats(); }
+};
@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include "Shader.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "UniformBuffer.h"
+#include "Timer.h"
+#include "FileUtils.h"
+#include "Profiler.h"
+
+// Header of a cached program binary. driverHash ties the binary to the
+// GL_VENDOR/GL_RENDERER/GL_VERSION it was produced by, so a driver update
+// does not even get to try a stale binary.
+struct ProgramBinaryHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t driverHash;
+	uint32_t format;
+	uint32_t length;
+};
+
+static const char s_BinaryMagic[4] = { 'G', 'L', 'P', 'B' };
+static const uint32_t s_BinaryVersion = 1;
+
+static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+	// FNV-1a
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static uint64_t HashString(const std::string& string, uint64_t hash) {
+	// Include the terminator so "ab" + "c" and "a" + "bc" hash differently
+	return HashBytes(string.c_str(), string.size() + 1, hash);
+}
+
+static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines) {
+	if (defines.empty())
+		return source;
+
+	std::string block;
+	for (const std::string& define : defines)
+		block += "#define " + define + "\n";
+
+	// #version has to stay the first statement
+	size_t insert = 0;
+	if (source.compare(0, 8, "#version") == 0) {
+		insert = source.find('\n');
+		insert = insert == std::string::npos ? source.size() : insert + 1;
+	}
+
+	std::string result;
+	result.reserve(source.size() + block.size());
+	result.append(source, 0, insert);
+	result.append(block);
+	result.append(source, insert, std::string::npos);
+	return result;
+}
+
+static unsigned int CompileShader(unsigned int type, const std::string& source) {
+	GLCall(unsigned int id = glCreateShader(type));
+	const char* src = source.c_str();
+	GLCall(glShaderSource(id, 1, &src, nullptr));
+	GLCall(glCompileShader(id));
+
+	int result;
+	GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+	if (result == GL_FALSE) {
+		int length;
+		GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+		std::string message(length, '\0');
+		GLCall(glGetShaderInfoLog(id, length, &length, &message[0]));
+
+		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
+		std::cout << message << std::endl;
+		GLCall(glDeleteShader(id));
+		return 0;
+	}
+
+	return id;
+}
+
+static bool CheckLinkStatus(unsigned int program, bool printLog) {
+	int result;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+	if (result == GL_FALSE && printLog) {
+		int length;
+		GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+		std::string message(length > 0 ? length : 1, '\0');
+		GLCall(glGetProgramInfoLog(program, (int)message.size(), &length, &message[0]));
+
+		std::cout << "Failed to link shader program!" << std::endl;
+		std::cout << message << std::endl;
+	}
+	return result != GL_FALSE;
+}
+
+static unsigned int CreateShaderProgram(const std::string& vertexShaderSource, const std::string& fragmentShaderSource, bool retrievable) {
+	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
+	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+	if (vs == 0 || fs == 0) {
+		GLCall(glDeleteShader(vs));
+		GLCall(glDeleteShader(fs));
+		return 0;
+	}
+
+	GLCall(unsigned int program = glCreateProgram());
+	if (retrievable) {
+		GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+	}
+
+	GLCall(glAttachShader(program, vs));
+	GLCall(glAttachShader(program, fs));
+	GLCall(glLinkProgram(program));
+
+	GLCall(glDetachShader(program, vs));
+	GLCall(glDetachShader(program, fs));
+	GLCall(glDeleteShader(vs));
+	GLCall(glDeleteShader(fs));
+
+	if (!CheckLinkStatus(program, true)) {
+		GLCall(glDeleteProgram(program));
+		return 0;
+	}
+
+	return program;
+}
+
+static unsigned int UniformTypeSize(unsigned int type) {
+	switch (type) {
+	case GL_FLOAT:             return 4;
+	case GL_FLOAT_VEC2:        return 8;
+	case GL_FLOAT_VEC3:        return 12;
+	case GL_FLOAT_VEC4:        return 16;
+	case GL_INT:               return 4;
+	case GL_INT_VEC2:          return 8;
+	case GL_INT_VEC3:          return 12;
+	case GL_INT_VEC4:          return 16;
+	case GL_UNSIGNED_INT:      return 4;
+	case GL_BOOL:              return 4;
+	case GL_FLOAT_MAT3:        return 36;
+	case GL_FLOAT_MAT4:        return 64;
+	case GL_SAMPLER_2D:        return 4;
+	case GL_SAMPLER_2D_ARRAY:  return 4;
+	case GL_SAMPLER_3D:        return 4;
+	case GL_SAMPLER_CUBE:      return 4;
+	}
+	// Not cached, always uploaded
+	return 0;
+}
+
+Shader::UniformStats Shader::s_UniformStats;
+
+Shader::Shader(unsigned int program, const std::string& name, uint64_t hash)
+	: m_RendererID(program), m_Name(name), m_Hash(hash)
+{
+	Reflect();
+}
+
+void Shader::Reflect()
+{
+	int count = 0, maxLength = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+
+	std::string buffer(maxLength > 0 ? maxLength : 1, '\0');
+	for (int i = 0; i < count; i++) {
+		// Members of uniform blocks have no location
+		unsigned int index = (unsigned int)i;
+		int blockIndex = -1;
+		GLCall(glGetActiveUniformsiv(m_RendererID, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex));
+		if (blockIndex != -1)
+			continue;
+
+		int length = 0, size = 0;
+		GLenum type = 0;
+		GLCall(glGetActiveUniform(m_RendererID, index, (int)buffer.size(), &length, &size, &type, &buffer[0]));
+		std::string name(buffer.c_str(), length);
+
+		ShaderUniform uniform;
+		GLCall(uniform.Location = glGetUniformLocation(m_RendererID, name.c_str()));
+		uniform.Type = type;
+		uniform.Count = size;
+		uniform.Offset = (unsigned int)m_UniformValues.size();
+		uniform.Size = UniformTypeSize(type) * size;
+		uniform.Valid = false;
+		m_UniformValues.resize(m_UniformValues.size() + uniform.Size);
+
+		// Arrays are reported as "name[0]"; make them reachable by "name" too
+		size_t bracket = name.find('[');
+		if (bracket != std::string::npos)
+			m_Uniforms[name.substr(0, bracket)] = uniform;
+		m_Uniforms[name] = uniform;
+	}
+
+	count = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
+	buffer.assign(maxLength > 0 ? maxLength : 1, '\0');
+	for (int i = 0; i < count; i++) {
+		int length = 0;
+		GLCall(glGetActiveUniformBlockName(m_RendererID, i, (int)buffer.size(), &length, &buffer[0]));
+		m_UniformBlocks[std::string(buffer.c_str(), length)] = (unsigned int)i;
+	}
+}
+
+int Shader::GetUniformLocation(const std::string& name) const
+{
+	auto it = m_Uniforms.find(name);
+	return it != m_Uniforms.end() ? it->second.Location : -1;
+}
+
+bool Shader::HasUniformBlock(const std::string& name) const
+{
+	return m_UniformBlocks.find(name) != m_UniformBlocks.end();
+}
+
+bool Shader::BindUniformBlock(const std::string& name, unsigned int binding)
+{
+	auto it = m_UniformBlocks.find(name);
+	if (it == m_UniformBlocks.end())
+		return false;
+
+	GLCall(glUniformBlockBinding(m_RendererID, it->second, binding));
+	return true;
+}
+
+// Returns the location to upload to, or -1 if the upload can be skipped.
+// Binds the program, since glUniform* writes to the program in use.
+int Shader::PrepareUpload(const std::string& name, const void* value, unsigned int size)
+{
+	auto it = m_Uniforms.find(name);
+	if (it == m_Uniforms.end())
+		return -1;
+
+	ShaderUniform& uniform = it->second;
+	if (uniform.Size != 0) {
+		size = size < uniform.Size ? size : uniform.Size;
+		unsigned char* cached = &m_UniformValues[uniform.Offset];
+		if (uniform.Valid && memcmp(cached, value, size) == 0) {
+			s_UniformStats.Skipped++;
+			return -1;
+		}
+		memcpy(cached, value, size);
+		// A partial array upload leaves the rest of the cache stale
+		uniform.Valid = size == uniform.Size;
+	}
+
+	Bind();
+	s_UniformStats.Uploads++;
+	return uniform.Location;
+}
+
+void Shader::SetUniform1i(const std::string& name, int value)
+{
+	int location = PrepareUpload(name, &value, sizeof(value));
+	if (location != -1) {
+		GLCall(glUniform1i(location, value));
+	}
+}
+
+void Shader::SetUniform1iv(const std::string& name, int count, const int* values)
+{
+	int location = PrepareUpload(name, values, sizeof(int) * count);
+	if (location != -1) {
+		GLCall(glUniform1iv(location, count, values));
+	}
+}
+
+void Shader::SetUniform1f(const std::string& name, float value)
+{
+	int location = PrepareUpload(name, &value, sizeof(value));
+	if (location != -1) {
+		GLCall(glUniform1f(location, value));
+	}
+}
+
+void Shader::SetUniform2f(const std::string& name, float v0, float v1)
+{
+	const float values[2] = { v0, v1 };
+	int location = PrepareUpload(name, values, sizeof(values));
+	if (location != -1) {
+		GLCall(glUniform2f(location, v0, v1));
+	}
+}
+
+void Shader::SetUniform3f(const std::string& name, float v0, float v1, float v2)
+{
+	const float values[3] = { v0, v1, v2 };
+	int location = PrepareUpload(name, values, sizeof(values));
+	if (location != -1) {
+		GLCall(glUniform3f(location, v0, v1, v2));
+	}
+}
+
+void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+{
+	const float values[4] = { v0, v1, v2, v3 };
+	int location = PrepareUpload(name, values, sizeof(values));
+	if (location != -1) {
+		GLCall(glUniform4f(location, v0, v1, v2, v3));
+	}
+}
+
+void Shader::SetUniformMat4(const std::string& name, const float* matrix)
+{
+	int location = PrepareUpload(name, matrix, sizeof(float) * 16);
+	if (location != -1) {
+		GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, matrix));
+	}
+}
+
+Shader::~Shader()
+{
+	GLCall(glDeleteProgram(m_RendererID));
+	GLState::OnProgramDeleted(m_RendererID);
+}
+
+void Shader::Bind() const
+{
+	GLState::UseProgram(m_RendererID);
+}
+
+void Shader::Unbind() const
+{
+	GLState::UseProgram(0);
+}
+
+ShaderLibrary::ShaderLibrary(const std::string& cacheDirectory)
+	: m_CacheDirectory(cacheDirectory), m_BinaryCacheSupported(false), m_DriverHash(0)
+{
+	m_BlockBindings["Frame"] = UniformBlock::Frame;
+	m_BlockBindings["Material"] = UniformBlock::Material;
+
+	if (!m_CacheDirectory.empty() && (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) {
+		int formats = 0;
+		GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+		m_BinaryCacheSupported = formats > 0;
+		if (m_BinaryCacheSupported) {
+			m_BinaryFormats.resize(formats);
+			GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, m_BinaryFormats.data()));
+		}
+	}
+
+	if (m_BinaryCacheSupported) {
+		const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+		uint64_t hash = HashBytes(nullptr, 0);
+		for (GLenum name : strings) {
+			GLCall(const char* value = (const char*)glGetString(name));
+			hash = HashString(value ? value : "", hash);
+		}
+		m_DriverHash = hash;
+
+		std::error_code error;
+		std::filesystem::create_directories(m_CacheDirectory, error);
+		if (error) {
+			std::cout << "Could not create shader cache directory " << m_CacheDirectory << ": " << error.message() << std::endl;
+			m_BinaryCacheSupported = false;
+		}
+	}
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+}
+
+void ShaderLibrary::SetUniformBlockBinding(const std::string& block, unsigned int binding)
+{
+	m_BlockBindings[block] = binding;
+}
+
+std::string ShaderLibrary::GetCachePath(uint64_t hash) const
+{
+	std::ostringstream path;
+	path << m_CacheDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+	return path.str();
+}
+
+unsigned int ShaderLibrary::LoadBinary(uint64_t hash)
+{
+	std::string contents;
+	if (!FileUtils::ReadFile(GetCachePath(hash), contents) || contents.size() < sizeof(ProgramBinaryHeader))
+		return 0;
+
+	ProgramBinaryHeader header;
+	memcpy(&header, contents.data(), sizeof(header));
+	if (memcmp(header.magic, s_BinaryMagic, sizeof(s_BinaryMagic)) != 0 || header.version != s_BinaryVersion ||
+		header.driverHash != m_DriverHash || header.length != contents.size() - sizeof(header))
+		return 0;
+	if (std::find(m_BinaryFormats.begin(), m_BinaryFormats.end(), (int)header.format) == m_BinaryFormats.end())
+		return 0;
+
+	GLCall(unsigned int program = glCreateProgram());
+	// With a supported format an incompatible binary only fails to link
+	GLCall(glProgramBinary(program, header.format, contents.data() + sizeof(header), header.length));
+	if (!CheckLinkStatus(program, false)) {
+		GLCall(glDeleteProgram(program));
+		return 0;
+	}
+
+	return program;
+}
+
+void ShaderLibrary::StoreBinary(uint64_t hash, unsigned int program)
+{
+	int length = 0;
+	GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (length <= 0)
+		return;
+
+	std::string contents(sizeof(ProgramBinaryHeader) + length, '\0');
+	GLenum format = 0;
+	GLCall(glGetProgramBinary(program, length, &length, &format, &contents[sizeof(ProgramBinaryHeader)]));
+
+	ProgramBinaryHeader header;
+	memcpy(header.magic, s_BinaryMagic, sizeof(s_BinaryMagic));
+	header.version = s_BinaryVersion;
+	header.driverHash = m_DriverHash;
+	header.format = format;
+	header.length = (uint32_t)length;
+	memcpy(&contents[0], &header, sizeof(header));
+	contents.resize(sizeof(header) + length);
+
+	// Write to a temporary file first so a crash never leaves a truncated binary
+	std::string path = GetCachePath(hash);
+	std::string temporaryPath = path + ".tmp";
+	{
+		std::ofstream stream(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		stream.write(contents.data(), contents.size());
+		if (!stream)
+			return;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error)
+		std::cout << "Could not write shader cache " << path << ": " << error.message() << std::endl;
+}
+
+std::shared_ptr<Shader> ShaderLibrary::Load(const std::string& vertexPath, const std::string& fragmentPath,
+	const std::vector<std::string>& defines)
+{
+	PROFILE_FUNCTION();
+	Timer timer;
+
+	std::string vertexSource, fragmentSource;
+	if (!FileUtils::ReadFile(vertexPath, vertexSource)) {
+		std::cout << "Could not read shader " << vertexPath << std::endl;
+		return nullptr;
+	}
+	if (!FileUtils::ReadFile(fragmentPath, fragmentSource)) {
+		std::cout << "Could not read shader " << fragmentPath << std::endl;
+		return nullptr;
+	}
+
+	uint64_t hash = HashString(vertexSource, HashBytes(nullptr, 0));
+	hash = HashString(fragmentSource, hash);
+	for (const std::string& define : defines)
+		hash = HashString(define, hash);
+
+	auto it = m_Shaders.find(hash);
+	if (it != m_Shaders.end())
+		return it->second;
+
+	std::string name = vertexPath;
+	for (const std::string& define : defines)
+		name += " [" + define + "]";
+
+	bool fromCache = false;
+	unsigned int program = 0;
+	if (m_BinaryCacheSupported) {
+		program = LoadBinary(hash);
+		fromCache = program != 0;
+	}
+
+	if (program == 0) {
+		program = CreateShaderProgram(InjectDefines(vertexSource, defines), InjectDefines(fragmentSource, defines), m_BinaryCacheSupported);
+		if (program == 0)
+			return nullptr;
+
+		if (m_BinaryCacheSupported)
+			StoreBinary(hash, program);
+	}
+
+	std::shared_ptr<Shader> shader = std::make_shared<Shader>(program, name, hash);
+	for (const auto& binding : m_BlockBindings)
+		shader->BindUniformBlock(binding.first, binding.second);
+
+	m_Shaders[hash] = shader;
+	m_Timings.push_back({ name, timer.ElapsedMilliseconds(), fromCache });
+	return shader;
+}
+
+void ShaderLibrary::PrintLoadTimings() const
+{
+	double cold = 0.0, warm = 0.0;
+	for (const LoadTiming& timing : m_Timings) {
+		std::cout << (timing.FromBinaryCache ? "  warm " : "  cold ") << std::fixed << std::setprecision(3)
+			<< std::setw(9) << timing.Milliseconds << " ms  " << timing.Name << std::endl;
+		(timing.FromBinaryCache ? warm : cold) += timing.Milliseconds;
+	}
+	std::cout << "Shaders: " << cold << " ms compiled from source, " << warm << " ms loaded from binary cache" << std::endl;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ShaderUniform
+{
+	int Location;
+	unsigned int Type;
+	int Count;
+	// Last uploaded value in Shader's value cache; Size 0 means never cached
+	unsigned int Offset;
+	unsigned int Size;
+	bool Valid;
+};
+
+// A linked program. Its active uniforms and uniform blocks are reflected once
+// at construction; the typed setters look uniforms up in that table and skip
+// the upload when the value is the one the program already holds.
+class Shader {
+public:
+	struct UniformStats
+	{
+		unsigned int Uploads = 0;
+		unsigned int Skipped = 0;
+	};
+private:
+	unsigned int m_RendererID;
+	std::string m_Name;
+	uint64_t m_Hash;
+	std::unordered_map<std::string, ShaderUniform> m_Uniforms;
+	std::unordered_map<std::string, unsigned int> m_UniformBlocks;
+	std::vector<unsigned char> m_UniformValues;
+
+	static UniformStats s_UniformStats;
+
+	void Reflect();
+	int PrepareUpload(const std::string& name, const void* value, unsigned int size);
+public:
+	Shader(unsigned int program, const std::string& name, uint64_t hash);
+	~Shader();
+
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::string& GetName() const { return m_Name; }
+	inline uint64_t GetHash() const { return m_Hash; }
+
+	// -1 if the program has no active uniform with that name
+	int GetUniformLocation(const std::string& name) const;
+	bool HasUniformBlock(const std::string& name) const;
+	bool BindUniformBlock(const std::string& name, unsigned int binding);
+
+	void SetUniform1i(const std::string& name, int value);
+	void SetUniform1iv(const std::string& name, int count, const int* values);
+	void SetUniform1f(const std::string& name, float value);
+	void SetUniform2f(const std::string& name, float v0, float v1);
+	void SetUniform3f(const std::string& name, float v0, float v1, float v2);
+	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+	void SetUniformMat4(const std::string& name, const float* matrix);
+
+	static const UniformStats& GetUniformStats() { return s_UniformStats; }
+	static void ResetUniformStats() { s_UniformStats = UniformStats(); }
+};
+
+// Owns every shader program and keys them by a hash of their sources and
+// defines, so a variant is only built once. Linked programs are stored in
+// the cache directory when GL_ARB_get_program_binary is available and
+// loaded from there on the next start; a binary the driver rejects is
+// rebuilt from source and replaced.
+class ShaderLibrary {
+public:
+	struct LoadTiming
+	{
+		std::string Name;
+		double Milliseconds;
+		bool FromBinaryCache;
+	};
+private:
+	std::string m_CacheDirectory;
+	bool m_BinaryCacheSupported;
+	// GL_PROGRAM_BINARY_FORMATS; glProgramBinary raises GL_INVALID_ENUM for others
+	std::vector<int> m_BinaryFormats;
+	uint64_t m_DriverHash;
+	std::unordered_map<uint64_t, std::shared_ptr<Shader>> m_Shaders;
+	std::unordered_map<std::string, unsigned int> m_BlockBindings;
+	std::vector<LoadTiming> m_Timings;
+
+	std::string GetCachePath(uint64_t hash) const;
+	unsigned int LoadBinary(uint64_t hash);
+	void StoreBinary(uint64_t hash, unsigned int program);
+public:
+	// An empty cache directory disables the binary cache
+	ShaderLibrary(const std::string& cacheDirectory = "cache/shaders");
+	~ShaderLibrary();
+
+	// defines are injected after the #version line, e.g. "MAX_LIGHTS 4"
+	std::shared_ptr<Shader> Load(const std::string& vertexPath, const std::string& fragmentPath,
+		const std::vector<std::string>& defines = std::vector<std::string>());
+
+	// Programs declaring a uniform block with this name get it bound to binding.
+	// Frame and Material are registered by default (see UniformBuffer.h).
+	void SetUniformBlockBinding(const std::string& block, unsigned int binding);
+
+	inline bool IsBinaryCacheSupported() const { return m_BinaryCacheSupported; }
+	inline const std::vector<LoadTiming>& GetLoadTimings() const { return m_Timings; }
+	void PrintLoadTimings() const;
+};
@@ -0,0 +1,142 @@
+#include "StreamingBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Timer.h"
+#include "Profiler.h"
+
+StreamingBuffer::StreamingBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount, Mode mode)
+	: m_Target(target), m_RegionSize(regionSize), m_RegionCount(regionCount), m_Region(0), m_RegionOffset(0),
+	m_Mode(mode), m_PersistentPointer(nullptr), m_Mapped(false), m_Fences(regionCount, nullptr)
+{
+	ASSERT(regionCount > 0);
+
+	if (m_Mode == Mode::Persistent && !GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage)
+		m_Mode = Mode::Unsynchronized;
+
+	unsigned int size = regionSize * regionCount;
+	GLCall(glGenBuffers(1, &m_RendererID));
+	Bind();
+
+	if (m_Mode == Mode::Persistent) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glBufferStorage(m_Target, size, nullptr, flags));
+		GLCall(m_PersistentPointer = (unsigned char*)glMapBufferRange(m_Target, 0, size, flags));
+		ASSERT(m_PersistentPointer);
+	}
+	else {
+		GLCall(glBufferData(m_Target, size, nullptr, GL_STREAM_DRAW));
+	}
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+	for (GLsync fence : m_Fences) {
+		if (fence) {
+			GLCall(glDeleteSync(fence));
+		}
+	}
+
+	if (m_PersistentPointer || m_Mapped) {
+		Bind();
+		GLCall(glUnmapBuffer(m_Target));
+	}
+
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+	GLState::OnBufferDeleted(m_RendererID);
+}
+
+void StreamingBuffer::WaitForRegion(unsigned int region)
+{
+	GLsync fence = m_Fences[region];
+	if (!fence)
+		return;
+
+	// Poll first so the common, already signaled case costs no flush
+	GLCall(GLenum result = glClientWaitSync(fence, 0, 0));
+	if (result == GL_TIMEOUT_EXPIRED) {
+		PROFILE_SCOPE("StreamingBuffer stall");
+		Timer timer;
+		do {
+			GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+		} while (result == GL_TIMEOUT_EXPIRED);
+
+		m_Stats.Stalls++;
+		m_Stats.StallMilliseconds += timer.ElapsedMilliseconds();
+	}
+	ASSERT(result != GL_WAIT_FAILED);
+
+	GLCall(glDeleteSync(fence));
+	m_Fences[region] = nullptr;
+}
+
+void StreamingBuffer::BeginFrame()
+{
+	m_Region = (m_Region + 1) % m_RegionCount;
+	m_RegionOffset = 0;
+	m_Stats.FrameBytes = 0;
+
+	if (m_Mode == Mode::Orphaning) {
+		// Regions written since the last orphan are still in flight, but the
+		// driver keeps the old storage alive until the GPU is done with it
+		if (m_Region == 0) {
+			Bind();
+			GLCall(glBufferData(m_Target, m_RegionSize * m_RegionCount, nullptr, GL_STREAM_DRAW));
+		}
+		return;
+	}
+
+	WaitForRegion(m_Region);
+}
+
+void StreamingBuffer::EndFrame()
+{
+	ASSERT(!m_Mapped);
+
+	if (m_Mode == Mode::Orphaning)
+		return;
+
+	if (m_Fences[m_Region]) {
+		GLCall(glDeleteSync(m_Fences[m_Region]));
+	}
+	GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+void* StreamingBuffer::Map(unsigned int size, unsigned int& offset, unsigned int alignment)
+{
+	ASSERT(!m_Mapped);
+
+	unsigned int aligned = alignment > 1 ? (m_RegionOffset + alignment - 1) / alignment * alignment : m_RegionOffset;
+	if (aligned + size > m_RegionSize)
+		return nullptr;
+
+	offset = m_Region * m_RegionSize + aligned;
+	m_RegionOffset = aligned + size;
+	m_Stats.FrameBytes += size;
+	m_Stats.BytesStreamed += size;
+
+	if (m_Mode == Mode::Persistent)
+		return m_PersistentPointer + offset;
+
+	// The fence (or the orphaned storage) already guarantees the GPU is not
+	// reading this range, so the driver must not synchronize on its own
+	Bind();
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+	GLCall(void* pointer = glMapBufferRange(m_Target, offset, size, access));
+	m_Mapped = pointer != nullptr;
+	return pointer;
+}
+
+void StreamingBuffer::Unmap()
+{
+	if (!m_Mapped)
+		return;
+
+	Bind();
+	GLCall(glUnmapBuffer(m_Target));
+	m_Mapped = false;
+}
+
+void StreamingBuffer::Bind() const
+{
+	GLState::BindBuffer(m_Target, m_RendererID);
+}
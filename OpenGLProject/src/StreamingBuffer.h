@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include <glew.h>
+
+// A buffer for geometry that is regenerated every frame. The storage is split
+// into one region per frame in flight; Map() hands out write pointers into
+// the current region so vertices can be generated straight into GL memory.
+//
+// Each region is guarded by a fence placed in EndFrame(). BeginFrame() waits
+// on the fence of the region it is about to reuse, which only stalls when the
+// CPU is more than regionCount frames ahead of the GPU.
+//
+//   Persistent      GL 4.4 / ARB_buffer_storage, mapped once for its lifetime
+//   Unsynchronized  glMapBufferRange with GL_MAP_UNSYNCHRONIZED_BIT per Map()
+//   Orphaning       re-specifies the storage with glBufferData(nullptr) when
+//                   wrapping around instead of using fences
+class StreamingBuffer {
+public:
+	enum class Mode
+	{
+		Persistent,
+		Unsynchronized,
+		Orphaning
+	};
+
+	struct Stats
+	{
+		unsigned long long BytesStreamed = 0;
+		unsigned int FrameBytes = 0;
+		unsigned int Stalls = 0;
+		double StallMilliseconds = 0.0;
+	};
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Target;
+	unsigned int m_RegionSize;
+	unsigned int m_RegionCount;
+	unsigned int m_Region;
+	unsigned int m_RegionOffset;
+	Mode m_Mode;
+
+	unsigned char* m_PersistentPointer;
+	bool m_Mapped;
+	std::vector<GLsync> m_Fences;
+
+	Stats m_Stats;
+
+	void WaitForRegion(unsigned int region);
+public:
+	// Falls back from Persistent to Unsynchronized when buffer storage is missing
+	StreamingBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3, Mode mode = Mode::Persistent);
+	~StreamingBuffer();
+
+	StreamingBuffer(const StreamingBuffer&) = delete;
+	StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+	void BeginFrame();
+	void EndFrame();
+
+	// Returns a write pointer for size bytes and their offset in the buffer,
+	// or nullptr if the region is full. Every Map() needs an Unmap() before
+	// the data is drawn.
+	void* Map(unsigned int size, unsigned int& offset, unsigned int alignment = 16);
+	void Unmap();
+
+	void Bind() const;
+
+	inline Mode GetMode() const { return m_Mode; }
+	inline unsigned int GetRegionSize() const { return m_RegionSize; }
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+};
@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Texture.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "FileUtils.h"
+
+struct FormatInfo
+{
+	TextureFormat Format;
+	unsigned int InternalFormat;
+	unsigned int BaseFormat;
+	// Pixels per side of a block and bytes per block; RGBA8 is a 1x1 block
+	unsigned int BlockSize;
+	unsigned int BlockBytes;
+};
+
+static const FormatInfo s_Formats[] = {
+	{ TextureFormat::RGBA8, GL_RGBA8, GL_RGBA, 1, 4 },
+	{ TextureFormat::BC1, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_RGB, 4, 8 },
+	{ TextureFormat::BC1A, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_RGBA, 4, 8 },
+	{ TextureFormat::BC2, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, GL_RGBA, 4, 16 },
+	{ TextureFormat::BC3, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_RGBA, 4, 16 },
+	{ TextureFormat::BC4, GL_COMPRESSED_RED_RGTC1, GL_RED, 4, 8 },
+	{ TextureFormat::BC5, GL_COMPRESSED_RG_RGTC2, GL_RG, 4, 16 },
+	{ TextureFormat::BC7, GL_COMPRESSED_RGBA_BPTC_UNORM, GL_RGBA, 4, 16 }
+};
+static_assert(sizeof(s_Formats) / sizeof(s_Formats[0]) == (size_t)TextureFormat::BC7 + 1, "s_Formats is indexed by TextureFormat");
+
+static const FormatInfo& GetFormatInfo(TextureFormat format)
+{
+	return s_Formats[(int)format];
+}
+
+bool IsCompressed(TextureFormat format)
+{
+	return GetFormatInfo(format).BlockSize > 1;
+}
+
+size_t GetImageSize(TextureFormat format, unsigned int width, unsigned int height)
+{
+	const FormatInfo& info = GetFormatInfo(format);
+	size_t blocksWide = (width + info.BlockSize - 1) / info.BlockSize;
+	size_t blocksHigh = (height + info.BlockSize - 1) / info.BlockSize;
+	return blocksWide * blocksHigh * info.BlockBytes;
+}
+
+unsigned int GetMipLevelCount(unsigned int width, unsigned int height)
+{
+	unsigned int levels = 1;
+	for (unsigned int size = std::max(width, height); size > 1; size >>= 1)
+		levels++;
+	return levels;
+}
+
+bool TextureData::IsValid() const
+{
+	if ((size_t)Format >= sizeof(s_Formats) / sizeof(s_Formats[0]) || Width == 0 || Height == 0 ||
+		Levels.empty() || Levels.size() > GetMipLevelCount(Width, Height))
+		return false;
+
+	unsigned int width = Width, height = Height;
+	for (const Level& level : Levels) {
+		if (level.Width != width || level.Height != height || level.Size != GetImageSize(Format, width, height) ||
+			level.Offset > Data.size() || level.Size > Data.size() - level.Offset)
+			return false;
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+	return true;
+}
+
+void CreateTextureData(const Image& image, bool mipmaps, TextureData& data, unsigned int maxLevelCount)
+{
+	data.Format = TextureFormat::RGBA8;
+	data.Width = image.Width;
+	data.Height = image.Height;
+	unsigned int levelCount = mipmaps ? GetMipLevelCount(image.Width, image.Height) : 1;
+	if (maxLevelCount > 0)
+		levelCount = std::min(levelCount, maxLevelCount);
+
+	data.Levels.resize(levelCount);
+	size_t size = 0;
+	unsigned int width = image.Width, height = image.Height;
+	for (TextureData::Level& level : data.Levels) {
+		level = { width, height, size, (size_t)width * height * 4 };
+		size += level.Size;
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+	data.Data.resize(size);
+	memcpy(data.Data.data(), image.Pixels.data(), data.Levels[0].Size);
+
+	// 2x2 box filter; the last row or column of an odd sized level is
+	// averaged with itself
+	for (unsigned int i = 1; i < levelCount; i++) {
+		const TextureData::Level& source = data.Levels[i - 1];
+		const TextureData::Level& level = data.Levels[i];
+		const unsigned char* in = data.Data.data() + source.Offset;
+		unsigned char* out = data.Data.data() + level.Offset;
+		for (unsigned int y = 0; y < level.Height; y++) {
+			const unsigned char* row0 = in + (size_t)std::min(y * 2, source.Height - 1) * source.Width * 4;
+			const unsigned char* row1 = in + (size_t)std::min(y * 2 + 1, source.Height - 1) * source.Width * 4;
+			for (unsigned int x = 0; x < level.Width; x++) {
+				unsigned int x0 = std::min(x * 2, source.Width - 1) * 4;
+				unsigned int x1 = std::min(x * 2 + 1, source.Width - 1) * 4;
+				for (unsigned int channel = 0; channel < 4; channel++)
+					*out++ = (unsigned char)((row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel] + 2) / 4);
+			}
+		}
+	}
+}
+
+static const unsigned char s_KTXIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const uint32_t s_KTXEndianness = 0x04030201;
+static const size_t s_KTXHeaderSize = 64;
+
+struct KTXHeader
+{
+	uint32_t Endianness;
+	uint32_t Type;
+	uint32_t TypeSize;
+	uint32_t Format;
+	uint32_t InternalFormat;
+	uint32_t BaseInternalFormat;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Depth;
+	uint32_t ArrayElements;
+	uint32_t Faces;
+	uint32_t MipLevels;
+	uint32_t KeyValueBytes;
+};
+
+bool LoadKTX(const std::string& filepath, TextureData& data)
+{
+	std::string file;
+	if (!FileUtils::ReadFile(filepath, file) || file.size() < s_KTXHeaderSize || memcmp(file.data(), s_KTXIdentifier, sizeof(s_KTXIdentifier)) != 0) {
+		std::cout << "Could not read KTX " << filepath << std::endl;
+		return false;
+	}
+
+	KTXHeader header;
+	memcpy(&header, file.data() + sizeof(s_KTXIdentifier), sizeof(header));
+	if (header.Endianness != s_KTXEndianness) {
+		std::cout << "KTX " << filepath << " has the wrong byte order" << std::endl;
+		return false;
+	}
+
+	const FormatInfo* info = nullptr;
+	for (const FormatInfo& candidate : s_Formats) {
+		if (candidate.InternalFormat == header.InternalFormat)
+			info = &candidate;
+	}
+	// Uncompressed data also has to be in the layout of that format
+	bool layoutMatches = info && (IsCompressed(info->Format) ? header.Type == 0 : header.Type == GL_UNSIGNED_BYTE && header.Format == GL_RGBA);
+	if (!layoutMatches || header.Width == 0 || header.Height == 0 || header.Depth > 1 || header.ArrayElements > 0 || header.Faces != 1) {
+		std::cout << "Unsupported KTX " << filepath << ", only single 2D images in RGBA8 or BCn are read" << std::endl;
+		return false;
+	}
+
+	data.Format = info->Format;
+	data.Width = header.Width;
+	data.Height = header.Height;
+	unsigned int levelCount = std::max(1u, header.MipLevels);
+	if (levelCount > GetMipLevelCount(header.Width, header.Height)) {
+		std::cout << "KTX " << filepath << " has too many mip levels" << std::endl;
+		return false;
+	}
+
+	if (header.KeyValueBytes > file.size() - s_KTXHeaderSize) {
+		std::cout << "Truncated or malformed KTX " << filepath << std::endl;
+		return false;
+	}
+
+	// Every level is its size, its data and padding to 4 bytes
+	size_t position = s_KTXHeaderSize + header.KeyValueBytes;
+	data.Levels.resize(levelCount);
+	size_t size = 0;
+	unsigned int width = header.Width, height = header.Height;
+	for (TextureData::Level& level : data.Levels) {
+		level = { width, height, size, GetImageSize(data.Format, width, height) };
+		uint32_t imageSize = 0;
+		if (position + sizeof(imageSize) <= file.size())
+			memcpy(&imageSize, file.data() + position, sizeof(imageSize));
+		if (imageSize != level.Size || position + sizeof(imageSize) + imageSize > file.size()) {
+			std::cout << "Truncated or malformed KTX " << filepath << std::endl;
+			return false;
+		}
+		position += sizeof(imageSize) + (imageSize + 3) / 4 * 4;
+		size += level.Size;
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+
+	data.Data.resize(size);
+	position = s_KTXHeaderSize + header.KeyValueBytes;
+	for (const TextureData::Level& level : data.Levels) {
+		memcpy(data.Data.data() + level.Offset, file.data() + position + sizeof(uint32_t), level.Size);
+		position += sizeof(uint32_t) + (level.Size + 3) / 4 * 4;
+	}
+	return true;
+}
+
+bool WriteKTX(const std::string& filepath, const TextureData& data)
+{
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream) {
+		std::cout << "Could not write " << filepath << std::endl;
+		return false;
+	}
+
+	const FormatInfo& info = GetFormatInfo(data.Format);
+	bool compressed = IsCompressed(data.Format);
+	KTXHeader header = {};
+	header.Endianness = s_KTXEndianness;
+	header.Type = compressed ? 0 : GL_UNSIGNED_BYTE;
+	header.TypeSize = 1;
+	header.Format = compressed ? 0 : GL_RGBA;
+	header.InternalFormat = info.InternalFormat;
+	header.BaseInternalFormat = info.BaseFormat;
+	header.Width = data.Width;
+	header.Height = data.Height;
+	header.Faces = 1;
+	header.MipLevels = (uint32_t)data.Levels.size();
+
+	stream.write((const char*)s_KTXIdentifier, sizeof(s_KTXIdentifier));
+	stream.write((const char*)&header, sizeof(header));
+	const char padding[3] = {};
+	for (const TextureData::Level& level : data.Levels) {
+		uint32_t imageSize = (uint32_t)level.Size;
+		stream.write((const char*)&imageSize, sizeof(imageSize));
+		stream.write((const char*)data.GetLevelData((unsigned int)(&level - data.Levels.data())), level.Size);
+		stream.write(padding, (4 - level.Size % 4) % 4);
+	}
+	return (bool)stream;
+}
+
+Texture::Stats Texture::s_Stats;
+unsigned int Texture::s_TextureCount = 0;
+unsigned long long Texture::s_MemoryUsage = 0;
+
+Texture::Texture()
+	: m_RendererID(0), m_Width(0), m_Height(0), m_LevelCount(0), m_Format(TextureFormat::RGBA8), m_MemorySize(0), m_Status(Status::Pending)
+{
+}
+
+Texture::Texture(const Image& image, bool mipmaps)
+	: Texture()
+{
+	Allocate(image.Width, image.Height, TextureFormat::RGBA8, mipmaps ? GetMipLevelCount(image.Width, image.Height) : 1);
+	SetData(0, 0, 0, image.Width, image.Height, image.Pixels.data(), image.Pixels.size());
+	if (mipmaps)
+		GenerateMipmaps();
+	SetStatus(Status::Ready);
+}
+
+Texture::Texture(const TextureData& data)
+	: Texture()
+{
+	Allocate(data.Width, data.Height, data.Format, (unsigned int)data.Levels.size());
+	for (unsigned int level = 0; level < m_LevelCount; level++) {
+		const TextureData::Level& info = data.Levels[level];
+		SetData(level, 0, 0, info.Width, info.Height, data.GetLevelData(level), info.Size);
+	}
+	SetStatus(Status::Ready);
+}
+
+Texture::~Texture()
+{
+	if (!m_RendererID)
+		return;
+
+	GLCall(glDeleteTextures(1, &m_RendererID));
+	GLState::OnTextureDeleted(m_RendererID);
+	s_TextureCount--;
+	s_MemoryUsage -= m_MemorySize;
+}
+
+void Texture::Allocate(unsigned int width, unsigned int height, TextureFormat format, unsigned int levelCount)
+{
+	ASSERT(width > 0 && height > 0 && levelCount > 0 && levelCount <= GetMipLevelCount(width, height));
+
+	if (!m_RendererID) {
+		GLCall(glGenTextures(1, &m_RendererID));
+		s_TextureCount++;
+	}
+	s_MemoryUsage -= m_MemorySize;
+
+	m_Width = width;
+	m_Height = height;
+	m_Format = format;
+	m_LevelCount = levelCount;
+	m_MemorySize = 0;
+
+	const FormatInfo& info = GetFormatInfo(format);
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+	// A null pointer only means "no data" while no unpack buffer is bound
+	GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1));
+	for (unsigned int level = 0; level < levelCount; level++) {
+		size_t size = GetImageSize(format, width, height);
+		if (IsCompressed(format)) {
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, info.InternalFormat, width, height, 0, (GLsizei)size, nullptr));
+		}
+		else {
+			GLCall(glTexImage2D(GL_TEXTURE_2D, level, info.InternalFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		}
+		m_MemorySize += size;
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+	s_MemoryUsage += m_MemorySize;
+
+	SetFilter(true);
+	SetWrap(GL_CLAMP_TO_EDGE);
+}
+
+void Texture::SetData(unsigned int level, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void* data, size_t size)
+{
+	ASSERT(level < m_LevelCount);
+
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+	if (IsCompressed(m_Format)) {
+		GLCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, GetFormatInfo(m_Format).InternalFormat, (GLsizei)size, data));
+	}
+	else {
+		// RGBA8 rows are always a multiple of the default unpack alignment
+		GLCall(glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data));
+	}
+	s_Stats.Uploads++;
+	s_Stats.BytesUploaded += size;
+}
+
+void Texture::GenerateMipmaps()
+{
+	ASSERT(!IsCompressed(m_Format));
+
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+}
+
+void Texture::SetFilter(bool linear)
+{
+	GLenum minFilter = linear ? GL_LINEAR : GL_NEAREST;
+	if (m_LevelCount > 1)
+		minFilter = linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST));
+}
+
+void Texture::SetWrap(unsigned int wrap)
+{
+	GLState::BindTexture(GL_TEXTURE_2D, m_RendererID);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap));
+}
+
+void Texture::Bind(unsigned int slot) const
+{
+	GLState::BindTextureUnit(slot, GL_TEXTURE_2D, m_RendererID);
+}
+
+bool Texture::IsFormatSupported(TextureFormat format)
+{
+	switch (format) {
+	case TextureFormat::BC1:
+	case TextureFormat::BC1A:
+	case TextureFormat::BC2:
+	case TextureFormat::BC3:
+		return GLEW_EXT_texture_compression_s3tc;
+	case TextureFormat::BC7:
+		return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	default:
+		// RGBA8 and RGTC are core since GL 3.0
+		return true;
+	}
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Image.h"
+
+// BCn formats are uploaded as they are; the GPU decodes them while sampling
+enum class TextureFormat
+{
+	RGBA8,
+	// DXT1, 8 bytes per 4x4 block; BC1A treats one color as transparent
+	BC1,
+	BC1A,
+	// DXT3 and DXT5, 16 bytes per block
+	BC2,
+	BC3,
+	// RGTC, one and two channels, 8 and 16 bytes per block
+	BC4,
+	BC5,
+	// BPTC, 16 bytes per block, needs GL 4.2 or ARB_texture_compression_bptc
+	BC7
+};
+
+bool IsCompressed(TextureFormat format);
+// Bytes of a width x height image; compressed formats round up to whole blocks
+size_t GetImageSize(TextureFormat format, unsigned int width, unsigned int height);
+// Down to 1x1
+unsigned int GetMipLevelCount(unsigned int width, unsigned int height);
+
+// Every mip level of a texture in memory, largest first and tightly packed
+// into Data, rows bottom to top like Image
+struct TextureData
+{
+	struct Level
+	{
+		unsigned int Width;
+		unsigned int Height;
+		size_t Offset;
+		size_t Size;
+	};
+
+	TextureFormat Format = TextureFormat::RGBA8;
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	std::vector<Level> Levels;
+	std::vector<unsigned char> Data;
+
+	inline const unsigned char* GetLevelData(unsigned int level) const { return Data.data() + Levels[level].Offset; }
+
+	// Whether Texture can take this as it is: a known format, at least one
+	// and at most a full chain of levels, each of the size its format and
+	// dimensions give and inside Data
+	bool IsValid() const;
+};
+
+// Copies image into level 0 and, with mipmaps, box filters the rest of the
+// chain on the CPU so it can run on a worker thread. A non-zero
+// maxLevelCount stops the chain early.
+void CreateTextureData(const Image& image, bool mipmaps, TextureData& data, unsigned int maxLevelCount = 0);
+
+// KTX 1.1 with one 2D image, RGBA8 or one of the BCn formats above, in the
+// byte order of this machine
+bool LoadKTX(const std::string& filepath, TextureData& data);
+bool WriteKTX(const std::string& filepath, const TextureData& data);
+
+// 2D texture with optional mip levels. Textures made with the default
+// constructor have no GL object until Allocate(), so they can be handed out
+// on any thread and filled later on the GL thread (see TextureLoader).
+class Texture {
+public:
+	struct Stats
+	{
+		unsigned int Uploads = 0;
+		unsigned long long BytesUploaded = 0;
+	};
+
+	enum class Status
+	{
+		// Made with the default constructor and not filled yet
+		Pending,
+		Ready,
+		// Its data could not be loaded; it will never become ready
+		Failed
+	};
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_LevelCount;
+	TextureFormat m_Format;
+	size_t m_MemorySize;
+	std::atomic<Status> m_Status;
+
+	static Stats s_Stats;
+	static unsigned int s_TextureCount;
+	static unsigned long long s_MemoryUsage;
+public:
+	Texture();
+	// mipmaps generates the chain with glGenerateMipmap
+	Texture(const Image& image, bool mipmaps = true);
+	// Uploads every level of data
+	Texture(const TextureData& data);
+	~Texture();
+
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
+	// (Re)creates the storage of levelCount levels with undefined contents
+	void Allocate(unsigned int width, unsigned int height, TextureFormat format, unsigned int levelCount = 1);
+	// Writes a rectangle of one level; size is the bytes of data. For BCn
+	// the rectangle has to start on a block and end on one or at the edge of
+	// the level. With a pixel unpack buffer bound, data is an offset into it.
+	void SetData(unsigned int level, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const void* data, size_t size);
+	// Fills levels 1 and up from level 0; not for BCn formats
+	void GenerateMipmaps();
+
+	// Linear filtering blends between mip levels when there are any
+	void SetFilter(bool linear);
+	void SetWrap(unsigned int wrap);
+
+	void Bind(unsigned int slot = 0) const;
+
+	// Readable on any thread
+	inline Status GetStatus() const { return m_Status.load(std::memory_order_acquire); }
+	inline void SetStatus(Status status) { m_Status.store(status, std::memory_order_release); }
+	inline bool IsReady() const { return GetStatus() == Status::Ready; }
+	inline bool HasFailed() const { return GetStatus() == Status::Failed; }
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetLevelCount() const { return m_LevelCount; }
+	inline TextureFormat GetFormat() const { return m_Format; }
+	// Bytes of every level as allocated
+	inline size_t GetMemorySize() const { return m_MemorySize; }
+
+	static bool IsFormatSupported(TextureFormat format);
+
+	static const Stats& GetStats() { return s_Stats; }
+	static void ResetStats() { s_Stats = Stats(); }
+	// Of every Texture alive
+	static unsigned int GetTextureCount() { return s_TextureCount; }
+	static unsigned long long GetMemoryUsage() { return s_MemoryUsage; }
+};
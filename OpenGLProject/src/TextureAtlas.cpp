@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstring>
+
+#include "TextureAtlas.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Profiler.h"
+
+SkylinePacker::SkylinePacker(unsigned int width, unsigned int height)
+	: m_Width(width), m_Height(height), m_UsedArea(0)
+{
+	Reset();
+}
+
+void SkylinePacker::Reset()
+{
+	m_Skyline.assign(1, { 0, 0, m_Width });
+	m_UsedArea = 0;
+}
+
+unsigned int SkylinePacker::FitAt(size_t index, unsigned int width) const
+{
+	if (m_Skyline[index].X + width > m_Width)
+		return m_Height + 1;
+
+	// The segments always cover the whole width, so this stays in range
+	unsigned int y = 0;
+	unsigned int remaining = width;
+	for (size_t i = index; ; i++) {
+		y = std::max(y, m_Skyline[i].Y);
+		if (m_Skyline[i].Width >= remaining)
+			return y;
+		remaining -= m_Skyline[i].Width;
+	}
+}
+
+bool SkylinePacker::Pack(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y)
+{
+	size_t best = m_Skyline.size();
+	unsigned int bestY = m_Height + 1;
+	unsigned int bestWidth = 0;
+	for (size_t i = 0; i < m_Skyline.size(); i++) {
+		unsigned int top = FitAt(i, width);
+		if (top > m_Height || height > m_Height - top)
+			continue;
+		if (top < bestY || (top == bestY && m_Skyline[i].Width < bestWidth)) {
+			best = i;
+			bestY = top;
+			bestWidth = m_Skyline[i].Width;
+		}
+	}
+	if (best == m_Skyline.size())
+		return false;
+
+	x = m_Skyline[best].X;
+	y = bestY;
+	m_Skyline.insert(m_Skyline.begin() + best, { x, y + height, width });
+
+	// Cut the segments the new one now covers
+	for (size_t i = best + 1; i < m_Skyline.size();) {
+		unsigned int previousEnd = m_Skyline[i - 1].X + m_Skyline[i - 1].Width;
+		if (m_Skyline[i].X >= previousEnd)
+			break;
+		unsigned int overlap = previousEnd - m_Skyline[i].X;
+		if (m_Skyline[i].Width > overlap) {
+			m_Skyline[i].X += overlap;
+			m_Skyline[i].Width -= overlap;
+			break;
+		}
+		m_Skyline.erase(m_Skyline.begin() + i);
+	}
+
+	for (size_t i = 1; i < m_Skyline.size();) {
+		if (m_Skyline[i - 1].Y == m_Skyline[i].Y) {
+			m_Skyline[i - 1].Width += m_Skyline[i].Width;
+			m_Skyline.erase(m_Skyline.begin() + i);
+		}
+		else
+			i++;
+	}
+
+	m_UsedArea += (unsigned long long)width * height;
+	return true;
+}
+
+TextureAtlas::TextureAtlas(unsigned int pageSize, unsigned int padding, unsigned int mipLevels)
+	: m_PageSize(pageSize), m_Padding(padding), m_MipLevels(std::min(std::max(1u, mipLevels), GetMipLevelCount(pageSize, pageSize))),
+	m_ImageArea(0)
+{
+}
+
+unsigned int TextureAtlas::Add(const Image& image)
+{
+	return Add(Image(image));
+}
+
+unsigned int TextureAtlas::Add(Image&& image)
+{
+	unsigned int index = (unsigned int)m_Regions.size();
+	m_Regions.push_back({ 0, 0, 0, image.Width, image.Height, { 0.0f, 0.0f, 0.0f, 0.0f } });
+	m_Pending.emplace_back(index, std::move(image));
+	return index;
+}
+
+void TextureAtlas::Blit(Page& page, const Image& image, unsigned int x, unsigned int y)
+{
+	// (x, y) is the corner of the padded rectangle; the padding repeats the
+	// image's outermost pixels
+	int padding = (int)m_Padding;
+	int width = (int)image.Width, height = (int)image.Height;
+	for (int row = -padding; row < height + padding; row++) {
+		int sourceRow = std::min(std::max(row, 0), height - 1);
+		const unsigned char* source = image.Pixels.data() + (size_t)sourceRow * width * 4;
+		unsigned char* destination = page.Pixels.Pixels.data() + ((size_t)(y + padding + row) * m_PageSize + x) * 4;
+		for (int column = -padding; column < 0; column++, destination += 4)
+			memcpy(destination, source, 4);
+		memcpy(destination, source, (size_t)width * 4);
+		destination += (size_t)width * 4;
+		for (int column = 0; column < padding; column++, destination += 4)
+			memcpy(destination, source + (size_t)(width - 1) * 4, 4);
+	}
+}
+
+bool TextureAtlas::Build()
+{
+	PROFILE_FUNCTION();
+
+	// Tallest first leaves the flattest skylines behind
+	std::stable_sort(m_Pending.begin(), m_Pending.end(), [](const std::pair<unsigned int, Image>& a, const std::pair<unsigned int, Image>& b) {
+		return a.second.Height != b.second.Height ? a.second.Height > b.second.Height : a.second.Width > b.second.Width;
+	});
+
+	bool packedAll = true;
+	for (const std::pair<unsigned int, Image>& pending : m_Pending) {
+		const Image& image = pending.second;
+		unsigned int width = image.Width + m_Padding * 2, height = image.Height + m_Padding * 2;
+		if (image.Width == 0 || image.Height == 0 || width > m_PageSize || height > m_PageSize) {
+			packedAll = false;
+			continue;
+		}
+
+		unsigned int x = 0, y = 0;
+		size_t page = 0;
+		while (page < m_Pages.size() && !m_Pages[page].Packer.Pack(width, height, x, y))
+			page++;
+		if (page == m_Pages.size()) {
+			Page newPage = { Image(), SkylinePacker(m_PageSize, m_PageSize), nullptr, false };
+			newPage.Pixels.Width = newPage.Pixels.Height = m_PageSize;
+			newPage.Pixels.Pixels.assign((size_t)m_PageSize * m_PageSize * 4, 0);
+			m_Pages.push_back(std::move(newPage));
+			m_Pages.back().Packer.Pack(width, height, x, y);
+		}
+
+		Blit(m_Pages[page], image, x, y);
+		m_Pages[page].Dirty = true;
+		m_ImageArea += (unsigned long long)image.Width * image.Height;
+
+		Region& region = m_Regions[pending.first];
+		region.Page = (unsigned int)page;
+		region.X = x + m_Padding;
+		region.Y = y + m_Padding;
+		region.TexCoords[0] = (float)region.X / m_PageSize;
+		region.TexCoords[1] = (float)region.Y / m_PageSize;
+		region.TexCoords[2] = (float)(region.X + region.Width) / m_PageSize;
+		region.TexCoords[3] = (float)(region.Y + region.Height) / m_PageSize;
+	}
+	m_Pending.clear();
+
+	// Pages are uploaded whole; they change rarely and a page is one call per
+	// level. The mip levels are box filtered here rather than by
+	// glGenerateMipmap, whose filter is up to the driver.
+	TextureData data;
+	for (Page& page : m_Pages) {
+		if (!page.Dirty)
+			continue;
+		if (!page.PageTexture) {
+			page.PageTexture = std::make_unique<Texture>();
+			page.PageTexture->Allocate(m_PageSize, m_PageSize, TextureFormat::RGBA8, m_MipLevels);
+		}
+		CreateTextureData(page.Pixels, m_MipLevels > 1, data, m_MipLevels);
+		GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		for (unsigned int level = 0; level < data.Levels.size(); level++) {
+			const TextureData::Level& info = data.Levels[level];
+			page.PageTexture->SetData(level, 0, 0, info.Width, info.Height, data.GetLevelData(level), info.Size);
+		}
+		page.PageTexture->SetStatus(Texture::Status::Ready);
+		page.Dirty = false;
+	}
+	return packedAll;
+}
+
+double TextureAtlas::GetOccupancy() const
+{
+	if (m_Pages.empty())
+		return 0.0;
+	return (double)m_ImageArea / ((double)m_PageSize * m_PageSize * m_Pages.size());
+}
+
+size_t TextureAtlas::GetMemorySize() const
+{
+	size_t size = 0;
+	for (const Page& page : m_Pages) {
+		if (page.PageTexture)
+			size += page.PageTexture->GetMemorySize();
+	}
+	return size;
+}
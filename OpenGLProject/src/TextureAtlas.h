@@ -0,0 +1,100 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Image.h"
+#include "Texture.h"
+
+// Skyline bottom-left rectangle packer: the free space is kept as the
+// outline of what has been placed so far, and every rectangle goes where it
+// ends lowest, ties broken by the narrowest gap.
+class SkylinePacker {
+private:
+	struct Segment
+	{
+		unsigned int X;
+		unsigned int Y;
+		unsigned int Width;
+	};
+
+	unsigned int m_Width;
+	unsigned int m_Height;
+	std::vector<Segment> m_Skyline;
+	unsigned long long m_UsedArea;
+
+	// Top of the outline under [X, X + width) starting at segment index, or
+	// m_Height + 1 when it does not fit
+	unsigned int FitAt(size_t index, unsigned int width) const;
+public:
+	SkylinePacker(unsigned int width, unsigned int height);
+
+	void Reset();
+	// Returns false when the rectangle fits nowhere
+	bool Pack(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y);
+
+	// Area of the packed rectangles over the whole area
+	inline double GetOccupancy() const { return (double)m_UsedArea / ((double)m_Width * m_Height); }
+};
+
+// Packs many small RGBA8 images into a few large pages so quads with
+// different images can still share a BatchRenderer batch or a DrawQueue
+// material. Add() images, then Build() packs them tallest first and uploads
+// the pages; images added later go into the free space of existing pages
+// with the next Build().
+//
+// Every image gets padding pixels of its own edge around it so filtering,
+// and mip levels down to about log2(padding) + 1, do not bleed between
+// neighbours. Mip levels are box filtered on the CPU, so a page holds the
+// same texels on every driver.
+class TextureAtlas {
+public:
+	struct Region
+	{
+		unsigned int Page;
+		// In pixels, without the padding
+		unsigned int X, Y, Width, Height;
+		// { u0, v0, u1, v1 } as BatchRenderer::DrawQuad takes them
+		float TexCoords[4];
+	};
+private:
+	struct Page
+	{
+		Image Pixels;
+		SkylinePacker Packer;
+		std::unique_ptr<Texture> PageTexture;
+		bool Dirty;
+	};
+
+	unsigned int m_PageSize;
+	unsigned int m_Padding;
+	unsigned int m_MipLevels;
+	std::vector<Page> m_Pages;
+	std::vector<Region> m_Regions;
+	// Added since the last Build(), with the index of their region
+	std::vector<std::pair<unsigned int, Image>> m_Pending;
+	unsigned long long m_ImageArea;
+
+	void Blit(Page& page, const Image& image, unsigned int x, unsigned int y);
+public:
+	TextureAtlas(unsigned int pageSize = 2048, unsigned int padding = 4, unsigned int mipLevels = 3);
+
+	// Returns the index of the image's region, which Build() fills in. The
+	// image is copied; it has to fit on a page with its padding.
+	unsigned int Add(const Image& image);
+	unsigned int Add(Image&& image);
+	// Packs and uploads everything added so far; returns false if an image
+	// is larger than a page
+	bool Build();
+
+	inline const Region& GetRegion(unsigned int index) const { return m_Regions[index]; }
+	inline unsigned int GetRegionCount() const { return (unsigned int)m_Regions.size(); }
+	inline const Texture& GetPage(unsigned int page) const { return *m_Pages[page].PageTexture; }
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	inline unsigned int GetPageSize() const { return m_PageSize; }
+
+	// Image pixels, without padding, over the pixels of every page
+	double GetOccupancy() const;
+	// Of every page's texture, mip levels included
+	size_t GetMemorySize() const;
+};
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "TextureLoader.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+TextureLoader::TextureLoader(ThreadPool& pool, unsigned int budgetPerFrame)
+	: m_Pool(pool), m_Staging(GL_PIXEL_UNPACK_BUFFER, budgetPerFrame), m_Budget(budgetPerFrame),
+	m_Decoding(0), m_RequestedCount(0), m_Level(0), m_Row(0)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Idle.wait(lock, [this]() { return m_Decoding == 0; });
+
+	for (std::unique_ptr<Request>& request : m_Decoded)
+		request->Target->SetStatus(Texture::Status::Failed);
+	for (std::unique_ptr<Request>& request : m_Uploads)
+		request->Target->SetStatus(Texture::Status::Failed);
+}
+
+std::shared_ptr<Texture> TextureLoader::Load(const std::string& filepath)
+{
+	bool ktx = filepath.size() >= 4 && filepath.compare(filepath.size() - 4, 4, ".ktx") == 0;
+	return Submit([filepath, ktx](TextureData& data) {
+		if (ktx)
+			return LoadKTX(filepath, data);
+
+		Image image;
+		if (!LoadTGA(filepath, image))
+			return false;
+		CreateTextureData(image, true, data);
+		return true;
+	});
+}
+
+std::shared_ptr<Texture> TextureLoader::Load(DecodeFunction decode)
+{
+	return Submit(std::move(decode));
+}
+
+std::shared_ptr<Texture> TextureLoader::Submit(DecodeFunction decode)
+{
+	std::unique_ptr<Request> request = std::make_unique<Request>();
+	request->Target = std::make_shared<Texture>();
+	std::shared_ptr<Texture> texture = request->Target;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoding++;
+		m_RequestedCount++;
+	}
+
+	m_Pool.Submit([this, decode = std::move(decode), request = std::move(request)]() mutable {
+		// Checked here so a bad DecodeFunction fails its request instead of
+		// tripping Texture::Allocate's ASSERT on the GL thread
+		request->Decoded = decode(request->Data) && request->Data.IsValid() && Texture::IsFormatSupported(request->Data.Format);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoded.push_back(std::move(request));
+		m_Decoding--;
+		m_Idle.notify_all();
+	});
+	return texture;
+}
+
+bool TextureLoader::Upload(Request& request, unsigned int& frameBytes)
+{
+	const TextureData& data = request.Data;
+	Texture& texture = *request.Target;
+	if (texture.GetLevelCount() == 0)
+		texture.Allocate(data.Width, data.Height, data.Format, (unsigned int)data.Levels.size());
+
+	// Compressed levels can only be split between rows of 4x4 blocks
+	unsigned int rowHeight = IsCompressed(data.Format) ? 4 : 1;
+	for (; m_Level < data.Levels.size(); m_Level++, m_Row = 0) {
+		const TextureData::Level& level = data.Levels[m_Level];
+		const unsigned char* pixels = data.GetLevelData(m_Level);
+		unsigned int rowCount = (level.Height + rowHeight - 1) / rowHeight;
+		size_t rowBytes = level.Size / rowCount;
+
+		// A row larger than the budget would never fit into the staging ring
+		if (rowBytes > m_Budget) {
+			GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			texture.SetData(m_Level, 0, 0, level.Width, level.Height, pixels, level.Size);
+			m_Stats.BytesUploaded += level.Size;
+			continue;
+		}
+
+		while (m_Row < rowCount) {
+			unsigned int available = m_Budget - frameBytes;
+			unsigned int rows = std::min(rowCount - m_Row, (unsigned int)(available / rowBytes));
+			if (rows == 0)
+				return false;
+
+			// Rows are whole multiples of 4 bytes, so frameBytes stays in step
+			// with the staging buffer's own offset
+			unsigned int size = (unsigned int)(rows * rowBytes);
+			unsigned int offset = 0;
+			void* staging = m_Staging.Map(size, offset, 4);
+			if (!staging)
+				return false;
+			memcpy(staging, pixels + m_Row * rowBytes, size);
+			m_Staging.Unmap();
+
+			m_Staging.Bind();
+			unsigned int y = m_Row * rowHeight;
+			unsigned int height = std::min(rows * rowHeight, level.Height - y);
+			texture.SetData(m_Level, 0, y, level.Width, height, (const void*)(uintptr_t)offset, size);
+
+			m_Row += rows;
+			frameBytes += size;
+			m_Stats.BytesUploaded += size;
+		}
+	}
+	return true;
+}
+
+void TextureLoader::Update()
+{
+	PROFILE_FUNCTION();
+	Timer timer;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (std::unique_ptr<Request>& request : m_Decoded) {
+			if (request->Decoded) {
+				m_Uploads.push_back(std::move(request));
+			}
+			else {
+				request->Target->SetStatus(Texture::Status::Failed);
+				m_Stats.Failed++;
+			}
+		}
+		m_Decoded.clear();
+		m_Stats.Requested = m_RequestedCount;
+	}
+
+	if (!m_Uploads.empty()) {
+		m_Staging.BeginFrame();
+		unsigned int frameBytes = 0;
+		while (!m_Uploads.empty() && Upload(*m_Uploads.front(), frameBytes)) {
+			Request& request = *m_Uploads.front();
+			request.Target->SetStatus(Texture::Status::Ready);
+			double latency = request.Latency.ElapsedMilliseconds();
+			m_Stats.Completed++;
+			m_Stats.TotalLatencyMilliseconds += latency;
+			m_Stats.MaxLatencyMilliseconds = std::max(m_Stats.MaxLatencyMilliseconds, latency);
+
+			m_Uploads.pop_front();
+			m_Level = 0;
+			m_Row = 0;
+		}
+		m_Staging.EndFrame();
+		GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	double milliseconds = timer.ElapsedMilliseconds();
+	m_Stats.UpdateMilliseconds += milliseconds;
+	m_Stats.MaxUpdateMilliseconds = std::max(m_Stats.MaxUpdateMilliseconds, milliseconds);
+}
+
+unsigned int TextureLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Decoding + (unsigned int)m_Decoded.size() + (unsigned int)m_Uploads.size();
+}
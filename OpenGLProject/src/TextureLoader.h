@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+#include "StreamingBuffer.h"
+#include "Timer.h"
+
+class ThreadPool;
+
+// Loads textures without stalling the frame. Load() hands out an empty
+// Texture right away and has a worker read and decode the file; Update()
+// then streams the decoded levels into the texture through a ring of pixel
+// unpack buffers, at most budgetPerFrame bytes per call, so big textures are
+// spread over several frames. The texture IsReady() once its last row has
+// been handed to GL, and HasFailed() when the file could not be read or the
+// decoded data is not something Texture can hold.
+//
+// Load() may be called on any thread. Update() and the destructor need the
+// GL context: call Update() once per frame on the thread that has it, e.g.
+// through a CommandBuffer::Callback when rendering on the RenderThread.
+class TextureLoader {
+public:
+	// Fills data on a worker thread; returning false fails the load
+	typedef std::function<bool(TextureData&)> DecodeFunction;
+
+	struct Stats
+	{
+		unsigned int Requested = 0;
+		unsigned int Completed = 0;
+		unsigned int Failed = 0;
+		unsigned long long BytesUploaded = 0;
+		// From Load() until the texture is ready
+		double TotalLatencyMilliseconds = 0.0;
+		double MaxLatencyMilliseconds = 0.0;
+		// Time in Update(), i.e. what loading costs the GL thread
+		double UpdateMilliseconds = 0.0;
+		double MaxUpdateMilliseconds = 0.0;
+	};
+private:
+	struct Request
+	{
+		std::shared_ptr<Texture> Target;
+		TextureData Data;
+		bool Decoded = false;
+		Timer Latency;
+	};
+
+	ThreadPool& m_Pool;
+	StreamingBuffer m_Staging;
+	unsigned int m_Budget;
+
+	// Guarded by m_Mutex: requests workers have finished decoding
+	std::mutex m_Mutex;
+	std::condition_variable m_Idle;
+	std::vector<std::unique_ptr<Request>> m_Decoded;
+	unsigned int m_Decoding;
+	unsigned int m_RequestedCount;
+
+	// GL thread only: the front request is uploaded up to m_Level and m_Row
+	std::deque<std::unique_ptr<Request>> m_Uploads;
+	unsigned int m_Level;
+	unsigned int m_Row;
+
+	Stats m_Stats;
+
+	std::shared_ptr<Texture> Submit(DecodeFunction decode);
+	// Returns false when the frame's budget ran out first
+	bool Upload(Request& request, unsigned int& frameBytes);
+public:
+	explicit TextureLoader(ThreadPool& pool, unsigned int budgetPerFrame = 8 * 1024 * 1024);
+	// Waits for the decodes still running; unfinished textures fail
+	~TextureLoader();
+
+	TextureLoader(const TextureLoader&) = delete;
+	TextureLoader& operator=(const TextureLoader&) = delete;
+
+	// .ktx files are loaded as they are, anything else as a TGA with a mip
+	// chain built on the worker
+	std::shared_ptr<Texture> Load(const std::string& filepath);
+	std::shared_ptr<Texture> Load(DecodeFunction decode);
+
+	void Update();
+
+	// Textures still decoding or uploading; on the GL thread
+	unsigned int GetPendingCount();
+
+	// Requested and Failed are updated by Update()
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+};
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <atomic>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int workerCount)
+	: m_Stopping(false)
+{
+	for (unsigned int i = 0; i < workerCount; i++)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Tasks.empty())
+				return;
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+		}
+		task();
+	}
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Tasks.push_back(std::move(task));
+	}
+	m_Condition.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn)
+{
+	if (count == 0)
+		return;
+
+	size_t threads = m_Workers.size() + 1;
+	if (grainSize == 0)
+		grainSize = std::max<size_t>(1, count / (threads * 4));
+	size_t chunkCount = (count + grainSize - 1) / grainSize;
+	if (chunkCount == 1 || m_Workers.empty()) {
+		for (size_t begin = 0; begin < count; begin += grainSize)
+			fn(begin, std::min(begin + grainSize, count));
+		return;
+	}
+
+	// Helpers that only get to run after the last chunk was claimed find
+	// nothing left to do and never touch fn, which may be gone by then
+	struct Job
+	{
+		std::atomic<size_t> NextChunk{ 0 };
+		std::atomic<size_t> DoneChunks{ 0 };
+		std::mutex Mutex;
+		std::condition_variable Done;
+	};
+	std::shared_ptr<Job> job = std::make_shared<Job>();
+	const std::function<void(size_t, size_t)>* body = &fn;
+
+	auto run = [job, body, count, grainSize, chunkCount]() {
+		size_t chunk;
+		while ((chunk = job->NextChunk.fetch_add(1)) < chunkCount) {
+			size_t begin = chunk * grainSize;
+			(*body)(begin, std::min(begin + grainSize, count));
+			if (job->DoneChunks.fetch_add(1) + 1 == chunkCount) {
+				std::lock_guard<std::mutex> lock(job->Mutex);
+				job->Done.notify_all();
+			}
+		}
+	};
+
+	size_t helpers = std::min(m_Workers.size(), chunkCount - 1);
+	for (size_t i = 0; i < helpers; i++)
+		Enqueue(run);
+	run();
+
+	std::unique_lock<std::mutex> lock(job->Mutex);
+	job->Done.wait(lock, [&job, chunkCount]() { return job->DoneChunks.load() == chunkCount; });
+}
+
+unsigned int ThreadPool::GetDefaultWorkerCount()
+{
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+ThreadPool& ThreadPool::Get()
+{
+	static ThreadPool pool;
+	return pool;
+}
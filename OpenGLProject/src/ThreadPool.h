@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one task queue. ParallelFor splits a
+// range into chunks that the workers and the calling thread take turns on,
+// so it also makes progress (and cannot deadlock) when called from a worker.
+class ThreadPool {
+private:
+	std::vector<std::thread> m_Workers;
+	std::deque<std::function<void()>> m_Tasks;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stopping;
+
+	void WorkerLoop();
+	void Enqueue(std::function<void()> task);
+public:
+	// workerCount 0 runs everything on the calling thread
+	explicit ThreadPool(unsigned int workerCount = GetDefaultWorkerCount());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	template<typename F>
+	auto Submit(F&& task) -> std::future<decltype(task())>
+	{
+		using Result = decltype(task());
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		std::future<Result> result = packaged->get_future();
+		if (m_Workers.empty())
+			(*packaged)();
+		else
+			Enqueue([packaged]() { (*packaged)(); });
+		return result;
+	}
+
+	// Calls fn(begin, end) over [0, count) in chunks of grainSize and returns
+	// once every chunk has finished. grainSize 0 picks about four chunks per thread.
+	void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn);
+
+	inline unsigned int GetWorkerCount() const { return (unsigned int)m_Workers.size(); }
+
+	// Hardware threads minus the one calling into the pool
+	static unsigned int GetDefaultWorkerCount();
+	// Process wide pool, created on first use
+	static ThreadPool& Get();
+};
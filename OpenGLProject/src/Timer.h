@@ -0,0 +1,16 @@
+#pragma once
+
+#include <chrono>
+
+class Timer {
+private:
+	std::chrono::high_resolution_clock::time_point m_Start;
+public:
+	Timer() { Reset(); }
+
+	inline void Reset() { m_Start = std::chrono::high_resolution_clock::now(); }
+	inline double ElapsedMilliseconds() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_Start).count();
+	}
+};
@@ -0,0 +1,243 @@
+#include <cmath>
+#include <cstring>
+
+#include "TransformKernels.h"
+#include "TransformKernelsImpl.h"
+#include "ThreadPool.h"
+
+#if defined(_MSC_VER) && TRANSFORM_KERNELS_X86
+	#include <intrin.h>
+	#include <immintrin.h>
+#endif
+
+void TransformArrays::Resize(size_t count)
+{
+	std::vector<float>* arrays[] = { &PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &ScaleX, &ScaleY, &ScaleZ };
+	for (std::vector<float>* array : arrays)
+		array->resize(count, 0.0f);
+	// New objects start out unrotated and unscaled
+	size_t old = RotationW.size();
+	RotationW.resize(count, 1.0f);
+	for (size_t i = old; i < count; i++)
+		ScaleX[i] = ScaleY[i] = ScaleZ[i] = 1.0f;
+}
+
+void TransformArrays::Set(size_t index, const Vec3& position, const Quat& rotation, const Vec3& scale)
+{
+	PositionX[index] = position.x;
+	PositionY[index] = position.y;
+	PositionZ[index] = position.z;
+	RotationX[index] = rotation.x;
+	RotationY[index] = rotation.y;
+	RotationZ[index] = rotation.z;
+	RotationW[index] = rotation.w;
+	ScaleX[index] = scale.x;
+	ScaleY[index] = scale.y;
+	ScaleZ[index] = scale.z;
+}
+
+void BoundsArrays::Resize(size_t count)
+{
+	std::vector<float>* arrays[] = { &CenterX, &CenterY, &CenterZ, &ExtentX, &ExtentY, &ExtentZ };
+	for (std::vector<float>* array : arrays)
+		array->resize(count, 0.0f);
+}
+
+void BoundsArrays::Set(size_t index, const Vec3& center, const Vec3& extent)
+{
+	CenterX[index] = center.x;
+	CenterY[index] = center.y;
+	CenterZ[index] = center.z;
+	ExtentX[index] = extent.x;
+	ExtentY[index] = extent.y;
+	ExtentZ[index] = extent.z;
+}
+
+namespace {
+
+	struct ScalarOps
+	{
+		typedef float Vector;
+		static const size_t Width = 1;
+
+		static inline float Load(const float* p) { return *p; }
+		static inline void Store(float* p, float v) { *p = v; }
+		static inline float Set1(float v) { return v; }
+		static inline float Zero() { return 0.0f; }
+		static inline float Add(float a, float b) { return a + b; }
+		static inline float Sub(float a, float b) { return a - b; }
+		static inline float Mul(float a, float b) { return a * b; }
+		static inline float MulAdd(float a, float b, float c) { return a * b + c; }
+		static inline float Abs(float v) { return std::fabs(v); }
+		static inline void StoreMatrices(float* out, const float* m) { memcpy(out, m, sizeof(float) * 16); }
+	};
+
+#if MATH_SSE
+	struct SSEOps
+	{
+		typedef __m128 Vector;
+		static const size_t Width = 4;
+
+		static inline __m128 Load(const float* p) { return _mm_loadu_ps(p); }
+		static inline void Store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+		static inline __m128 Set1(float v) { return _mm_set1_ps(v); }
+		static inline __m128 Zero() { return _mm_setzero_ps(); }
+		static inline __m128 Add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+		static inline __m128 Sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+		static inline __m128 Mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+		static inline __m128 MulAdd(__m128 a, __m128 b, __m128 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+		static inline __m128 Abs(__m128 v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+
+		// Column c of object k is entries 4c..4c+3 of lane k
+		static inline void StoreMatrices(float* out, const __m128* m)
+		{
+			for (int column = 0; column < 4; column++) {
+				__m128 r0 = m[column * 4], r1 = m[column * 4 + 1], r2 = m[column * 4 + 2], r3 = m[column * 4 + 3];
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(out + column * 4, r0);
+				_mm_storeu_ps(out + 16 + column * 4, r1);
+				_mm_storeu_ps(out + 32 + column * 4, r2);
+				_mm_storeu_ps(out + 48 + column * 4, r3);
+			}
+		}
+	};
+#endif
+
+	bool DetectAVX2()
+	{
+#if TRANSFORM_KERNELS_X86
+	#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		bool fma = (info[2] & (1 << 12)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!fma || !osxsave || !avx)
+			return false;
+		// The OS has to save the YMM registers
+		if ((_xgetbv(0) & 0x6) != 0x6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	#else
+		// Also checks that the OS saves the YMM registers
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	#endif
+#else
+		return false;
+#endif
+	}
+
+	TransformKernels::KernelArgs MakeArgs(const TransformKernels::Job& job)
+	{
+		TransformKernels::KernelArgs args = {};
+		const TransformArrays& t = *job.Transforms;
+		args.Position[0] = t.PositionX.data();
+		args.Position[1] = t.PositionY.data();
+		args.Position[2] = t.PositionZ.data();
+		args.Rotation[0] = t.RotationX.data();
+		args.Rotation[1] = t.RotationY.data();
+		args.Rotation[2] = t.RotationZ.data();
+		args.Rotation[3] = t.RotationW.data();
+		args.Scale[0] = t.ScaleX.data();
+		args.Scale[1] = t.ScaleY.data();
+		args.Scale[2] = t.ScaleZ.data();
+		args.ViewProjection = job.ViewProjection.m;
+		args.World = job.World ? job.World->m : nullptr;
+		args.MVP = job.MVP ? job.MVP->m : nullptr;
+
+		if (job.LocalBounds && job.WorldBounds) {
+			args.LocalCenter[0] = job.LocalBounds->CenterX.data();
+			args.LocalCenter[1] = job.LocalBounds->CenterY.data();
+			args.LocalCenter[2] = job.LocalBounds->CenterZ.data();
+			args.LocalExtent[0] = job.LocalBounds->ExtentX.data();
+			args.LocalExtent[1] = job.LocalBounds->ExtentY.data();
+			args.LocalExtent[2] = job.LocalBounds->ExtentZ.data();
+			args.WorldCenter[0] = job.WorldBounds->CenterX.data();
+			args.WorldCenter[1] = job.WorldBounds->CenterY.data();
+			args.WorldCenter[2] = job.WorldBounds->CenterZ.data();
+			args.WorldExtent[0] = job.WorldBounds->ExtentX.data();
+			args.WorldExtent[1] = job.WorldBounds->ExtentY.data();
+			args.WorldExtent[2] = job.WorldBounds->ExtentZ.data();
+		}
+		return args;
+	}
+
+}
+
+namespace TransformKernels {
+
+	bool IsSupported(Path path)
+	{
+		static const bool avx2 = DetectAVX2();
+		switch (path) {
+		case Path::Scalar: return true;
+		case Path::SSE:    return MATH_SSE != 0;
+		case Path::AVX2:   return avx2;
+		}
+		return false;
+	}
+
+	Path GetBestPath()
+	{
+		if (IsSupported(Path::AVX2))
+			return Path::AVX2;
+		if (IsSupported(Path::SSE))
+			return Path::SSE;
+		return Path::Scalar;
+	}
+
+	const char* GetName(Path path)
+	{
+		switch (path) {
+		case Path::Scalar: return "scalar";
+		case Path::SSE:    return "SSE";
+		case Path::AVX2:   return "AVX2";
+		}
+		return "unknown";
+	}
+
+	void Run(Path path, const Job& job, size_t begin, size_t end)
+	{
+		if (begin >= end)
+			return;
+
+		KernelArgs args = MakeArgs(job);
+		size_t vectorEnd = begin;
+#if TRANSFORM_KERNELS_X86
+		if (path == Path::AVX2 && IsSupported(Path::AVX2)) {
+			vectorEnd = begin + (end - begin) / 8 * 8;
+			RunKernelAVX2(args, begin, vectorEnd);
+		}
+#endif
+#if MATH_SSE
+		if (path != Path::Scalar) {
+			size_t sseEnd = vectorEnd + (end - vectorEnd) / 4 * 4;
+			RunKernel<SSEOps>(args, vectorEnd, sseEnd);
+			vectorEnd = sseEnd;
+		}
+#endif
+		// The objects left over from the vector widths
+		RunKernel<ScalarOps>(args, vectorEnd, end);
+	}
+
+	void Run(const Job& job, ThreadPool* pool)
+	{
+		Path path = GetBestPath();
+		size_t count = job.Transforms->GetCount();
+		if (!pool) {
+			Run(path, job, 0, count);
+			return;
+		}
+
+		// A multiple of every vector width, so only the last chunk has a tail
+		const size_t grainSize = 4096;
+		pool->ParallelFor(count, grainSize, [&](size_t begin, size_t end) {
+			Run(path, job, begin, end);
+		});
+	}
+
+}
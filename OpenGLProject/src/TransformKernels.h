@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "VecMath.h"
+
+class ThreadPool;
+
+// Transforms of many objects with every component in an array of its own,
+// so the kernels below can load 4 or 8 objects' worth of one component at once
+struct TransformArrays
+{
+	std::vector<float> PositionX, PositionY, PositionZ;
+	std::vector<float> RotationX, RotationY, RotationZ, RotationW;
+	std::vector<float> ScaleX, ScaleY, ScaleZ;
+
+	void Resize(size_t count);
+	void Set(size_t index, const Vec3& position, const Quat& rotation, const Vec3& scale);
+
+	inline size_t GetCount() const { return PositionX.size(); }
+};
+
+// Axis aligned boxes as center and half extent, one array per component
+struct BoundsArrays
+{
+	std::vector<float> CenterX, CenterY, CenterZ;
+	std::vector<float> ExtentX, ExtentY, ExtentZ;
+
+	void Resize(size_t count);
+	void Set(size_t index, const Vec3& center, const Vec3& extent);
+
+	inline Vec3 GetCenter(size_t index) const { return Vec3(CenterX[index], CenterY[index], CenterZ[index]); }
+	inline Vec3 GetExtent(size_t index) const { return Vec3(ExtentX[index], ExtentY[index], ExtentZ[index]); }
+	inline size_t GetCount() const { return CenterX.size(); }
+};
+
+// Per-frame transform work for large object arrays in one pass: world
+// matrices from position, rotation and scale, MVP matrices, and world space
+// bounding boxes. Scalar, SSE and AVX2 paths give the same results up to
+// FMA rounding; the best supported one is picked at runtime.
+namespace TransformKernels {
+
+	enum class Path
+	{
+		Scalar,
+		SSE,
+		AVX2
+	};
+
+	bool IsSupported(Path path);
+	// AVX2 (with FMA) when the CPU and OS support it, else SSE when compiled in
+	Path GetBestPath();
+	const char* GetName(Path path);
+
+	// Outputs that are nullptr are skipped. World and MVP point at one Mat4
+	// per object; WorldBounds needs LocalBounds and has to be sized already.
+	struct Job
+	{
+		const TransformArrays* Transforms = nullptr;
+		const BoundsArrays* LocalBounds = nullptr;
+		Mat4 ViewProjection = Mat4::Identity();
+
+		Mat4* World = nullptr;
+		Mat4* MVP = nullptr;
+		BoundsArrays* WorldBounds = nullptr;
+	};
+
+	// Objects [begin, end) on the calling thread
+	void Run(Path path, const Job& job, size_t begin, size_t end);
+	// Every object with the best path, split across pool unless it is nullptr
+	void Run(const Job& job, ThreadPool* pool = nullptr);
+
+}
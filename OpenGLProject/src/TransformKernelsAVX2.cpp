@@ -0,0 +1,72 @@
+// Everything in this file is compiled for AVX2 and FMA, including the kernel
+// template, so the target switch comes before TransformKernelsImpl.h. It
+// only runs after TransformKernels::IsSupported(Path::AVX2). MSVC emits the
+// intrinsics without a target switch.
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+
+#include <cstddef>
+#include <immintrin.h>
+
+#if defined(__clang__)
+	#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC target("avx2,fma")
+#endif
+
+#include "TransformKernelsImpl.h"
+
+namespace {
+
+	struct AVX2Ops
+	{
+		typedef __m256 Vector;
+		static const size_t Width = 8;
+
+		static inline __m256 Load(const float* p) { return _mm256_loadu_ps(p); }
+		static inline void Store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+		static inline __m256 Set1(float v) { return _mm256_set1_ps(v); }
+		static inline __m256 Zero() { return _mm256_setzero_ps(); }
+		static inline __m256 Add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+		static inline __m256 Sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+		static inline __m256 Mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+		static inline __m256 MulAdd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+		static inline __m256 Abs(__m256 v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+
+		// A 4x4 transpose within each 128-bit lane leaves column c of
+		// object k in the low lane and of object k + 4 in the high lane
+		static inline void StoreMatrices(float* out, const __m256* m)
+		{
+			for (int column = 0; column < 4; column++) {
+				__m256 t0 = _mm256_unpacklo_ps(m[column * 4], m[column * 4 + 1]);
+				__m256 t1 = _mm256_unpackhi_ps(m[column * 4], m[column * 4 + 1]);
+				__m256 t2 = _mm256_unpacklo_ps(m[column * 4 + 2], m[column * 4 + 3]);
+				__m256 t3 = _mm256_unpackhi_ps(m[column * 4 + 2], m[column * 4 + 3]);
+				__m256 r[4];
+				r[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+				r[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+				r[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				r[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+				for (int k = 0; k < 4; k++) {
+					_mm_storeu_ps(out + k * 16 + column * 4, _mm256_castps256_ps128(r[k]));
+					_mm_storeu_ps(out + (k + 4) * 16 + column * 4, _mm256_extractf128_ps(r[k], 1));
+				}
+			}
+		}
+	};
+
+}
+
+namespace TransformKernels {
+
+	void RunKernelAVX2(const KernelArgs& args, size_t begin, size_t end)
+	{
+		RunKernel<AVX2Ops>(args, begin, end);
+	}
+
+}
+
+#if defined(__clang__)
+	#pragma clang attribute pop
+#endif
+
+#endif
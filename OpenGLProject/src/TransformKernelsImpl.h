@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+
+// Shared by TransformKernels.cpp and TransformKernelsAVX2.cpp. The AVX2 file
+// is compiled for AVX2, so nothing here may be an inline function that other
+// translation units could end up linking against; only the KernelArgs POD
+// and the kernel template, instantiated with different Ops per file.
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	#define TRANSFORM_KERNELS_X86 1
+#else
+	#define TRANSFORM_KERNELS_X86 0
+#endif
+
+namespace TransformKernels {
+
+	// Raw arrays of one Job. Outputs that are nullptr are skipped.
+	struct KernelArgs
+	{
+		const float* Position[3];
+		const float* Rotation[4];
+		const float* Scale[3];
+		const float* LocalCenter[3];
+		const float* LocalExtent[3];
+		const float* ViewProjection;
+
+		float* World;
+		float* MVP;
+		float* WorldCenter[3];
+		float* WorldExtent[3];
+	};
+
+	// Ops provides a Vector of Width objects and Load, Store, Set1, Zero, Add,
+	// Sub, Mul, MulAdd (a * b + c), Abs and StoreMatrices, which writes Width
+	// column-major matrices from 16 vectors of entries. Processes
+	// [begin, end), end - begin has to be a multiple of Width.
+	template<typename Ops>
+	void RunKernel(const KernelArgs& args, size_t begin, size_t end)
+	{
+		typedef typename Ops::Vector V;
+
+		const V one = Ops::Set1(1.0f);
+		const V two = Ops::Set1(2.0f);
+		V vp[16];
+		for (int i = 0; i < 16; i++)
+			vp[i] = Ops::Set1(args.ViewProjection[i]);
+
+		for (size_t i = begin; i < end; i += Ops::Width) {
+			V px = Ops::Load(args.Position[0] + i);
+			V py = Ops::Load(args.Position[1] + i);
+			V pz = Ops::Load(args.Position[2] + i);
+			V qx = Ops::Load(args.Rotation[0] + i);
+			V qy = Ops::Load(args.Rotation[1] + i);
+			V qz = Ops::Load(args.Rotation[2] + i);
+			V qw = Ops::Load(args.Rotation[3] + i);
+			V sx = Ops::Load(args.Scale[0] + i);
+			V sy = Ops::Load(args.Scale[1] + i);
+			V sz = Ops::Load(args.Scale[2] + i);
+
+			V xx = Ops::Mul(qx, qx), yy = Ops::Mul(qy, qy), zz = Ops::Mul(qz, qz);
+			V xy = Ops::Mul(qx, qy), xz = Ops::Mul(qx, qz), yz = Ops::Mul(qy, qz);
+			V wx = Ops::Mul(qw, qx), wy = Ops::Mul(qw, qy), wz = Ops::Mul(qw, qz);
+
+			// Translation * Rotation * Scale, see Mat4::TRS
+			V w[16];
+			w[0] = Ops::Mul(Ops::Sub(one, Ops::Mul(two, Ops::Add(yy, zz))), sx);
+			w[1] = Ops::Mul(Ops::Mul(two, Ops::Add(xy, wz)), sx);
+			w[2] = Ops::Mul(Ops::Mul(two, Ops::Sub(xz, wy)), sx);
+			w[3] = Ops::Zero();
+			w[4] = Ops::Mul(Ops::Mul(two, Ops::Sub(xy, wz)), sy);
+			w[5] = Ops::Mul(Ops::Sub(one, Ops::Mul(two, Ops::Add(xx, zz))), sy);
+			w[6] = Ops::Mul(Ops::Mul(two, Ops::Add(yz, wx)), sy);
+			w[7] = Ops::Zero();
+			w[8] = Ops::Mul(Ops::Mul(two, Ops::Add(xz, wy)), sz);
+			w[9] = Ops::Mul(Ops::Mul(two, Ops::Sub(yz, wx)), sz);
+			w[10] = Ops::Mul(Ops::Sub(one, Ops::Mul(two, Ops::Add(xx, yy))), sz);
+			w[11] = Ops::Zero();
+			w[12] = px;
+			w[13] = py;
+			w[14] = pz;
+			w[15] = one;
+
+			if (args.World)
+				Ops::StoreMatrices(args.World + i * 16, w);
+
+			if (args.MVP) {
+				// The world matrix's last row is (0, 0, 0, 1)
+				V mvp[16];
+				for (int column = 0; column < 3; column++) {
+					for (int row = 0; row < 4; row++) {
+						V sum = Ops::Mul(vp[row], w[column * 4]);
+						sum = Ops::MulAdd(vp[4 + row], w[column * 4 + 1], sum);
+						mvp[column * 4 + row] = Ops::MulAdd(vp[8 + row], w[column * 4 + 2], sum);
+					}
+				}
+				for (int row = 0; row < 4; row++) {
+					V sum = Ops::MulAdd(vp[row], px, vp[12 + row]);
+					sum = Ops::MulAdd(vp[4 + row], py, sum);
+					mvp[12 + row] = Ops::MulAdd(vp[8 + row], pz, sum);
+				}
+				Ops::StoreMatrices(args.MVP + i * 16, mvp);
+			}
+
+			if (args.WorldCenter[0]) {
+				// Arvo: the world box's half extent is |M| times the local one
+				V cx = Ops::Load(args.LocalCenter[0] + i);
+				V cy = Ops::Load(args.LocalCenter[1] + i);
+				V cz = Ops::Load(args.LocalCenter[2] + i);
+				V ex = Ops::Load(args.LocalExtent[0] + i);
+				V ey = Ops::Load(args.LocalExtent[1] + i);
+				V ez = Ops::Load(args.LocalExtent[2] + i);
+				for (int axis = 0; axis < 3; axis++) {
+					V center = Ops::MulAdd(w[axis], cx, w[12 + axis]);
+					center = Ops::MulAdd(w[4 + axis], cy, center);
+					center = Ops::MulAdd(w[8 + axis], cz, center);
+					Ops::Store(args.WorldCenter[axis] + i, center);
+
+					V extent = Ops::Mul(Ops::Abs(w[axis]), ex);
+					extent = Ops::MulAdd(Ops::Abs(w[4 + axis]), ey, extent);
+					extent = Ops::MulAdd(Ops::Abs(w[8 + axis]), ez, extent);
+					Ops::Store(args.WorldExtent[axis] + i, extent);
+				}
+			}
+		}
+	}
+
+#if TRANSFORM_KERNELS_X86
+	// In TransformKernelsAVX2.cpp; only call when the CPU supports AVX2 and FMA
+	void RunKernelAVX2(const KernelArgs& args, size_t begin, size_t end);
+#endif
+
+}
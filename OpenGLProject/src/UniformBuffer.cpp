@@ -0,0 +1,36 @@
+#include "UniformBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+UniformBuffer::Stats UniformBuffer::s_Stats;
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int binding)
+	: m_Size(size), m_Binding(binding)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+	Bind();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+	GLState::OnBufferDeleted(m_RendererID);
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	ASSERT(offset + size <= m_Size);
+
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+	GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+
+	s_Stats.Uploads++;
+	s_Stats.BytesUploaded += size;
+}
+
+void UniformBuffer::Bind() const
+{
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_RendererID);
+}
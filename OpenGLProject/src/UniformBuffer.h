@@ -0,0 +1,63 @@
+#pragma once
+
+// Binding points of the uniform blocks shared by every program. A program
+// that declares a block with one of these names gets it bound to the
+// matching point by ShaderLibrary::Load().
+namespace UniformBlock {
+
+	enum Binding : unsigned int
+	{
+		Frame = 0,
+		Material = 1
+	};
+
+}
+
+// std140 layout of "layout(std140) uniform Frame"
+struct FrameUniforms
+{
+	float ViewProjection[16];
+	float Time;
+	float Padding[3];
+};
+
+// std140 layout of "layout(std140) uniform Material"
+struct MaterialUniforms
+{
+	float Color[4];
+};
+
+// A uniform buffer object attached to one binding point. Its contents are
+// replaced with a single upload, and every program that binds the block to
+// the same point sees the update.
+class UniformBuffer {
+public:
+	struct Stats
+	{
+		unsigned int Uploads = 0;
+		unsigned long long BytesUploaded = 0;
+	};
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_Binding;
+
+	static Stats s_Stats;
+public:
+	UniformBuffer(unsigned int size, unsigned int binding);
+	~UniformBuffer();
+
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	// Attaches the buffer to its binding point
+	void Bind() const;
+
+	inline unsigned int GetBinding() const { return m_Binding; }
+	inline unsigned int GetSize() const { return m_Size; }
+
+	static const Stats& GetStats() { return s_Stats; }
+	static void ResetStats() { s_Stats = Stats(); }
+};
@@ -0,0 +1,268 @@
+#include "VecMath.h"
+
+Quat Quat::FromEuler(float pitch, float yaw, float roll)
+{
+	return FromAxisAngle(Vec3(0.0f, 1.0f, 0.0f), yaw)
+		* FromAxisAngle(Vec3(1.0f, 0.0f, 0.0f), pitch)
+		* FromAxisAngle(Vec3(0.0f, 0.0f, 1.0f), roll);
+}
+
+Quat Slerp(const Quat& a, const Quat& b, float t)
+{
+	float cosTheta = Dot(a, b);
+	Quat end = b;
+	if (cosTheta < 0.0f) {
+		cosTheta = -cosTheta;
+		end = Quat(-b.x, -b.y, -b.z, -b.w);
+	}
+
+	float wa, wb;
+	if (cosTheta > 0.9995f) {
+		wa = 1.0f - t;
+		wb = t;
+	}
+	else {
+		float theta = std::acos(cosTheta);
+		float sinTheta = std::sin(theta);
+		wa = std::sin((1.0f - t) * theta) / sinTheta;
+		wb = std::sin(t * theta) / sinTheta;
+	}
+	return Normalize(Quat(a.x * wa + end.x * wb, a.y * wa + end.y * wb, a.z * wa + end.z * wb, a.w * wa + end.w * wb));
+}
+
+Mat4 Mat4::Identity()
+{
+	Mat4 result = {};
+	result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.0f;
+	return result;
+}
+
+Mat4 Mat4::Translation(const Vec3& translation)
+{
+	Mat4 result = Identity();
+	result.m[12] = translation.x;
+	result.m[13] = translation.y;
+	result.m[14] = translation.z;
+	return result;
+}
+
+Mat4 Mat4::Scale(const Vec3& scale)
+{
+	Mat4 result = {};
+	result.m[0] = scale.x;
+	result.m[5] = scale.y;
+	result.m[10] = scale.z;
+	result.m[15] = 1.0f;
+	return result;
+}
+
+Mat4 Mat4::Rotation(const Quat& rotation)
+{
+	return TRS(Vec3(), rotation, Vec3(1.0f));
+}
+
+Mat4 Mat4::TRS(const Vec3& translation, const Quat& q, const Vec3& scale)
+{
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	Mat4 result;
+	result.m[0] = (1.0f - 2.0f * (yy + zz)) * scale.x;
+	result.m[1] = 2.0f * (xy + wz) * scale.x;
+	result.m[2] = 2.0f * (xz - wy) * scale.x;
+	result.m[3] = 0.0f;
+	result.m[4] = 2.0f * (xy - wz) * scale.y;
+	result.m[5] = (1.0f - 2.0f * (xx + zz)) * scale.y;
+	result.m[6] = 2.0f * (yz + wx) * scale.y;
+	result.m[7] = 0.0f;
+	result.m[8] = 2.0f * (xz + wy) * scale.z;
+	result.m[9] = 2.0f * (yz - wx) * scale.z;
+	result.m[10] = (1.0f - 2.0f * (xx + yy)) * scale.z;
+	result.m[11] = 0.0f;
+	result.m[12] = translation.x;
+	result.m[13] = translation.y;
+	result.m[14] = translation.z;
+	result.m[15] = 1.0f;
+	return result;
+}
+
+Mat4 Mat4::Perspective(float fovY, float aspect, float nearPlane, float farPlane)
+{
+	float f = 1.0f / std::tan(fovY * 0.5f);
+	Mat4 result = {};
+	result.m[0] = f / aspect;
+	result.m[5] = f;
+	result.m[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+	result.m[11] = -1.0f;
+	result.m[14] = 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+	return result;
+}
+
+Mat4 Mat4::Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+{
+	Mat4 result = Identity();
+	result.m[0] = 2.0f / (right - left);
+	result.m[5] = 2.0f / (top - bottom);
+	result.m[10] = -2.0f / (farPlane - nearPlane);
+	result.m[12] = -(right + left) / (right - left);
+	result.m[13] = -(top + bottom) / (top - bottom);
+	result.m[14] = -(farPlane + nearPlane) / (farPlane - nearPlane);
+	return result;
+}
+
+Mat4 Mat4::LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+{
+	Vec3 forward = Normalize(target - eye);
+	Vec3 side = Normalize(Cross(forward, up));
+	Vec3 cameraUp = Cross(side, forward);
+
+	Mat4 result = Identity();
+	result.m[0] = side.x;
+	result.m[4] = side.y;
+	result.m[8] = side.z;
+	result.m[1] = cameraUp.x;
+	result.m[5] = cameraUp.y;
+	result.m[9] = cameraUp.z;
+	result.m[2] = -forward.x;
+	result.m[6] = -forward.y;
+	result.m[10] = -forward.z;
+	result.m[12] = -Dot(side, eye);
+	result.m[13] = -Dot(cameraUp, eye);
+	result.m[14] = Dot(forward, eye);
+	return result;
+}
+
+Vec4 Mat4::operator*(const Vec4& v) const
+{
+#if MATH_SSE
+	__m128 result = _mm_mul_ps(_mm_load_ps(&m[0]), _mm_set1_ps(v.x));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&m[4]), _mm_set1_ps(v.y)));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&m[8]), _mm_set1_ps(v.z)));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&m[12]), _mm_set1_ps(v.w)));
+	Vec4 out;
+	_mm_storeu_ps(&out.x, result);
+	return out;
+#else
+	return Vec4(
+		m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+		m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+		m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+		m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w);
+#endif
+}
+
+Mat4 Mat4::operator*(const Mat4& b) const
+{
+	Mat4 result;
+#if MATH_SSE
+	// Each result column is this matrix's columns weighted by b's column
+	__m128 c0 = _mm_load_ps(&m[0]);
+	__m128 c1 = _mm_load_ps(&m[4]);
+	__m128 c2 = _mm_load_ps(&m[8]);
+	__m128 c3 = _mm_load_ps(&m[12]);
+	for (int column = 0; column < 4; column++) {
+		const float* bc = &b.m[column * 4];
+		__m128 sum = _mm_mul_ps(c0, _mm_set1_ps(bc[0]));
+		sum = _mm_add_ps(sum, _mm_mul_ps(c1, _mm_set1_ps(bc[1])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(bc[2])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(c3, _mm_set1_ps(bc[3])));
+		_mm_store_ps(&result.m[column * 4], sum);
+	}
+#else
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++) {
+			result.m[column * 4 + row] =
+				m[row] * b.m[column * 4] +
+				m[4 + row] * b.m[column * 4 + 1] +
+				m[8 + row] * b.m[column * 4 + 2] +
+				m[12 + row] * b.m[column * 4 + 3];
+		}
+	}
+#endif
+	return result;
+}
+
+Mat4 Mat4::Transposed() const
+{
+	Mat4 result;
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++)
+			result.m[row * 4 + column] = m[column * 4 + row];
+	}
+	return result;
+}
+
+Mat4 Mat4::Inverse() const
+{
+	// Cofactor expansion through the 2x2 sub-determinants
+	const float* a = m;
+	float s0 = a[0] * a[5] - a[4] * a[1];
+	float s1 = a[0] * a[9] - a[8] * a[1];
+	float s2 = a[0] * a[13] - a[12] * a[1];
+	float s3 = a[4] * a[9] - a[8] * a[5];
+	float s4 = a[4] * a[13] - a[12] * a[5];
+	float s5 = a[8] * a[13] - a[12] * a[9];
+	float c5 = a[10] * a[15] - a[14] * a[11];
+	float c4 = a[6] * a[15] - a[14] * a[7];
+	float c3 = a[6] * a[11] - a[10] * a[7];
+	float c2 = a[2] * a[15] - a[14] * a[3];
+	float c1 = a[2] * a[11] - a[10] * a[3];
+	float c0 = a[2] * a[7] - a[6] * a[3];
+
+	float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (determinant == 0.0f)
+		return Identity();
+	float inv = 1.0f / determinant;
+
+	Mat4 result;
+	result.m[0] = (a[5] * c5 - a[9] * c4 + a[13] * c3) * inv;
+	result.m[1] = (-a[1] * c5 + a[9] * c2 - a[13] * c1) * inv;
+	result.m[2] = (a[1] * c4 - a[5] * c2 + a[13] * c0) * inv;
+	result.m[3] = (-a[1] * c3 + a[5] * c1 - a[9] * c0) * inv;
+	result.m[4] = (-a[4] * c5 + a[8] * c4 - a[12] * c3) * inv;
+	result.m[5] = (a[0] * c5 - a[8] * c2 + a[12] * c1) * inv;
+	result.m[6] = (-a[0] * c4 + a[4] * c2 - a[12] * c0) * inv;
+	result.m[7] = (a[0] * c3 - a[4] * c1 + a[8] * c0) * inv;
+	result.m[8] = (a[7] * s5 - a[11] * s4 + a[15] * s3) * inv;
+	result.m[9] = (-a[3] * s5 + a[11] * s2 - a[15] * s1) * inv;
+	result.m[10] = (a[3] * s4 - a[7] * s2 + a[15] * s0) * inv;
+	result.m[11] = (-a[3] * s3 + a[7] * s1 - a[11] * s0) * inv;
+	result.m[12] = (-a[6] * s5 + a[10] * s4 - a[14] * s3) * inv;
+	result.m[13] = (a[2] * s5 - a[10] * s2 + a[14] * s1) * inv;
+	result.m[14] = (-a[2] * s4 + a[6] * s2 - a[14] * s0) * inv;
+	result.m[15] = (a[2] * s3 - a[6] * s1 + a[10] * s0) * inv;
+	return result;
+}
+
+Frustum Frustum::FromViewProjection(const Mat4& viewProjection)
+{
+	// Gribb and Hartmann: each plane is the last row plus or minus another
+	const float* m = viewProjection.m;
+	Vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+		rows[row] = Vec4(m[row], m[4 + row], m[8 + row], m[12 + row]);
+
+	Frustum frustum;
+	for (int i = 0; i < 3; i++) {
+		frustum.Planes[i * 2] = rows[3] + rows[i];
+		frustum.Planes[i * 2 + 1] = rows[3] - rows[i];
+	}
+	for (Vec4& plane : frustum.Planes) {
+		float length = Length(plane.XYZ());
+		if (length > 0.0f)
+			plane = plane * (1.0f / length);
+	}
+	return frustum;
+}
+
+bool Frustum::Intersects(const Vec3& center, const Vec3& extent) const
+{
+	for (const Vec4& plane : Planes) {
+		float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		float radius = std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+		if (distance < -radius)
+			return false;
+	}
+	return true;
+}
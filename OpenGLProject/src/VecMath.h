@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cmath>
+
+// SSE2 is part of every x64 target and of MSVC's default Win32 target
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define MATH_SSE 1
+	#include <emmintrin.h>
+#else
+	#define MATH_SSE 0
+#endif
+
+// Vectors, quaternions and column-major 4x4 matrices laid out as GL and
+// std140 expect them. Angles are in radians; projections map depth to
+// [-1, 1] and look down -Z. The batched kernels for many objects at once
+// are in TransformKernels.h.
+
+const float PI = 3.14159265358979f;
+
+inline float Radians(float degrees) { return degrees * (PI / 180.0f); }
+
+struct Vec2
+{
+	float x, y;
+
+	Vec2() : x(0.0f), y(0.0f) {}
+	Vec2(float x, float y) : x(x), y(y) {}
+};
+
+struct Vec3
+{
+	float x, y, z;
+
+	Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+	explicit Vec3(float s) : x(s), y(s), z(s) {}
+	Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+	inline Vec3 operator+(const Vec3& v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+	inline Vec3 operator-(const Vec3& v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+	inline Vec3 operator*(const Vec3& v) const { return Vec3(x * v.x, y * v.y, z * v.z); }
+	inline Vec3 operator*(float s) const { return Vec3(x * s, y * s, z * s); }
+	inline Vec3 operator/(float s) const { return *this * (1.0f / s); }
+	inline Vec3 operator-() const { return Vec3(-x, -y, -z); }
+	inline Vec3& operator+=(const Vec3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+	inline Vec3& operator-=(const Vec3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	inline Vec3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+};
+
+struct Vec4
+{
+	float x, y, z, w;
+
+	Vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+	Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+	Vec4(const Vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+	inline Vec4 operator+(const Vec4& v) const { return Vec4(x + v.x, y + v.y, z + v.z, w + v.w); }
+	inline Vec4 operator-(const Vec4& v) const { return Vec4(x - v.x, y - v.y, z - v.z, w - v.w); }
+	inline Vec4 operator*(float s) const { return Vec4(x * s, y * s, z * s, w * s); }
+	inline Vec3 XYZ() const { return Vec3(x, y, z); }
+};
+
+inline Vec3 operator*(float s, const Vec3& v) { return v * s; }
+
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline Vec3 Cross(const Vec3& a, const Vec3& b)
+{
+	return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+inline float Length(const Vec3& v) { return std::sqrt(Dot(v, v)); }
+// Returns v unchanged when it has no length
+inline Vec3 Normalize(const Vec3& v)
+{
+	float length = Length(v);
+	return length > 0.0f ? v / length : v;
+}
+// Plain compares; std::fmin is usually an out of line call because of NaN
+inline float Min(float a, float b) { return a < b ? a : b; }
+inline float Max(float a, float b) { return a > b ? a : b; }
+inline Vec3 Min(const Vec3& a, const Vec3& b) { return Vec3(Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z)); }
+inline Vec3 Max(const Vec3& a, const Vec3& b) { return Vec3(Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z)); }
+inline Vec3 Lerp(const Vec3& a, const Vec3& b, float t) { return a + (b - a) * t; }
+
+struct Quat
+{
+	float x, y, z, w;
+
+	Quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+	Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	// axis has to be normalized
+	static Quat FromAxisAngle(const Vec3& axis, float radians)
+	{
+		float s = std::sin(radians * 0.5f);
+		return Quat(axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f));
+	}
+	// Applied in Z, X, Y order, i.e. yaw(pitch(roll(v)))
+	static Quat FromEuler(float pitch, float yaw, float roll);
+
+	inline Quat operator*(const Quat& q) const
+	{
+		return Quat(
+			w * q.x + x * q.w + y * q.z - z * q.y,
+			w * q.y - x * q.z + y * q.w + z * q.x,
+			w * q.z + x * q.y - y * q.x + z * q.w,
+			w * q.w - x * q.x - y * q.y - z * q.z);
+	}
+
+	inline Quat Conjugate() const { return Quat(-x, -y, -z, w); }
+
+	inline Vec3 Rotate(const Vec3& v) const
+	{
+		// v + 2w(u x v) + 2u x (u x v), with u the vector part
+		Vec3 u(x, y, z);
+		Vec3 t = Cross(u, v) * 2.0f;
+		return v + t * w + Cross(u, t);
+	}
+};
+
+inline float Dot(const Quat& a, const Quat& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline Quat Normalize(const Quat& q)
+{
+	float length = std::sqrt(Dot(q, q));
+	return length > 0.0f ? Quat(q.x / length, q.y / length, q.z / length, q.w / length) : Quat();
+}
+// Shortest path; falls back to a normalized lerp for nearly equal rotations
+Quat Slerp(const Quat& a, const Quat& b, float t);
+
+// Column-major: m[column * 4 + row]
+struct alignas(16) Mat4
+{
+	float m[16];
+
+	static Mat4 Identity();
+	static Mat4 Translation(const Vec3& translation);
+	static Mat4 Scale(const Vec3& scale);
+	static Mat4 Rotation(const Quat& rotation);
+	// Translation * Rotation * Scale
+	static Mat4 TRS(const Vec3& translation, const Quat& rotation, const Vec3& scale);
+
+	static Mat4 Perspective(float fovY, float aspect, float nearPlane, float farPlane);
+	static Mat4 Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane);
+	static Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
+
+	inline float& operator()(int row, int column) { return m[column * 4 + row]; }
+	inline float operator()(int row, int column) const { return m[column * 4 + row]; }
+
+	inline const float* Data() const { return m; }
+
+	inline Vec3 TransformPoint(const Vec3& p) const
+	{
+		return Vec3(
+			m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+			m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+			m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+	}
+	inline Vec3 TransformVector(const Vec3& v) const
+	{
+		return Vec3(
+			m[0] * v.x + m[4] * v.y + m[8] * v.z,
+			m[1] * v.x + m[5] * v.y + m[9] * v.z,
+			m[2] * v.x + m[6] * v.y + m[10] * v.z);
+	}
+
+	Vec4 operator*(const Vec4& v) const;
+	Mat4 operator*(const Mat4& b) const;
+
+	Mat4 Transposed() const;
+	// General inverse; returns the identity for a singular matrix
+	Mat4 Inverse() const;
+};
+
+// Six inward facing planes (x, y, z) . p + w >= 0, normalized
+struct Frustum
+{
+	Vec4 Planes[6];
+
+	// Left, right, bottom, top, near, far of a GL clip space
+	static Frustum FromViewProjection(const Mat4& viewProjection);
+
+	// Conservative: a box near an edge may pass without touching the frustum
+	bool Intersects(const Vec3& center, const Vec3& extent) const;
+};
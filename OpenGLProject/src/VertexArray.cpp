@@ -1,34 +1,59 @@
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "GLState.h"
 
-VertexArray::VertexArray() {
+VertexArray::VertexArray()
+	: m_AttributeCount(0)
+{
 	GLCall(glGenVertexArrays(1, &m_RendererID));
 }
 
 VertexArray::~VertexArray() {
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	GLState::OnVertexArrayDeleted(m_RendererID);
 }
 
-void VertexArray::AddBuffer(const VertexBuffer& vbo, const VertexBufferLayout& layout)
+void VertexArray::AddBuffer(const VertexBuffer& vbo, const VertexBufferLayout& layout, unsigned int divisor, unsigned int baseAttribute)
 {
 	Bind();
 	vbo.Bind();
-	const auto& elements = layout.GetElements();
-	uintptr_t offset = 0;
-	for (unsigned int i = 0; i < elements.size(); i++) {
-		const auto& element = elements[i];
+	SetupAttributes(layout.GetElements().data(), (unsigned int)layout.GetElements().size(), layout.GetStride(), divisor, baseAttribute);
+}
+
+void VertexArray::AddBuffer(const StreamingBuffer& buffer, const VertexBufferLayout& layout, unsigned int divisor, unsigned int baseAttribute)
+{
+	Bind();
+	buffer.Bind();
+	SetupAttributes(layout.GetElements().data(), (unsigned int)layout.GetElements().size(), layout.GetStride(), divisor, baseAttribute);
+}
+
+void VertexArray::SetupAttributes(const VertexBufferElement* elements, unsigned int count, unsigned int stride, unsigned int divisor, unsigned int baseAttribute)
+{
+	unsigned int base = baseAttribute == NextAttribute ? m_AttributeCount : baseAttribute;
+	for (unsigned int n = 0; n < count; n++) {
+		const auto& element = elements[n];
+		unsigned int i = base + n;
+		const void* offset = (const void*)(uintptr_t)element.offset;
 		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
-		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		if (element.integer) {
+			GLCall(glVertexAttribIPointer(i, element.count, element.type, stride, offset));
+		}
+		else {
+			GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, stride, offset));
+		}
+		GLCall(glVertexAttribDivisor(i, divisor));
 	}
+
+	if (base + count > m_AttributeCount)
+		m_AttributeCount = base + count;
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLState::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLState::BindVertexArray(0);
 }
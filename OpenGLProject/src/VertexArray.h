@@ -1,17 +1,48 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "StreamingBuffer.h"
 #include "VertexBufferLayout.h"
 
+// Each added buffer's attributes start where the previous buffer's ended,
+// unless a base attribute is given (e.g. to replace an instance buffer).
+// A divisor above 0 advances the buffer once per that many instances
+// instead of once per vertex.
 class VertexArray {
+public:
+	static const unsigned int NextAttribute = 0xFFFFFFFF;
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttributeCount;
+
+	void SetupAttributes(const VertexBufferElement* elements, unsigned int count, unsigned int stride, unsigned int divisor, unsigned int baseAttribute);
 public:
 	VertexArray();
 	~VertexArray();
 
-	void AddBuffer(const VertexBuffer& vbo, const VertexBufferLayout& layout);
+	void AddBuffer(const VertexBuffer& vbo, const VertexBufferLayout& layout, unsigned int divisor = 0, unsigned int baseAttribute = NextAttribute);
+	void AddBuffer(const StreamingBuffer& buffer, const VertexBufferLayout& layout, unsigned int divisor = 0, unsigned int baseAttribute = NextAttribute);
+
+	template<typename... Attributes>
+	void AddBuffer(const VertexBuffer& vbo, const StaticVertexLayout<Attributes...>& layout, unsigned int divisor = 0, unsigned int baseAttribute = NextAttribute)
+	{
+		Bind();
+		vbo.Bind();
+		SetupAttributes(layout.Elements.data(), layout.Count, layout.Stride, divisor, baseAttribute);
+	}
+
+	template<typename... Attributes>
+	void AddBuffer(const StreamingBuffer& buffer, const StaticVertexLayout<Attributes...>& layout, unsigned int divisor = 0, unsigned int baseAttribute = NextAttribute)
+	{
+		Bind();
+		buffer.Bind();
+		SetupAttributes(layout.Elements.data(), layout.Count, layout.Stride, divisor, baseAttribute);
+	}
 
 	void Bind() const;
 	void Unbind() const;
-};
\ No newline at end of file
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	// One past the highest attribute index in use
+	inline unsigned int GetAttributeCount() const { return m_AttributeCount; }
+};
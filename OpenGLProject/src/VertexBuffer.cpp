@@ -1,25 +1,52 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
 
+VertexBuffer::Stats VertexBuffer::s_Stats;
+uint64_t VertexBuffer::s_NextGeneration = 1;
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+	: m_Size(size), m_Generation(s_NextGeneration++)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	Bind();
 	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+
+	s_Stats.Uploads++;
+	s_Stats.BytesUploaded += size;
+}
+
+VertexBuffer::VertexBuffer(unsigned int size)
+	: m_Size(size), m_Generation(s_NextGeneration++)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	Bind();
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	GLCall(glDeleteBuffers(1, &m_RendererID));
+	GLState::OnBufferDeleted(m_RendererID);
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	ASSERT(offset + size <= m_Size);
+
+	Bind();
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+
+	s_Stats.Uploads++;
+	s_Stats.BytesUploaded += size;
 }
 
 void VertexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
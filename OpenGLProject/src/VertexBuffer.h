@@ -1,12 +1,37 @@
 #pragma once
 
+#include <cstdint>
+
 class VertexBuffer {
+public:
+	struct Stats
+	{
+		unsigned int Uploads = 0;
+		unsigned long long BytesUploaded = 0;
+	};
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size;
+	uint64_t m_Generation;
+
+	static Stats s_Stats;
+	static uint64_t s_NextGeneration;
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	// Allocates an empty GL_DYNAMIC_DRAW buffer to be filled with SetData()
+	VertexBuffer(unsigned int size);
 	~VertexBuffer();
 
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
 	void Bind() const;
 	void Unbind() const;
-};
\ No newline at end of file
+
+	inline unsigned int GetSize() const { return m_Size; }
+	// Never 0 and never shared with another buffer, unlike the GL name,
+	// which a new buffer gets again once this one is deleted
+	inline uint64_t GetGeneration() const { return m_Generation; }
+
+	static const Stats& GetStats() { return s_Stats; }
+	static void ResetStats() { s_Stats = Stats(); }
+};
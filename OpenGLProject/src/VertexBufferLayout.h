@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
 #include "Renderer.h"
@@ -9,20 +12,86 @@ struct VertexBufferElement
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	// Read with glVertexAttribIPointer, so the shader sees int/uint instead of float
+	unsigned char integer;
+	unsigned int offset;
 
-	static unsigned int GetSizeOfType(unsigned int type)
+	static constexpr unsigned int GetSizeOfType(unsigned int type)
 	{
 		switch (type)
 		{
-			case GL_FLOAT:          return 4;
-			case GL_UNSIGNED_INT:   return 4;
-			case GL_UNSIGNED_BYTE:  return 1;
+			case GL_FLOAT:                        return 4;
+			case GL_HALF_FLOAT:                   return 2;
+			case GL_INT:                          return 4;
+			case GL_UNSIGNED_INT:                 return 4;
+			case GL_SHORT:                        return 2;
+			case GL_UNSIGNED_SHORT:               return 2;
+			case GL_BYTE:                         return 1;
+			case GL_UNSIGNED_BYTE:                return 1;
+			case GL_INT_2_10_10_10_REV:           return 4;
+			case GL_UNSIGNED_INT_2_10_10_10_REV:  return 4;
 		}
 		ASSERT(0);
 		return 0;
 	}
+
+	static constexpr bool IsSupportedType(unsigned int type)
+	{
+		switch (type)
+		{
+			case GL_FLOAT: case GL_HALF_FLOAT:
+			case GL_INT: case GL_UNSIGNED_INT:
+			case GL_SHORT: case GL_UNSIGNED_SHORT:
+			case GL_BYTE: case GL_UNSIGNED_BYTE:
+			case GL_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_2_10_10_10_REV:
+				return true;
+		}
+		return false;
+	}
+
+	static constexpr bool IsPackedType(unsigned int type)
+	{
+		return type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+	}
+
+	static constexpr bool IsIntegerType(unsigned int type)
+	{
+		return type != GL_FLOAT && type != GL_HALF_FLOAT && !IsPackedType(type);
+	}
+
+	// Packed types hold all four components in one value
+	constexpr unsigned int GetSize() const
+	{
+		return IsPackedType(type) ? GetSizeOfType(type) : count * GetSizeOfType(type);
+	}
+
+	bool operator==(const VertexBufferElement& other) const
+	{
+		return type == other.type && count == other.count && normalized == other.normalized &&
+			integer == other.integer && offset == other.offset;
+	}
 };
 
+// Marker types for Push<T>/VertexAttribute<T> so every supported format has a C++ spelling
+struct Half { uint16_t bits; };
+struct NormalizedShort { int16_t value; };
+struct NormalizedUShort { uint16_t value; };
+struct PackedNormal { uint32_t bits; };
+
+// Maps a component type to its GL enum and whether it is normalized
+template<typename T> struct VertexAttributeType;
+template<> struct VertexAttributeType<float>            { static constexpr unsigned int Type = GL_FLOAT;              static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<Half>             { static constexpr unsigned int Type = GL_HALF_FLOAT;         static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<int>              { static constexpr unsigned int Type = GL_INT;                static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<unsigned int>     { static constexpr unsigned int Type = GL_UNSIGNED_INT;       static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<short>            { static constexpr unsigned int Type = GL_SHORT;              static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<unsigned short>   { static constexpr unsigned int Type = GL_UNSIGNED_SHORT;     static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<NormalizedShort>  { static constexpr unsigned int Type = GL_SHORT;              static constexpr bool Normalized = true;  };
+template<> struct VertexAttributeType<NormalizedUShort> { static constexpr unsigned int Type = GL_UNSIGNED_SHORT;     static constexpr bool Normalized = true;  };
+template<> struct VertexAttributeType<signed char>      { static constexpr unsigned int Type = GL_BYTE;               static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<unsigned char>    { static constexpr unsigned int Type = GL_UNSIGNED_BYTE;      static constexpr bool Normalized = true;  };
+template<> struct VertexAttributeType<PackedNormal>     { static constexpr unsigned int Type = GL_INT_2_10_10_10_REV; static constexpr bool Normalized = true;  };
+
 class VertexBufferLayout
 {
 private:
@@ -32,33 +101,162 @@ public:
 	VertexBufferLayout()
 		: m_Stride(0) {};
 
+	void Push(unsigned int type, unsigned int count, bool normalized, bool integer = false)
+	{
+		VertexBufferElement element = { type, count, (unsigned char)(normalized ? GL_TRUE : GL_FALSE), (unsigned char)integer, m_Stride };
+		m_Elements.push_back(element);
+		m_Stride += element.GetSize();
+	}
+
+	// Component type and normalization come from VertexAttributeType<T>;
+	// PackedNormal always pushes one 4-component value
 	template<typename T>
-	void Push(unsigned int count) {
-		ASSERT(false);
-		// static_assert(false);
+	void Push(unsigned int count)
+	{
+		Push(VertexAttributeType<T>::Type, VertexBufferElement::IsPackedType(VertexAttributeType<T>::Type) ? 4 : count,
+			VertexAttributeType<T>::Normalized);
+	}
+
+	// Integer attribute (ivec/uvec in the shader)
+	template<typename T>
+	void PushInteger(unsigned int count)
+	{
+		static_assert(VertexBufferElement::IsIntegerType(VertexAttributeType<T>::Type), "integer attributes need an integer component type");
+		Push(VertexAttributeType<T>::Type, count, false, true);
+	}
+
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+	inline unsigned int GetStride() const { return m_Stride; }
+
+	bool operator==(const VertexBufferLayout& other) const { return m_Stride == other.m_Stride && m_Elements == other.m_Elements; }
+	bool operator!=(const VertexBufferLayout& other) const { return !(*this == other); }
+};
+
+// One attribute of a StaticVertexLayout
+template<typename T, unsigned int Count, bool Integer = false>
+struct VertexAttribute
+{
+	static constexpr unsigned int Type = VertexAttributeType<T>::Type;
+	static constexpr unsigned int Components = VertexBufferElement::IsPackedType(Type) ? 4 : Count;
+	static constexpr bool Normalized = VertexAttributeType<T>::Normalized && !Integer;
+	static constexpr unsigned int Size = VertexBufferElement::IsPackedType(Type) ? 4 : Count * VertexBufferElement::GetSizeOfType(Type);
+
+	static_assert(!Integer || VertexBufferElement::IsIntegerType(Type), "integer attributes need an integer component type");
+};
+
+template<typename T, unsigned int Count>
+using IntegerVertexAttribute = VertexAttribute<T, Count, true>;
+
+// A layout fixed at compile time: element offsets and the stride are
+// constant expressions and nothing is allocated. Vertex types declare theirs
+// as a nested Layout so the stride can be checked against sizeof:
+//
+//   struct PackedVertex {
+//       float Position[3];
+//       PackedNormal Normal;
+//       Half TexCoord[2];
+//       using Layout = StaticVertexLayout<VertexAttribute<float, 3>, VertexAttribute<PackedNormal, 1>, VertexAttribute<Half, 2>>;
+//   };
+template<typename... Attributes>
+class StaticVertexLayout
+{
+private:
+	template<typename Attribute>
+	static constexpr VertexBufferElement MakeElement(unsigned int offset)
+	{
+		return { Attribute::Type, Attribute::Components, (unsigned char)(Attribute::Normalized ? GL_TRUE : GL_FALSE),
+			(unsigned char)IsInteger<Attribute>::Value, offset };
 	}
 
-	template<>
-	void Push<float>(unsigned int count)
+	template<typename Attribute> struct IsInteger { static constexpr bool Value = false; };
+	template<typename T, unsigned int Count> struct IsInteger<VertexAttribute<T, Count, true>> { static constexpr bool Value = true; };
+
+	static constexpr std::array<VertexBufferElement, sizeof...(Attributes)> BuildElements()
 	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
+		constexpr unsigned int sizes[] = { Attributes::Size... };
+		unsigned int offsets[sizeof...(Attributes)] = {};
+		for (unsigned int i = 1; i < sizeof...(Attributes); i++)
+			offsets[i] = offsets[i - 1] + sizes[i - 1];
+
+		unsigned int i = 0;
+		return { { MakeElement<Attributes>(offsets[i++])... } };
 	}
+public:
+	static constexpr unsigned int Count = sizeof...(Attributes);
+	static constexpr unsigned int Stride = (Attributes::Size + ... + 0);
+	static constexpr std::array<VertexBufferElement, sizeof...(Attributes)> Elements = BuildElements();
+
+	static_assert(sizeof...(Attributes) > 0, "a vertex layout needs at least one attribute");
+};
 
-	template<>
-	void Push<unsigned int>(unsigned int count)
+// Conversions into the compact attribute formats
+namespace VertexPacking {
+
+	inline Half ToHalf(float value)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign = (bits >> 16) & 0x8000;
+		int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x007FFFFF;
+
+		Half half;
+		if (((bits >> 23) & 0xFF) == 0xFF) {
+			// Inf stays inf, NaN stays NaN
+			half.bits = (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+		}
+		else if (exponent >= 31) {
+			half.bits = (uint16_t)(sign | 0x7C00);
+		}
+		else if (exponent <= 0) {
+			if (exponent < -10) {
+				half.bits = (uint16_t)sign;
+			}
+			else {
+				// Denormal, rounded to nearest
+				mantissa |= 0x00800000;
+				uint32_t shift = (uint32_t)(14 - exponent);
+				uint32_t rounded = (mantissa + (1u << (shift - 1))) >> shift;
+				half.bits = (uint16_t)(sign | rounded);
+			}
+		}
+		else {
+			// Round to nearest; a carry out of the mantissa correctly bumps the exponent
+			uint32_t rounded = ((uint32_t)exponent << 10 | mantissa >> 13) + ((mantissa >> 12) & 1);
+			half.bits = (uint16_t)(sign | (rounded > 0x7C00 ? 0x7C00 : rounded));
+		}
+		return half;
 	}
 
-	template<>
-	void Push<unsigned char>(unsigned int count)
+	inline NormalizedShort ToNormalizedShort(float value)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+		value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		NormalizedShort result;
+		result.value = (int16_t)(value * 32767.0f + (value >= 0.0f ? 0.5f : -0.5f));
+		return result;
 	}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
-	inline unsigned int GetStride() const { return m_Stride; }
-};
\ No newline at end of file
+	inline NormalizedUShort ToNormalizedUShort(float value)
+	{
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		NormalizedUShort result;
+		result.value = (uint16_t)(value * 65535.0f + 0.5f);
+		return result;
+	}
+
+	// Signed normalized x, y, z in 10 bits each and w in 2 bits (GL_INT_2_10_10_10_REV)
+	inline PackedNormal ToPackedNormal(float x, float y, float z, float w = 0.0f)
+	{
+		auto pack = [](float value, float scale, uint32_t mask) {
+			value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+			int32_t integer = (int32_t)(value * scale + (value >= 0.0f ? 0.5f : -0.5f));
+			return (uint32_t)integer & mask;
+		};
+
+		PackedNormal result;
+		result.bits = pack(x, 511.0f, 0x3FF) | pack(y, 511.0f, 0x3FF) << 10 | pack(z, 511.0f, 0x3FF) << 20 | pack(w, 1.0f, 0x3) << 30;
+		return result;
+	}
+
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BVH.h"
+#include "ThreadPool.h"
+
+// Frustum culling of 100k and 1M boxes scattered through a city sized
+// volume: building the BVH, refitting it after moving 1% of the objects,
+// and culling on one thread and on the pool, next to testing every box.
+static const size_t s_Counts[] = { 100000, 1000000 };
+
+BENCHMARK(BVHCulling)
+{
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	const Frustum frustum = Frustum::FromViewProjection(Mat4::Perspective(Radians(60.0f), 16.0f / 9.0f, 0.1f, 600.0f)
+		* Mat4::LookAt(Vec3(0.0f, 30.0f, 0.0f), Vec3(400.0f, 0.0f, 300.0f), Vec3(0.0f, 1.0f, 0.0f)));
+	ThreadPool& pool = ThreadPool::Get();
+
+	for (size_t count : s_Counts) {
+		BoundsArrays bounds;
+		bounds.Resize(count);
+		for (size_t i = 0; i < count; i++) {
+			Vec3 center(distribution(random) * 1000.0f, distribution(random) * 50.0f + 50.0f, distribution(random) * 1000.0f);
+			bounds.Set(i, center, Vec3(size(random), size(random), size(random)));
+		}
+
+		std::vector<uint32_t> moved(count / 100);
+		for (uint32_t& object : moved)
+			object = (uint32_t)(random() % count);
+
+		const std::string prefix = std::to_string(count / 1000) + "k ";
+		BVH bvh;
+		Timer timer;
+		bvh.Build(bounds);
+		Benchmark::Report(prefix + "build", timer.ElapsedMilliseconds(), "ms");
+		Benchmark::Report(prefix + "nodes", bvh.GetNodeCount(), "");
+
+		Benchmark::Report(prefix + "full refit", Benchmark::TimeMilliseconds([&]() { bvh.Refit(bounds); }), "ms");
+		Benchmark::Report(prefix + "refit of 1% moved", Benchmark::TimeMilliseconds([&]() {
+			for (uint32_t object : moved)
+				bounds.CenterX[object] += 0.1f;
+			bvh.Refit(bounds, moved.data(), moved.size());
+		}), "ms");
+
+		std::vector<uint32_t> reference;
+		double bruteForce = Benchmark::TimeMilliseconds([&]() {
+			reference.clear();
+			for (size_t i = 0; i < count; i++) {
+				if (frustum.Intersects(bounds.GetCenter(i), bounds.GetExtent(i)))
+					reference.push_back((uint32_t)i);
+			}
+		});
+		Benchmark::Report(prefix + "every box", bruteForce, "ms");
+
+		std::vector<uint32_t> visible;
+		Benchmark::Report(prefix + "BVH cull", Benchmark::TimeMilliseconds([&]() { bvh.Cull(frustum, visible); }), "ms");
+		const BVH::Stats stats = bvh.GetStats();
+		Benchmark::Report(prefix + "BVH cull on the pool", Benchmark::TimeMilliseconds([&]() { bvh.Cull(frustum, visible, &pool); }), "ms");
+
+		Benchmark::Report(prefix + "nodes tested", stats.NodesTested, "");
+		Benchmark::Report(prefix + "objects tested", stats.ObjectsTested, "");
+		Benchmark::Report(prefix + "visible", stats.Visible, "");
+		Benchmark::Report(prefix + "culled", stats.Culled, "");
+
+		// Leaves use the same test as Frustum::Intersects, so both have to
+		// find exactly the same objects
+		std::sort(visible.begin(), visible.end());
+		Benchmark::Check(prefix + "matches every box test", visible == reference);
+	}
+	Benchmark::Report("pool threads", pool.GetWorkerCount() + 1.0, "");
+}
@@ -0,0 +1,44 @@
+#include "Benchmark.h"
+#include "BatchRenderer.h"
+#include "Renderer.h"
+
+// Measures the CPU cost of submitting quads through the BatchRenderer.
+// No program is bound, so the driver only sees the uploads and draw calls.
+BENCHMARK(BatchRendererSubmit)
+{
+	const unsigned int quadCounts[] = { 10000, 100000, 1000000 };
+	const float color[4] = { 1.0f, 0.5f, 0.25f, 1.0f };
+
+	BatchRenderer batch(10000);
+
+	for (unsigned int quads : quadCounts) {
+		// Warm up driver allocations before timing
+		batch.Begin();
+		batch.DrawQuad(0.0f, 0.0f, 0.0f, 1.0f, 1.0f, color);
+		batch.End();
+		GLCall(glFinish());
+		batch.ResetStats();
+
+		Timer timer;
+		batch.Begin();
+		unsigned int side = 1000;
+		for (unsigned int i = 0; i < quads; i++) {
+			float x = (float)(i % side) / side * 2.0f - 1.0f;
+			float y = (float)(i / side % side) / side * 2.0f - 1.0f;
+			batch.DrawQuad(x, y, 0.0f, 0.002f, 0.002f, color);
+		}
+		batch.End();
+		double submitMs = timer.ElapsedMilliseconds();
+
+		GLCall(glFinish());
+		double totalMs = timer.ElapsedMilliseconds();
+
+		const BatchRenderer::Stats& stats = batch.GetStats();
+		std::string prefix = std::to_string(quads) + " quads ";
+		Benchmark::Report(prefix + "submit", submitMs, "ms");
+		Benchmark::Report(prefix + "submit per quad", submitMs * 1e6 / quads, "ns");
+		Benchmark::Report(prefix + "submit + glFinish", totalMs, "ms");
+		Benchmark::Report(prefix + "flushes", stats.FlushCount, "");
+		Benchmark::Report(prefix + "uploaded", stats.BytesUploaded / (1024.0 * 1024.0), "MiB");
+	}
+}
@@ -0,0 +1,16 @@
+#include "BenchmarkFixtures.h"
+
+FrameUniforms CreateIdentityFrame()
+{
+	FrameUniforms frame = {};
+	frame.ViewProjection[0] = frame.ViewProjection[5] = frame.ViewProjection[10] = frame.ViewProjection[15] = 1.0f;
+	return frame;
+}
+
+std::unique_ptr<UniformBuffer> CreateFrameUniforms()
+{
+	FrameUniforms frame = CreateIdentityFrame();
+	std::unique_ptr<UniformBuffer> uniforms = std::make_unique<UniformBuffer>(sizeof(FrameUniforms), UniformBlock::Frame);
+	uniforms->SetData(&frame, sizeof(frame));
+	return uniforms;
+}
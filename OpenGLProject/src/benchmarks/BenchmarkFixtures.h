@@ -0,0 +1,12 @@
+#pragma once
+
+#include <memory>
+
+#include "UniformBuffer.h"
+
+// Setup shared by the benchmarks and the headless render scenes
+
+// Identity view-projection, so positions are given in clip space; Time is 0
+FrameUniforms CreateIdentityFrame();
+// A Frame block at UniformBlock::Frame holding CreateIdentityFrame()
+std::unique_ptr<UniformBuffer> CreateFrameUniforms();
@@ -0,0 +1,164 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BenchmarkFixtures.h"
+#include "Renderer.h"
+#include "DrawQueue.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+
+// 4096 quads drawn in random order from 8 vertex arrays with 32 materials
+// over 4 programs and 16 textures, submitted through the DrawQueue once in
+// submission order and once sorted by key.
+static const unsigned int s_VertexArrays = 8;
+static const unsigned int s_QuadsPerArray = 512;
+static const unsigned int s_Programs = 4;
+static const unsigned int s_Textures = 16;
+static const unsigned int s_Materials = 32;
+static const unsigned int s_Draws = 4096;
+static const unsigned int s_Frames = 20;
+
+struct QuadGeometry
+{
+	std::unique_ptr<VertexArray> VAO;
+	std::unique_ptr<VertexBuffer> VBO;
+	std::unique_ptr<IndexBuffer> IBO;
+};
+
+struct QueuedDraw
+{
+	unsigned int Geometry;
+	unsigned int Quad;
+	unsigned int Material;
+	float Depth;
+};
+
+static QuadGeometry CreateQuads(unsigned int seed) {
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	const float size = 0.05f;
+	for (unsigned int q = 0; q < s_QuadsPerArray; q++) {
+		float x = (float)((q * 37 + seed * 11) % 40) / 20.0f - 1.0f;
+		float y = (float)((q * 17 + seed * 5) % 40) / 20.0f - 1.0f;
+		const float quad[] = {
+			x,        y,        0.0f, 0.0f,
+			x + size, y,        1.0f, 0.0f,
+			x + size, y + size, 1.0f, 1.0f,
+			x,        y + size, 0.0f, 1.0f
+		};
+		vertices.insert(vertices.end(), quad, quad + 16);
+		const unsigned int base = q * 4;
+		const unsigned int quadIndices[] = { base, base + 1, base + 2, base + 2, base + 3, base };
+		indices.insert(indices.end(), quadIndices, quadIndices + 6);
+	}
+
+	QuadGeometry geometry;
+	geometry.VAO.reset(new VertexArray());
+	geometry.VBO.reset(new VertexBuffer(vertices.data(), (unsigned int)(vertices.size() * sizeof(float))));
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	layout.Push<float>(2);
+	geometry.VAO->AddBuffer(*geometry.VBO, layout);
+	geometry.IBO.reset(new IndexBuffer(indices.data(), (unsigned int)indices.size()));
+	return geometry;
+}
+
+BENCHMARK(DrawQueue)
+{
+	ShaderLibrary library("");
+	std::vector<std::shared_ptr<Shader>> programs;
+	for (unsigned int i = 0; i < s_Programs; i++) {
+		// Each define makes a separate program from the same source
+		programs.push_back(library.Load("assets/shaders/Material.shader.vert", "assets/shaders/Material.shader.frag", { "VARIANT " + std::to_string(i) }));
+		if (!programs.back())
+			return;
+	}
+
+	std::unique_ptr<UniformBuffer> frameUniforms = CreateFrameUniforms();
+
+	unsigned int textures[s_Textures];
+	GLCall(glGenTextures(s_Textures, textures));
+	for (unsigned int i = 0; i < s_Textures; i++) {
+		unsigned char pixels[4 * 4 * 4];
+		for (unsigned int p = 0; p < 16; p++) {
+			pixels[p * 4 + 0] = (unsigned char)(i * 16);
+			pixels[p * 4 + 1] = (unsigned char)(p * 16);
+			pixels[p * 4 + 2] = (unsigned char)(255 - i * 16);
+			pixels[p * 4 + 3] = 255;
+		}
+		GLState::BindTextureUnit(0, GL_TEXTURE_2D, textures[i]);
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	}
+
+	Material materials[s_Materials];
+	for (unsigned int i = 0; i < s_Materials; i++) {
+		materials[i].Program = programs[i % s_Programs].get();
+		materials[i].Texture = textures[i % s_Textures];
+		materials[i].Uniforms.Color[0] = (float)(i % 4) / 3.0f;
+		materials[i].Uniforms.Color[1] = (float)(i / 4 % 4) / 3.0f;
+		materials[i].Uniforms.Color[2] = 1.0f;
+		materials[i].Uniforms.Color[3] = i >= s_Materials - 4 ? 0.5f : 1.0f;
+		materials[i].Translucent = i >= s_Materials - 4;
+	}
+
+	std::vector<QuadGeometry> geometry;
+	for (unsigned int i = 0; i < s_VertexArrays; i++)
+		geometry.push_back(CreateQuads(i));
+
+	std::mt19937 random(1);
+	std::vector<QueuedDraw> draws(s_Draws);
+	for (QueuedDraw& draw : draws) {
+		draw.Geometry = random() % s_VertexArrays;
+		draw.Quad = random() % s_QuadsPerArray;
+		draw.Material = random() % s_Materials;
+		draw.Depth = (float)(random() % 1000) / 1000.0f;
+	}
+
+	Renderer renderer;
+	DrawQueue queue;
+	const char* names[] = { "submission order", "sorted" };
+	for (int sorted = 0; sorted < 2; sorted++) {
+		queue.ResetStats();
+		GLCall(glFinish());
+		Timer timer;
+		for (unsigned int f = 0; f < s_Frames; f++) {
+			for (const QueuedDraw& draw : draws) {
+				const QuadGeometry& quads = geometry[draw.Geometry];
+				queue.Submit(*quads.VAO, *quads.IBO, materials[draw.Material], draw.Depth, 0, 6, draw.Quad * 6);
+			}
+			queue.Flush(renderer, sorted != 0);
+		}
+		double submitMs = timer.ElapsedMilliseconds() / s_Frames;
+		GLCall(glFinish());
+		double frameMs = timer.ElapsedMilliseconds() / s_Frames;
+
+		const DrawQueue::Stats& stats = queue.GetStats();
+		const std::string name = names[sorted];
+		if (!sorted) {
+			Benchmark::Report("draws per frame", stats.Draws / s_Frames, "");
+			Benchmark::Report("submitted: program switches", stats.Submitted.Programs / s_Frames, "");
+			Benchmark::Report("submitted: vertex array switches", stats.Submitted.VertexArrays / s_Frames, "");
+			Benchmark::Report("submitted: texture switches", stats.Submitted.Textures / s_Frames, "");
+		}
+		else {
+			Benchmark::Report("sorted: program switches", stats.Issued.Programs / s_Frames, "");
+			Benchmark::Report("sorted: vertex array switches", stats.Issued.VertexArrays / s_Frames, "");
+			Benchmark::Report("sorted: texture switches", stats.Issued.Textures / s_Frames, "");
+			Benchmark::Report("sorted: radix sort per frame", stats.SortMilliseconds / s_Frames, "ms");
+		}
+		Benchmark::Report(name + ": draw calls per frame", stats.DrawCalls / s_Frames, "");
+		Benchmark::Report(name + ": CPU submit per frame", submitMs, "ms");
+		Benchmark::Report(name + ": frame incl. glFinish", frameMs, "ms");
+	}
+
+	GLCall(glDeleteTextures(s_Textures, textures));
+	for (unsigned int i = 0; i < s_Textures; i++)
+		GLState::OnTextureDeleted(textures[i]);
+}
@@ -0,0 +1,60 @@
+#include "Benchmark.h"
+#include "Renderer.h"
+
+// Per-call cost of every GLCall checking mode, measured around a stub GL
+// function so only the checking itself is timed. The last row shows what a
+// real glGetError costs on this driver, which the per-call mode pays twice.
+static volatile unsigned int s_StubCalls = 0;
+
+static void StubGLCall() {
+	s_StubCalls = s_StubCalls + 1;
+}
+
+static unsigned int StubGetError() {
+	return GL_NO_ERROR;
+}
+
+BENCHMARK(GLErrorCheckOverhead)
+{
+	const unsigned int calls = 10000000;
+
+	GLSetErrorSource(StubGetError);
+
+	Timer timer;
+	for (unsigned int i = 0; i < calls; i++) {
+		GLCALL_NONE(StubGLCall());
+	}
+	double noneMs = timer.ElapsedMilliseconds();
+
+	timer.Reset();
+	for (unsigned int i = 0; i < calls; i++) {
+		GLCALL_CALL(StubGLCall());
+	}
+	double callMs = timer.ElapsedMilliseconds();
+
+	timer.Reset();
+	for (unsigned int i = 0; i < calls; i++) {
+		GLCALL_DEFERRED(StubGLCall());
+	}
+	double deferredMs = timer.ElapsedMilliseconds();
+
+	timer.Reset();
+	for (unsigned int i = 0; i < calls; i++) {
+		GLCALL_DEBUG_OUTPUT(StubGLCall());
+	}
+	double debugOutputMs = timer.ElapsedMilliseconds();
+
+	GLSetErrorSource(nullptr);
+
+	const unsigned int driverCalls = 100000;
+	timer.Reset();
+	for (unsigned int i = 0; i < driverCalls; i++)
+		glGetError();
+	double driverMs = timer.ElapsedMilliseconds();
+
+	Benchmark::Report("none", noneMs * 1e6 / calls, "ns/call");
+	Benchmark::Report("per call (stub glGetError)", callMs * 1e6 / calls, "ns/call");
+	Benchmark::Report("deferred", deferredMs * 1e6 / calls, "ns/call");
+	Benchmark::Report("debug output", debugOutputMs * 1e6 / calls, "ns/call");
+	Benchmark::Report("driver glGetError", driverMs * 1e6 / driverCalls, "ns/call");
+}
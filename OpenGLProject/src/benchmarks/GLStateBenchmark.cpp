@@ -0,0 +1,219 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "GLState.h"
+#include "Renderer.h"
+
+// Replays the bind pattern of a scene with many draws against a counting
+// backend, so the filtering can be measured without touching the driver.
+static unsigned long long s_BackendCalls = 0;
+
+static void MockUseProgram(unsigned int) { s_BackendCalls++; }
+static void MockBindVertexArray(unsigned int) { s_BackendCalls++; }
+static void MockBindBuffer(unsigned int, unsigned int) { s_BackendCalls++; }
+static void MockBindBufferBase(unsigned int, unsigned int, unsigned int) { s_BackendCalls++; }
+static void MockActiveTexture(unsigned int) { s_BackendCalls++; }
+static void MockBindTexture(unsigned int, unsigned int) { s_BackendCalls++; }
+static void MockBindFramebuffer(unsigned int, unsigned int) { s_BackendCalls++; }
+static void MockEnable(unsigned int) { s_BackendCalls++; }
+static void MockDisable(unsigned int) { s_BackendCalls++; }
+static void MockBlendFunc(unsigned int, unsigned int) { s_BackendCalls++; }
+static void MockDepthFunc(unsigned int) { s_BackendCalls++; }
+static void MockDepthMask(unsigned char) { s_BackendCalls++; }
+static void MockViewport(int, int, int, int) { s_BackendCalls++; }
+
+static const GLBackend s_MockBackend = {
+	MockUseProgram,
+	MockBindVertexArray,
+	MockBindBuffer,
+	MockBindBufferBase,
+	MockActiveTexture,
+	MockBindTexture,
+	MockBindFramebuffer,
+	MockEnable,
+	MockDisable,
+	MockBlendFunc,
+	MockDepthFunc,
+	MockDepthMask,
+	MockViewport
+};
+
+BENCHMARK(GLStateFiltering)
+{
+	const unsigned int draws = 100000;
+	const unsigned int programs = 4, vertexArrays = 32, textures = 64;
+
+	GLState::SetBackend(&s_MockBackend);
+	GLState::ResetStats();
+	s_BackendCalls = 0;
+
+	Timer timer;
+	for (unsigned int i = 0; i < draws; i++) {
+		// Draws arrive grouped by material, the way a scene is usually traversed
+		GLState::Viewport(0, 0, 1000, 1000);
+		GLState::SetDepthTest(true);
+		GLState::SetBlend(false);
+		GLState::UseProgram(1 + i / 4096 % programs);
+		GLState::BindTextureUnit(0, GL_TEXTURE_2D, 1 + i / 64 % textures);
+		GLState::BindVertexArray(1 + i / 16 % vertexArrays);
+	}
+	double ms = timer.ElapsedMilliseconds();
+
+	const GLState::Stats& stats = GLState::GetStats();
+	Benchmark::Report("draws", draws, "");
+	Benchmark::Report("requested state calls", (double)(stats.Issued + stats.Skipped), "");
+	Benchmark::Report("issued", (double)stats.Issued, "");
+	Benchmark::Report("skipped", (double)stats.Skipped, "");
+	Benchmark::Report("backend calls", (double)s_BackendCalls, "");
+	Benchmark::Report("cache time", ms, "ms");
+
+	GLState::SetBackend(nullptr);
+	GLState::ResetStats();
+}
+
+// Records every call that reaches the backend so a sequence of binds can be
+// checked against exactly the calls GL has to see
+struct BackendCall
+{
+	const char* Name;
+	unsigned int A;
+	unsigned int B;
+
+	bool operator==(const BackendCall& other) const { return std::string(Name) == other.Name && A == other.A && B == other.B; }
+};
+
+static std::vector<BackendCall> s_RecordedCalls;
+
+static void RecordUseProgram(unsigned int program) { s_RecordedCalls.push_back({ "UseProgram", program, 0 }); }
+static void RecordBindVertexArray(unsigned int vertexArray) { s_RecordedCalls.push_back({ "BindVertexArray", vertexArray, 0 }); }
+static void RecordBindBuffer(unsigned int target, unsigned int buffer) { s_RecordedCalls.push_back({ "BindBuffer", target, buffer }); }
+static void RecordBindBufferBase(unsigned int, unsigned int index, unsigned int buffer) { s_RecordedCalls.push_back({ "BindBufferBase", index, buffer }); }
+static void RecordActiveTexture(unsigned int unit) { s_RecordedCalls.push_back({ "ActiveTexture", unit, 0 }); }
+static void RecordBindTexture(unsigned int target, unsigned int texture) { s_RecordedCalls.push_back({ "BindTexture", target, texture }); }
+static void RecordBindFramebuffer(unsigned int target, unsigned int framebuffer) { s_RecordedCalls.push_back({ "BindFramebuffer", target, framebuffer }); }
+static void RecordEnable(unsigned int capability) { s_RecordedCalls.push_back({ "Enable", capability, 0 }); }
+static void RecordDisable(unsigned int capability) { s_RecordedCalls.push_back({ "Disable", capability, 0 }); }
+static void RecordBlendFunc(unsigned int source, unsigned int destination) { s_RecordedCalls.push_back({ "BlendFunc", source, destination }); }
+static void RecordDepthFunc(unsigned int func) { s_RecordedCalls.push_back({ "DepthFunc", func, 0 }); }
+static void RecordDepthMask(unsigned char flag) { s_RecordedCalls.push_back({ "DepthMask", flag, 0 }); }
+static void RecordViewport(int, int, int width, int height) { s_RecordedCalls.push_back({ "Viewport", (unsigned int)width, (unsigned int)height }); }
+
+static const GLBackend s_RecordingBackend = {
+	RecordUseProgram,
+	RecordBindVertexArray,
+	RecordBindBuffer,
+	RecordBindBufferBase,
+	RecordActiveTexture,
+	RecordBindTexture,
+	RecordBindFramebuffer,
+	RecordEnable,
+	RecordDisable,
+	RecordBlendFunc,
+	RecordDepthFunc,
+	RecordDepthMask,
+	RecordViewport
+};
+
+static bool CheckCalls(const char* what, const std::vector<BackendCall>& expected)
+{
+	bool passed = s_RecordedCalls == expected;
+	if (!passed) {
+		std::cout << "  " << what << ": expected " << expected.size() << " calls, got" << std::endl;
+		for (const BackendCall& call : s_RecordedCalls)
+			std::cout << "    " << call.Name << " " << call.A << " " << call.B << std::endl;
+	}
+	s_RecordedCalls.clear();
+	return Benchmark::Check(what, passed);
+}
+
+// Not a measurement: checks that redundant calls are dropped and everything
+// else reaches the backend, in order
+BENCHMARK(GLStateCalls)
+{
+	GLState::SetBackend(&s_RecordingBackend);
+	s_RecordedCalls.clear();
+
+	GLState::UseProgram(1);
+	GLState::UseProgram(1);
+	GLState::UseProgram(2);
+	GLState::UseProgram(2);
+	CheckCalls("programs", { { "UseProgram", 1, 0 }, { "UseProgram", 2, 0 } });
+
+	GLState::BindTextureUnit(0, GL_TEXTURE_2D, 5);
+	GLState::BindTextureUnit(0, GL_TEXTURE_2D, 5);
+	GLState::BindTextureUnit(1, GL_TEXTURE_2D, 6);
+	// Unit 0 still has 5 even though unit 1 is active now
+	GLState::BindTextureUnit(0, GL_TEXTURE_2D, 5);
+	CheckCalls("texture units", {
+		{ "ActiveTexture", GL_TEXTURE0, 0 }, { "BindTexture", GL_TEXTURE_2D, 5 },
+		{ "ActiveTexture", GL_TEXTURE1, 0 }, { "BindTexture", GL_TEXTURE_2D, 6 } });
+
+	// Plain BindTexture follows the active unit
+	GLState::ActiveTexture(GL_TEXTURE0);
+	GLState::BindTexture(GL_TEXTURE_2D, 5);
+	GLState::BindTexture(GL_TEXTURE_2D, 6);
+	GLState::BindTextureUnit(1, GL_TEXTURE_2D, 6);
+	GLState::ActiveTexture(GL_TEXTURE0);
+	CheckCalls("active texture", { { "ActiveTexture", GL_TEXTURE0, 0 }, { "BindTexture", GL_TEXTURE_2D, 6 } });
+
+	// Deleting 6 unbinds it from both units; the name can come back as a new texture
+	GLState::OnTextureDeleted(6);
+	GLState::BindTextureUnit(0, GL_TEXTURE_2D, 0);
+	GLState::BindTextureUnit(1, GL_TEXTURE_2D, 6);
+	GLState::BindTextureUnit(0, GL_TEXTURE_2D, 6);
+	CheckCalls("deleted texture", {
+		{ "ActiveTexture", GL_TEXTURE1, 0 }, { "BindTexture", GL_TEXTURE_2D, 6 },
+		{ "ActiveTexture", GL_TEXTURE0, 0 }, { "BindTexture", GL_TEXTURE_2D, 6 } });
+
+	// The element array binding belongs to the vertex array
+	GLState::BindVertexArray(7);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 4);
+	GLState::BindVertexArray(7);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 4);
+	GLState::BindVertexArray(8);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 4);
+	CheckCalls("vertex arrays", {
+		{ "BindVertexArray", 7, 0 }, { "BindBuffer", GL_ELEMENT_ARRAY_BUFFER, 4 },
+		{ "BindVertexArray", 8, 0 }, { "BindBuffer", GL_ELEMENT_ARRAY_BUFFER, 4 } });
+
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 3);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 3);
+	GLState::OnBufferDeleted(3);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 3);
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, 0, 9);
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, 0, 9);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, 9);
+	CheckCalls("buffers", {
+		{ "BindBuffer", GL_ARRAY_BUFFER, 3 }, { "BindBuffer", GL_ARRAY_BUFFER, 3 }, { "BindBufferBase", 0, 9 } });
+
+	GLState::SetBlend(true);
+	GLState::SetBlend(true);
+	GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::SetBlend(false);
+	GLState::DepthMask(false);
+	GLState::DepthMask(false);
+	GLState::Viewport(0, 0, 640, 480);
+	GLState::Viewport(0, 0, 640, 480);
+	CheckCalls("fixed function", {
+		{ "Enable", GL_BLEND, 0 }, { "BlendFunc", GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA }, { "Disable", GL_BLEND, 0 },
+		{ "DepthMask", GL_FALSE, 0 }, { "Viewport", 640, 480 } });
+
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, 2);
+	GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 2);
+	GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, 2);
+	CheckCalls("framebuffers", {
+		{ "BindFramebuffer", GL_FRAMEBUFFER, 2 }, { "BindFramebuffer", GL_READ_FRAMEBUFFER, 0 }, { "BindFramebuffer", GL_FRAMEBUFFER, 2 } });
+
+	// After Invalidate() nothing is known, so everything goes through again
+	GLState::Invalidate();
+	GLState::UseProgram(2);
+	GLState::BindTextureUnit(0, GL_TEXTURE_2D, 6);
+	CheckCalls("invalidate", { { "UseProgram", 2, 0 }, { "ActiveTexture", GL_TEXTURE0, 0 }, { "BindTexture", GL_TEXTURE_2D, 6 } });
+
+	GLState::SetBackend(nullptr);
+	GLState::ResetStats();
+}
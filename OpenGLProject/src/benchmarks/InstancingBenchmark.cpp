@@ -0,0 +1,91 @@
+#include <vector>
+
+#include "Benchmark.h"
+#include "BenchmarkFixtures.h"
+#include "Renderer.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
+
+// CPU time per frame for drawing the same quad 100k times, once with a draw
+// call and two uniform updates per copy and once with a single instanced draw.
+struct InstanceData
+{
+	float Offset[2];
+	unsigned char Color[4];
+};
+
+BENCHMARK(Instancing)
+{
+	const unsigned int instances = 100000;
+	const unsigned int frames = 10;
+
+	ShaderLibrary library("");
+	std::shared_ptr<Shader> perDrawShader = library.Load("assets/shaders/Instanced.shader.vert", "assets/shaders/Instanced.shader.frag", { "PER_DRAW" });
+	std::shared_ptr<Shader> instancedShader = library.Load("assets/shaders/Instanced.shader.vert", "assets/shaders/Instanced.shader.frag");
+	if (!perDrawShader || !instancedShader)
+		return;
+
+	std::unique_ptr<UniformBuffer> frameUniforms = CreateFrameUniforms();
+
+	const float size = 0.004f;
+	const float positions[] = {
+		0.0f, 0.0f,
+		size, 0.0f,
+		size, size,
+		0.0f, size
+	};
+	const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+	VertexBufferLayout meshLayout;
+	meshLayout.Push<float>(2);
+	Mesh quad(positions, sizeof(positions), meshLayout, indices, 6);
+
+	std::vector<InstanceData> data(instances);
+	for (unsigned int i = 0; i < instances; i++) {
+		data[i].Offset[0] = (float)(i % 400) / 200.0f - 1.0f;
+		data[i].Offset[1] = (float)(i / 400) / 125.0f - 1.0f;
+		data[i].Color[0] = (unsigned char)(i * 7);
+		data[i].Color[1] = (unsigned char)(i * 13);
+		data[i].Color[2] = (unsigned char)(i * 29);
+		data[i].Color[3] = 255;
+	}
+	VertexBuffer instanceBuffer(data.data(), (unsigned int)(data.size() * sizeof(InstanceData)));
+	VertexBufferLayout instanceLayout;
+	instanceLayout.Push<float>(2);
+	instanceLayout.Push<unsigned char>(4);
+
+	Renderer renderer;
+
+	GLCall(glFinish());
+	Renderer::ResetStats();
+	Timer timer;
+	for (unsigned int f = 0; f < frames; f++) {
+		for (unsigned int i = 0; i < instances; i++) {
+			const InstanceData& instance = data[i];
+			perDrawShader->SetUniform2f("u_Offset", instance.Offset[0], instance.Offset[1]);
+			perDrawShader->SetUniform4f("u_Color", instance.Color[0] / 255.0f, instance.Color[1] / 255.0f, instance.Color[2] / 255.0f, 1.0f);
+			renderer.Draw(quad, *perDrawShader);
+		}
+	}
+	double perDrawSubmitMs = timer.ElapsedMilliseconds() / frames;
+	GLCall(glFinish());
+	double perDrawMs = timer.ElapsedMilliseconds() / frames;
+	unsigned int perDrawCalls = Renderer::GetStats().DrawCalls / frames;
+
+	Renderer::ResetStats();
+	timer.Reset();
+	for (unsigned int f = 0; f < frames; f++)
+		renderer.DrawInstanced(quad, instanceBuffer, instanceLayout, instances, *instancedShader);
+	double instancedSubmitMs = timer.ElapsedMilliseconds() / frames;
+	GLCall(glFinish());
+	double instancedMs = timer.ElapsedMilliseconds() / frames;
+	unsigned int instancedCalls = Renderer::GetStats().DrawCalls / frames;
+
+	Benchmark::Report("instances", instances, "");
+	Benchmark::Report("per draw: draw calls per frame", perDrawCalls, "");
+	Benchmark::Report("per draw: CPU submit per frame", perDrawSubmitMs, "ms");
+	Benchmark::Report("per draw: frame incl. glFinish", perDrawMs, "ms");
+	Benchmark::Report("instanced: draw calls per frame", instancedCalls, "");
+	Benchmark::Report("instanced: CPU submit per frame", instancedSubmitMs, "ms");
+	Benchmark::Report("instanced: frame incl. glFinish", instancedMs, "ms");
+}
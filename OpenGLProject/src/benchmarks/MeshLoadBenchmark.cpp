@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "Benchmark.h"
+#include "Renderer.h"
+#include "Mesh.h"
+#include "MeshFile.h"
+#include "ObjLoader.h"
+
+// Load time of a ~2M triangle grid from OBJ text against the mapped binary
+// .mesh, both up to a GPU-resident Mesh. The files are written right before
+// loading, so both reads come from the OS file cache.
+static void WriteGridObj(const std::string& filepath, unsigned int side) {
+	std::ofstream stream(filepath, std::ios::out | std::ios::trunc);
+	char line[128];
+	for (unsigned int y = 0; y < side; y++) {
+		for (unsigned int x = 0; x < side; x++) {
+			int length = snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\n", (float)x / side, (float)y / side, 0.0f, (float)x / side, (float)y / side);
+			stream.write(line, length);
+		}
+	}
+	stream << "vn 0 0 1\n";
+	for (unsigned int y = 0; y + 1 < side; y++) {
+		for (unsigned int x = 0; x + 1 < side; x++) {
+			unsigned int a = y * side + x + 1, b = a + 1, c = a + side + 1, d = a + side;
+			int length = snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1\nf %u/%u/1 %u/%u/1 %u/%u/1\n", a, a, b, b, c, c, c, c, d, d, a, a);
+			stream.write(line, length);
+		}
+	}
+}
+
+BENCHMARK(MeshLoad)
+{
+	const unsigned int side = 1025;
+	const std::string directory = "cache/benchmark_meshes";
+	const std::string objPath = directory + "/grid.obj";
+	const std::string meshPath = directory + "/grid.mesh";
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	WriteGridObj(objPath, side);
+
+	// Offline step, not part of the load budget
+	MeshData data;
+	if (!ObjLoader::Load(objPath, data) || !MeshFile::Write(meshPath, data))
+		return;
+
+	GLCall(glFinish());
+	Timer timer;
+	MeshData parsed;
+	ObjLoader::Load(objPath, parsed);
+	double parseMs = timer.ElapsedMilliseconds();
+	{
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		layout.Push<float>(3);
+		layout.Push<float>(2);
+		Mesh mesh(parsed.Vertices.data(), (unsigned int)parsed.Vertices.size(), layout, parsed.Indices.data(), (unsigned int)parsed.Indices.size());
+		GLCall(glFinish());
+	}
+	double textMs = timer.ElapsedMilliseconds();
+
+	timer.Reset();
+	{
+		std::unique_ptr<Mesh> mesh = Mesh::LoadFromFile(meshPath);
+		GLCall(glFinish());
+	}
+	double binaryMs = timer.ElapsedMilliseconds();
+
+	Benchmark::Report("triangles", (double)(data.Indices.size() / 3), "");
+	Benchmark::Report("OBJ file size", std::filesystem::file_size(objPath, error) / (1024.0 * 1024.0), "MiB");
+	Benchmark::Report(".mesh file size", std::filesystem::file_size(meshPath, error) / (1024.0 * 1024.0), "MiB");
+	Benchmark::Report("OBJ parse", parseMs, "ms");
+	Benchmark::Report("OBJ parse + upload", textMs, "ms");
+	Benchmark::Report("mapped .mesh + upload", binaryMs, "ms");
+
+	std::filesystem::remove_all(directory, error);
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BenchmarkFixtures.h"
+#include "Renderer.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "Shader.h"
+#include "ThreadPool.h"
+#include "UniformBuffer.h"
+
+// Vertex cache efficiency and GPU time of a grid whose triangles and vertices
+// were shuffled, before and after MeshOptimizer, plus the optimizer's own run
+// time on one thread and on the shared pool. 256x256 vertices keep the grid
+// within 16-bit indices.
+static MeshData CreateShuffledGrid(unsigned int side) {
+	MeshData mesh;
+	mesh.VertexStride = sizeof(float) * 8;
+	mesh.Attributes = {
+		{ GL_FLOAT, 3, 0, 0, 0, 0 },
+		{ GL_FLOAT, 3, 0, 0, 0, 12 },
+		{ GL_FLOAT, 2, 0, 0, 0, 24 }
+	};
+
+	std::mt19937 random(1234);
+	std::vector<uint32_t> vertexOrder(side * side);
+	for (uint32_t i = 0; i < vertexOrder.size(); i++)
+		vertexOrder[i] = i;
+	std::shuffle(vertexOrder.begin(), vertexOrder.end(), random);
+
+	mesh.Vertices.resize(vertexOrder.size() * mesh.VertexStride);
+	for (unsigned int y = 0; y < side; y++) {
+		for (unsigned int x = 0; x < side; x++) {
+			float u = (float)x / (side - 1), v = (float)y / (side - 1);
+			float vertex[8] = { u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, u, v };
+			memcpy(&mesh.Vertices[(size_t)vertexOrder[y * side + x] * mesh.VertexStride], vertex, sizeof(vertex));
+		}
+	}
+
+	std::vector<std::array<uint32_t, 3>> triangles;
+	for (unsigned int y = 0; y + 1 < side; y++) {
+		for (unsigned int x = 0; x + 1 < side; x++) {
+			uint32_t a = vertexOrder[y * side + x], b = vertexOrder[y * side + x + 1];
+			uint32_t c = vertexOrder[(y + 1) * side + x + 1], d = vertexOrder[(y + 1) * side + x];
+			triangles.push_back({ a, b, c });
+			triangles.push_back({ c, d, a });
+		}
+	}
+	std::shuffle(triangles.begin(), triangles.end(), random);
+	for (const std::array<uint32_t, 3>& triangle : triangles)
+		mesh.Indices.insert(mesh.Indices.end(), triangle.begin(), triangle.end());
+	return mesh;
+}
+
+static double MeasureDraw(const MeshData& data, const Shader& shader) {
+	const int repetitions = 50;
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	layout.Push<float>(3);
+	layout.Push<float>(2);
+	Mesh mesh(data.Vertices.data(), (unsigned int)data.Vertices.size(), layout, data.Indices.data(), (unsigned int)data.Indices.size());
+
+	Renderer renderer;
+	renderer.Draw(mesh, shader);
+	GLCall(glFinish());
+	Timer timer;
+	for (int i = 0; i < repetitions; i++)
+		renderer.Draw(mesh, shader);
+	GLCall(glFinish());
+	return timer.ElapsedMilliseconds() / repetitions;
+}
+
+BENCHMARK(MeshOptimizer)
+{
+	const MeshData input = CreateShuffledGrid(256);
+
+	MeshData serial = input;
+	MeshOptimizer::Report serialReport = MeshOptimizer::Optimize(serial, nullptr);
+	MeshData parallel = input;
+	MeshOptimizer::Report parallelReport = MeshOptimizer::Optimize(parallel, &ThreadPool::Get());
+
+	Benchmark::Report("triangles", (double)(input.Indices.size() / 3), "");
+	Benchmark::Report("ACMR before", serialReport.Before.ACMR, "");
+	Benchmark::Report("ACMR after", serialReport.After.ACMR, "");
+	Benchmark::Report("ATVR before", serialReport.Before.ATVR, "");
+	Benchmark::Report("ATVR after", serialReport.After.ATVR, "");
+	Benchmark::Report("optimize, 1 thread", serialReport.Milliseconds, "ms");
+	Benchmark::Report("optimize, pool", parallelReport.Milliseconds, "ms");
+	Benchmark::Report("pool threads", ThreadPool::Get().GetWorkerCount() + 1.0, "");
+	Benchmark::Report("index size", IndexBuffer::GetSizeOfType(IndexBuffer::SelectType(input.GetVertexCount() - 1)), "B");
+
+	ShaderLibrary library("");
+	std::shared_ptr<Shader> shader = library.Load("assets/shaders/FlatColor.shader.vert", "assets/shaders/FlatColor.shader.frag");
+	if (!shader)
+		return;
+	shader->SetUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+
+	std::unique_ptr<UniformBuffer> frameUniforms = CreateFrameUniforms();
+
+	Benchmark::Report("draw before", MeasureDraw(input, *shader), "ms");
+	Benchmark::Report("draw after", MeasureDraw(parallel, *shader), "ms");
+}
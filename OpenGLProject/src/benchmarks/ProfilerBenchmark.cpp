@@ -0,0 +1,48 @@
+#include "Benchmark.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+// Cost of a CPU scope with the profiler disabled and enabled, and of a GPU
+// scope (two timestamp queries) inside a profiled frame.
+static volatile unsigned int s_Work = 0;
+
+BENCHMARK(ProfilerOverhead)
+{
+	const unsigned int scopes = 1000000;
+	const unsigned int gpuScopes = 1000;
+
+	bool wasEnabled = Profiler::IsEnabled();
+	Profiler::SetEnabled(false);
+	Timer timer;
+	for (unsigned int i = 0; i < scopes; i++) {
+		PROFILE_SCOPE("Disabled");
+		s_Work = s_Work + 1;
+	}
+	double disabledMs = timer.ElapsedMilliseconds();
+
+	Profiler::SetEnabled(true);
+	timer.Reset();
+	for (unsigned int i = 0; i < scopes; i++) {
+		PROFILE_SCOPE("Enabled");
+		s_Work = s_Work + 1;
+	}
+	double enabledMs = timer.ElapsedMilliseconds();
+
+	double gpuMs = -1.0;
+	if (Profiler::InitGpu()) {
+		Profiler::BeginFrame();
+		timer.Reset();
+		for (unsigned int i = 0; i < gpuScopes; i++) {
+			PROFILE_GPU_SCOPE("GPU scope");
+		}
+		gpuMs = timer.ElapsedMilliseconds();
+		Profiler::EndFrame();
+		Profiler::ShutdownGpu();
+	}
+	Profiler::SetEnabled(wasEnabled);
+
+	Benchmark::Report("CPU scope, disabled", disabledMs * 1000000.0 / scopes, "ns");
+	Benchmark::Report("CPU scope, enabled", enabledMs * 1000000.0 / scopes, "ns");
+	if (gpuMs >= 0.0)
+		Benchmark::Report("GPU scope", gpuMs * 1000000.0 / gpuScopes, "ns");
+}
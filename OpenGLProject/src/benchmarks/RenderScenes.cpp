@@ -0,0 +1,415 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "RenderBenchmark.h"
+#include "BenchmarkFixtures.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "BatchRenderer.h"
+#include "BVH.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "Shader.h"
+#include "TextureAtlas.h"
+#include "ThreadPool.h"
+#include "UniformBuffer.h"
+#include "VertexBuffer.h"
+
+// Scenes of the headless benchmark (see RenderBenchmark.h), one per
+// bottleneck: driver overhead per draw call, fill rate, vertex throughput
+// per-frame buffer streaming, culling and texture atlases.
+
+static std::unique_ptr<Mesh> CreateQuad(float x0, float y0, float x1, float y1) {
+	const float positions[] = {
+		x0, y0,
+		x1, y0,
+		x1, y1,
+		x0, y1
+	};
+	const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	return std::make_unique<Mesh>(positions, sizeof(positions), layout, indices, 6);
+}
+
+// 10k small quads, each its own draw call with two uniform updates
+class DrawCallScene : public RenderScene {
+private:
+	static const unsigned int Columns = 100;
+	static const unsigned int Draws = Columns * Columns;
+
+	ShaderLibrary m_Library;
+	std::shared_ptr<Shader> m_Shader;
+	std::unique_ptr<Mesh> m_Quad;
+	std::unique_ptr<UniformBuffer> m_FrameUniforms;
+	Renderer m_Renderer;
+public:
+	bool Init(unsigned int, unsigned int) override
+	{
+		m_Shader = m_Library.Load("assets/shaders/Instanced.shader.vert", "assets/shaders/Instanced.shader.frag", { "PER_DRAW" });
+		if (!m_Shader)
+			return false;
+
+		float size = 2.0f / Columns * 0.8f;
+		m_Quad = CreateQuad(0.0f, 0.0f, size, size);
+		m_FrameUniforms = CreateFrameUniforms();
+		return true;
+	}
+
+	void Render(unsigned int frame) override
+	{
+		m_Renderer.Clear();
+		for (unsigned int i = 0; i < Draws; i++) {
+			unsigned int column = i % Columns, row = i / Columns;
+			unsigned int shade = (i + frame) % 64;
+			m_Shader->SetUniform2f("u_Offset", column * 2.0f / Columns - 1.0f, row * 2.0f / Columns - 1.0f);
+			m_Shader->SetUniform4f("u_Color", shade / 63.0f, (float)column / Columns, (float)row / Columns, 1.0f);
+			m_Renderer.Draw(*m_Quad, *m_Shader);
+		}
+	}
+};
+
+// Blended full screen layers, one draw each
+class FillRateScene : public RenderScene {
+private:
+	static const unsigned int Layers = 32;
+
+	ShaderLibrary m_Library;
+	std::shared_ptr<Shader> m_Shader;
+	std::unique_ptr<Mesh> m_Quad;
+	std::unique_ptr<UniformBuffer> m_FrameUniforms;
+	Renderer m_Renderer;
+public:
+	bool Init(unsigned int, unsigned int) override
+	{
+		m_Shader = m_Library.Load("assets/shaders/FlatColor.shader.vert", "assets/shaders/FlatColor.shader.frag");
+		if (!m_Shader)
+			return false;
+
+		m_Quad = CreateQuad(-1.0f, -1.0f, 1.0f, 1.0f);
+		m_FrameUniforms = CreateFrameUniforms();
+		return true;
+	}
+
+	void Render(unsigned int frame) override
+	{
+		m_Renderer.Clear();
+		GLState::SetBlend(true);
+		GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		for (unsigned int layer = 0; layer < Layers; layer++) {
+			float phase = (float)((layer * 7 + frame) % Layers) / Layers;
+			m_Shader->SetUniform4f("u_Color", phase, 1.0f - phase, 0.5f, 0.1f);
+			m_Renderer.Draw(*m_Quad, *m_Shader);
+		}
+		GLState::SetBlend(false);
+	}
+};
+
+// A finely tessellated, optimized grid drawn several times; most triangles
+// are smaller than a pixel so vertex processing dominates
+class VertexThroughputScene : public RenderScene {
+private:
+	static const unsigned int Side = 512;
+	static const unsigned int Copies = 4;
+
+	ShaderLibrary m_Library;
+	std::shared_ptr<Shader> m_Shader;
+	std::unique_ptr<Mesh> m_Grid;
+	std::unique_ptr<UniformBuffer> m_FrameUniforms;
+	Renderer m_Renderer;
+public:
+	bool Init(unsigned int, unsigned int) override
+	{
+		m_Shader = m_Library.Load("assets/shaders/FlatColor.shader.vert", "assets/shaders/FlatColor.shader.frag");
+		if (!m_Shader)
+			return false;
+
+		MeshData grid;
+		grid.VertexStride = sizeof(float) * 3;
+		grid.Attributes = { { GL_FLOAT, 3, 0, 0, 0, 0 } };
+		grid.Vertices.resize((size_t)Side * Side * grid.VertexStride);
+		float* position = (float*)grid.Vertices.data();
+		for (unsigned int y = 0; y < Side; y++) {
+			for (unsigned int x = 0; x < Side; x++) {
+				*position++ = (float)x / (Side - 1) * 1.6f - 0.8f;
+				*position++ = (float)y / (Side - 1) * 1.6f - 0.8f;
+				*position++ = 0.0f;
+			}
+		}
+		for (unsigned int y = 0; y + 1 < Side; y++) {
+			for (unsigned int x = 0; x + 1 < Side; x++) {
+				uint32_t a = y * Side + x, b = a + 1, c = a + Side + 1, d = a + Side;
+				grid.Indices.insert(grid.Indices.end(), { a, b, c, c, d, a });
+			}
+		}
+		MeshOptimizer::Optimize(grid, &ThreadPool::Get());
+
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		m_Grid = std::make_unique<Mesh>(grid.Vertices.data(), (unsigned int)grid.Vertices.size(), layout,
+			grid.Indices.data(), (unsigned int)grid.Indices.size());
+		m_FrameUniforms = CreateFrameUniforms();
+		return true;
+	}
+
+	void Render(unsigned int frame) override
+	{
+		FrameUniforms uniforms = {};
+		float angle = frame * 0.01f;
+		uniforms.ViewProjection[0] = uniforms.ViewProjection[5] = std::cos(angle);
+		uniforms.ViewProjection[1] = std::sin(angle);
+		uniforms.ViewProjection[4] = -std::sin(angle);
+		uniforms.ViewProjection[10] = uniforms.ViewProjection[15] = 1.0f;
+		m_FrameUniforms->SetData(&uniforms, sizeof(uniforms));
+
+		m_Renderer.Clear();
+		for (unsigned int i = 0; i < Copies; i++) {
+			m_Shader->SetUniform4f("u_Color", 0.2f + 0.2f * i, 0.8f, 1.0f - 0.2f * i, 1.0f);
+			m_Renderer.Draw(*m_Grid, *m_Shader);
+		}
+	}
+};
+
+// 100k animated quads regenerated and uploaded through the BatchRenderer
+// every frame
+class BufferStreamingScene : public RenderScene {
+private:
+	static const unsigned int Quads = 100000;
+	static const unsigned int Columns = 400;
+
+	ShaderLibrary m_Library;
+	std::shared_ptr<Shader> m_Shader;
+	std::unique_ptr<BatchRenderer> m_Batch;
+	std::unique_ptr<UniformBuffer> m_FrameUniforms;
+	Renderer m_Renderer;
+public:
+	bool Init(unsigned int, unsigned int) override
+	{
+		m_Shader = m_Library.Load("assets/shaders/Batch.shader.vert", "assets/shaders/Batch.shader.frag");
+		if (!m_Shader)
+			return false;
+
+		int slots[BatchRenderer::MaxTextureSlots];
+		for (int i = 0; i < (int)BatchRenderer::MaxTextureSlots; i++)
+			slots[i] = i;
+		m_Shader->SetUniform1iv("u_Textures", BatchRenderer::MaxTextureSlots, slots);
+
+		m_Batch = std::make_unique<BatchRenderer>(20000);
+		m_FrameUniforms = CreateFrameUniforms();
+		return true;
+	}
+
+	void Render(unsigned int frame) override
+	{
+		const float size = 2.0f / Columns;
+		m_Renderer.Clear();
+		m_Shader->Bind();
+		m_Batch->Begin();
+		for (unsigned int i = 0; i < Quads; i++) {
+			float wave = std::sin(frame * 0.05f + i * 0.01f);
+			float x = (i % Columns) * size - 1.0f + wave * size;
+			float y = (i / Columns) * size * 2.0f - 1.0f;
+			float color[4] = { 0.5f + 0.5f * wave, (float)(i % Columns) / Columns, 0.5f, 1.0f };
+			m_Batch->DrawQuad(x, y, 0.0f, size * 0.8f, size * 1.6f, color);
+		}
+		m_Batch->End();
+	}
+};
+
+// 200k quads spread over an area about 40 times the view, 1% of them moving
+// every frame. The BVH is refitted for the moved ones and culled against the
+// panning camera; only the visible quads go into the instance buffer.
+class CullingScene : public RenderScene {
+private:
+	static const unsigned int Objects = 200000;
+	static const unsigned int MovedPerFrame = Objects / 100;
+	static constexpr float WorldSize = 100.0f;
+	static constexpr float QuadSize = 0.06f;
+
+	struct Instance
+	{
+		float Offset[2];
+		unsigned char Color[4];
+	};
+
+	ShaderLibrary m_Library;
+	std::shared_ptr<Shader> m_Shader;
+	std::unique_ptr<Mesh> m_Quad;
+	std::unique_ptr<UniformBuffer> m_FrameUniforms;
+	std::unique_ptr<VertexBuffer> m_InstanceBuffer;
+	VertexBufferLayout m_InstanceLayout;
+	Renderer m_Renderer;
+	float m_Aspect = 1.0f;
+
+	std::vector<Vec2> m_Origins;
+	BoundsArrays m_Bounds;
+	BVH m_BVH;
+	// The objects moved last frame, then the ones moved this frame
+	std::vector<uint32_t> m_Moved;
+	std::vector<uint32_t> m_Visible;
+	std::vector<Instance> m_Instances;
+
+	void SetBounds(unsigned int object, const Vec2& position)
+	{
+		const float half = QuadSize * 0.5f;
+		m_Bounds.Set(object, Vec3(position.x + half, position.y + half, 0.0f), Vec3(half, half, 0.0f));
+	}
+public:
+	bool Init(unsigned int width, unsigned int height) override
+	{
+		m_Shader = m_Library.Load("assets/shaders/Instanced.shader.vert", "assets/shaders/Instanced.shader.frag");
+		if (!m_Shader)
+			return false;
+
+		m_Aspect = (float)width / height;
+		m_Quad = CreateQuad(0.0f, 0.0f, QuadSize, QuadSize);
+		m_FrameUniforms = CreateFrameUniforms();
+		m_InstanceBuffer = std::make_unique<VertexBuffer>((unsigned int)(Objects * sizeof(Instance)));
+		m_InstanceLayout.Push<float>(2);
+		m_InstanceLayout.Push<unsigned char>(4);
+
+		// A fixed hash instead of <random> so every platform gets the same scene
+		m_Origins.resize(Objects);
+		m_Bounds.Resize(Objects);
+		for (unsigned int i = 0; i < Objects; i++) {
+			uint32_t hash = i * 2654435761u;
+			float x = (float)(hash & 0xFFFF) / 0xFFFF;
+			float y = (float)(hash >> 16) / 0xFFFF;
+			m_Origins[i] = Vec2((x - 0.5f) * WorldSize, (y - 0.5f) * WorldSize);
+			SetBounds(i, m_Origins[i]);
+		}
+		m_BVH.Build(m_Bounds);
+		m_Moved.resize(MovedPerFrame * 2);
+		m_Instances.reserve(Objects);
+		return true;
+	}
+
+	void Render(unsigned int frame) override
+	{
+		// The objects moved last frame go back to their origin first, so that
+		// what is drawn only depends on frame and not on the frames before it
+		for (unsigned int i = 0; i < MovedPerFrame; i++) {
+			m_Moved[i] = m_Moved[MovedPerFrame + i];
+			SetBounds(m_Moved[i], m_Origins[m_Moved[i]]);
+		}
+		for (unsigned int i = 0; i < MovedPerFrame; i++) {
+			unsigned int object = (frame * MovedPerFrame + i) % Objects;
+			const Vec2& origin = m_Origins[object];
+			float phase = frame * 0.05f + object;
+			SetBounds(object, Vec2(origin.x + std::sin(phase) * 0.5f, origin.y + std::cos(phase) * 0.5f));
+			m_Moved[MovedPerFrame + i] = object;
+		}
+		m_BVH.Refit(m_Bounds, m_Moved.data(), m_Moved.size());
+
+		const float halfHeight = 8.0f;
+		float cameraX = std::sin(frame * 0.01f) * WorldSize * 0.3f;
+		float cameraY = std::cos(frame * 0.007f) * WorldSize * 0.2f;
+		Mat4 viewProjection = Mat4::Orthographic(cameraX - halfHeight * m_Aspect, cameraX + halfHeight * m_Aspect,
+			cameraY - halfHeight, cameraY + halfHeight, -1.0f, 1.0f);
+		m_BVH.Cull(Frustum::FromViewProjection(viewProjection), m_Visible, &ThreadPool::Get());
+
+		m_Instances.clear();
+		for (uint32_t object : m_Visible) {
+			Instance instance;
+			instance.Offset[0] = m_Bounds.CenterX[object] - QuadSize * 0.5f;
+			instance.Offset[1] = m_Bounds.CenterY[object] - QuadSize * 0.5f;
+			instance.Color[0] = (unsigned char)(object * 7);
+			instance.Color[1] = (unsigned char)(object * 13);
+			instance.Color[2] = (unsigned char)(object * 29);
+			instance.Color[3] = 255;
+			m_Instances.push_back(instance);
+		}
+
+		FrameUniforms uniforms = {};
+		memcpy(uniforms.ViewProjection, viewProjection.Data(), sizeof(uniforms.ViewProjection));
+		m_FrameUniforms->SetData(&uniforms, sizeof(uniforms));
+
+		m_Renderer.Clear();
+		if (m_Instances.empty())
+			return;
+		m_InstanceBuffer->SetData(m_Instances.data(), (unsigned int)(m_Instances.size() * sizeof(Instance)));
+		m_Renderer.DrawInstanced(*m_Quad, *m_InstanceBuffer, m_InstanceLayout, (unsigned int)m_Instances.size(), *m_Shader);
+	}
+};
+
+// 20k textured quads drawn from 500 small images. The images share a few
+// atlas pages, so the whole frame stays in one batch.
+class TextureAtlasScene : public RenderScene {
+private:
+	static const unsigned int Images = 500;
+	static const unsigned int Quads = 20000;
+	static const unsigned int Columns = 200;
+
+	ShaderLibrary m_Library;
+	std::shared_ptr<Shader> m_Shader;
+	std::unique_ptr<TextureAtlas> m_Atlas;
+	std::unique_ptr<BatchRenderer> m_Batch;
+	std::unique_ptr<UniformBuffer> m_FrameUniforms;
+	Renderer m_Renderer;
+public:
+	bool Init(unsigned int, unsigned int) override
+	{
+		m_Shader = m_Library.Load("assets/shaders/Batch.shader.vert", "assets/shaders/Batch.shader.frag");
+		if (!m_Shader)
+			return false;
+
+		int slots[BatchRenderer::MaxTextureSlots];
+		for (int i = 0; i < (int)BatchRenderer::MaxTextureSlots; i++)
+			slots[i] = i;
+		m_Shader->SetUniform1iv("u_Textures", BatchRenderer::MaxTextureSlots, slots);
+
+		// Rings and stripes of 12 to 75 pixels from a hash. The atlas has no
+		// mip levels: how minified quads pick and blend levels is up to the
+		// driver, and the golden image has to hold on all of them.
+		m_Atlas = std::make_unique<TextureAtlas>(1024, 4, 1);
+		for (unsigned int i = 0; i < Images; i++) {
+			uint32_t hash = (i + 1) * 2654435761u;
+			Image image;
+			image.Width = 12 + (hash & 63);
+			image.Height = 12 + ((hash >> 8) & 63);
+			image.Pixels.resize((size_t)image.Width * image.Height * 4);
+			unsigned char* pixel = image.Pixels.data();
+			for (unsigned int y = 0; y < image.Height; y++) {
+				for (unsigned int x = 0; x < image.Width; x++) {
+					int dx = (int)x - (int)image.Width / 2, dy = (int)y - (int)image.Height / 2;
+					bool ring = ((dx * dx + dy * dy) / 16) & 1;
+					*pixel++ = (unsigned char)(hash >> 16);
+					*pixel++ = ring ? 255 : (unsigned char)(x * 255 / image.Width);
+					*pixel++ = (unsigned char)(hash >> 24);
+					*pixel++ = 255;
+				}
+			}
+			m_Atlas->Add(std::move(image));
+		}
+		if (!m_Atlas->Build())
+			return false;
+
+		m_Batch = std::make_unique<BatchRenderer>(Quads);
+		m_FrameUniforms = CreateFrameUniforms();
+		return true;
+	}
+
+	void Render(unsigned int frame) override
+	{
+		const float size = 2.0f / Columns;
+		const float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		m_Renderer.Clear();
+		m_Shader->Bind();
+		m_Batch->Begin();
+		for (unsigned int i = 0; i < Quads; i++) {
+			const TextureAtlas::Region& region = m_Atlas->GetRegion((i + frame) % Images);
+			float x = (i % Columns) * size - 1.0f;
+			float y = (i / Columns) * size * 2.0f - 1.0f;
+			m_Batch->DrawQuad(x, y, 0.0f, size, size * 2.0f, m_Atlas->GetPage(region.Page).GetRendererID(), region.TexCoords, white);
+		}
+		m_Batch->End();
+	}
+};
+
+RENDER_SCENE(DrawCalls, DrawCallScene);
+RENDER_SCENE(FillRate, FillRateScene);
+RENDER_SCENE(VertexThroughput, VertexThroughputScene);
+RENDER_SCENE(BufferStreaming, BufferStreamingScene);
+RENDER_SCENE(Culling, CullingScene);
+RENDER_SCENE(TextureAtlas, TextureAtlasScene);
@@ -0,0 +1,137 @@
+#include <cmath>
+#include <vector>
+
+#include <SDL.h>
+
+#include "Benchmark.h"
+#include "BenchmarkFixtures.h"
+#include "Renderer.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
+#include "RenderThread.h"
+#include "ThreadPool.h"
+
+// Frame time of a loop that simulates 4096 objects and draws each with two
+// uniform updates: everything on one thread, replay and swap on the render
+// thread, and the same with the simulation and recording split across the
+// thread pool. Swapping runs without vsync for the duration.
+static const unsigned int s_Objects = 4096;
+static const unsigned int s_Frames = 120;
+static const unsigned int s_SimulationSteps = 64;
+
+struct SimulatedObject
+{
+	float Position[2];
+	float Velocity[2];
+	float Color[4];
+};
+
+static void Simulate(SimulatedObject& object, float dt) {
+	// A damped spring towards the origin, integrated in small steps so
+	// simulating costs about as much as recording
+	for (unsigned int step = 0; step < s_SimulationSteps; step++) {
+		for (int axis = 0; axis < 2; axis++) {
+			float acceleration = -4.0f * object.Position[axis] - 0.1f * object.Velocity[axis];
+			object.Velocity[axis] += acceleration * dt;
+			object.Position[axis] += object.Velocity[axis] * dt;
+		}
+	}
+	object.Color[0] = 0.5f + 0.5f * std::sin(object.Position[0] * 8.0f);
+	object.Color[1] = 0.5f + 0.5f * std::sin(object.Position[1] * 8.0f);
+}
+
+static void Record(CommandBuffer& commands, std::vector<SimulatedObject>& objects, size_t begin, size_t end, Mesh& quad, Shader& shader) {
+	for (size_t i = begin; i < end; i++) {
+		SimulatedObject& object = objects[i];
+		Simulate(object, 1.0f / (60.0f * s_SimulationSteps));
+		commands.SetUniform2f(shader, "u_Offset", object.Position[0], object.Position[1]);
+		commands.SetUniform4f(shader, "u_Color", object.Color[0], object.Color[1], object.Color[2], object.Color[3]);
+		commands.Draw(quad, shader);
+	}
+}
+
+BENCHMARK(RenderThread)
+{
+	SDL_Window* window = SDL_GL_GetCurrentWindow();
+	SDL_GLContext context = SDL_GL_GetCurrentContext();
+	ShaderLibrary library("");
+	std::shared_ptr<Shader> shader = library.Load("assets/shaders/Instanced.shader.vert", "assets/shaders/Instanced.shader.frag", { "PER_DRAW" });
+	if (!shader)
+		return;
+
+	FrameUniforms frame = CreateIdentityFrame();
+	std::unique_ptr<UniformBuffer> frameUniforms = CreateFrameUniforms();
+
+	const float size = 0.01f;
+	const float positions[] = {
+		0.0f, 0.0f,
+		size, 0.0f,
+		size, size,
+		0.0f, size
+	};
+	const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	Mesh quad(positions, sizeof(positions), layout, indices, 6);
+
+	int swapInterval = SDL_GL_GetSwapInterval();
+	SDL_GL_SetSwapInterval(0);
+
+	std::vector<SimulatedObject> objects(s_Objects);
+	ThreadPool& pool = ThreadPool::Get();
+	const size_t grainSize = 256;
+	size_t commandBytes = 0;
+
+	const char* names[] = { "single thread", "render thread", "render thread + parallel recording" };
+	for (int mode = 0; mode < 3; mode++) {
+		for (unsigned int i = 0; i < s_Objects; i++) {
+			SimulatedObject& object = objects[i];
+			object.Position[0] = (float)(i % 64) / 32.0f - 1.0f;
+			object.Position[1] = (float)(i / 64) / 32.0f - 1.0f;
+			object.Velocity[0] = object.Velocity[1] = 0.0f;
+			object.Color[2] = object.Color[3] = 1.0f;
+		}
+
+		GLCall(glFinish());
+		Timer timer;
+		RenderThread::Stats stats;
+		{
+			RenderThread renderThread(window, context, mode != 0);
+			for (unsigned int f = 0; f < s_Frames; f++) {
+				RenderFrame& renderFrame = renderThread.BeginFrame();
+				frame.Time = f / 60.0f;
+				renderFrame.GetCommandBuffer().SetUniformBufferData(*frameUniforms, &frame, sizeof(frame));
+				renderFrame.GetCommandBuffer().Clear();
+
+				if (mode == 2) {
+					// Buffer 0 keeps the frame setup, chunk n records into buffer n + 1
+					unsigned int chunks = (unsigned int)((s_Objects + grainSize - 1) / grainSize);
+					renderFrame.SetCommandBufferCount(chunks + 1);
+					pool.ParallelFor(s_Objects, grainSize, [&](size_t begin, size_t end) {
+						Record(renderFrame.GetCommandBuffer((unsigned int)(begin / grainSize) + 1), objects, begin, end, quad, *shader);
+					});
+				}
+				else {
+					Record(renderFrame.GetCommandBuffer(), objects, 0, s_Objects, quad, *shader);
+				}
+
+				commandBytes = renderFrame.GetBytesUsed();
+				renderThread.Submit();
+			}
+			renderThread.Flush();
+			stats = renderThread.GetStats();
+		}
+		GLCall(glFinish());
+		double frameMs = timer.ElapsedMilliseconds() / s_Frames;
+
+		Benchmark::Report(std::string(names[mode]) + ": frame", frameMs, "ms");
+		if (mode != 0)
+			Benchmark::Report(std::string(names[mode]) + ": waiting for the render thread", stats.StallMilliseconds / s_Frames, "ms");
+	}
+
+	Benchmark::Report("command memory per frame", commandBytes / 1024.0, "KB");
+	Benchmark::Report("pool threads", pool.GetWorkerCount() + 1.0, "");
+
+	SDL_GL_SetSwapInterval(swapInterval);
+}
@@ -0,0 +1,42 @@
+#include <filesystem>
+
+#include "Benchmark.h"
+#include "Shader.h"
+
+// Builds a set of shader variants with an empty cache, then again from the
+// binary cache the first pass produced.
+BENCHMARK(ShaderStartup)
+{
+	const unsigned int variants = 64;
+	const std::string cacheDirectory = "cache/benchmark_shaders";
+
+	std::error_code error;
+	std::filesystem::remove_all(cacheDirectory, error);
+
+	double totals[2] = { 0.0, 0.0 };
+	unsigned int fromCache[2] = { 0, 0 };
+	for (int pass = 0; pass < 2; pass++) {
+		ShaderLibrary library(cacheDirectory);
+		if (pass == 0 && !library.IsBinaryCacheSupported())
+			Benchmark::Report("program binaries unsupported, warm = cold", 0, "");
+
+		Timer timer;
+		for (unsigned int i = 0; i < variants; i++) {
+			std::vector<std::string> defines = { "VARIANT " + std::to_string(i) };
+			library.Load("assets/shaders/Batch.shader.vert", "assets/shaders/Batch.shader.frag", defines);
+		}
+		totals[pass] = timer.ElapsedMilliseconds();
+
+		for (const ShaderLibrary::LoadTiming& timing : library.GetLoadTimings())
+			fromCache[pass] += timing.FromBinaryCache ? 1 : 0;
+	}
+
+	std::filesystem::remove_all(cacheDirectory, error);
+
+	Benchmark::Report("variants", variants, "");
+	Benchmark::Report("cold total", totals[0], "ms");
+	Benchmark::Report("cold per program", totals[0] / variants, "ms");
+	Benchmark::Report("warm total", totals[1], "ms");
+	Benchmark::Report("warm per program", totals[1] / variants, "ms");
+	Benchmark::Report("warm loaded from binary cache", fromCache[1], "");
+}
@@ -0,0 +1,116 @@
+#include <cstring>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BenchmarkFixtures.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
+#include "StreamingBuffer.h"
+#include "VertexArray.h"
+
+// Regenerates a point cloud every frame and draws it, once through each
+// StreamingBuffer mode and once through VertexBuffer::SetData for reference.
+// Each mode then wraps around its regions a few more times with every frame
+// read back after its draw, which has to give exactly what was written.
+static const unsigned int s_Frames = 240;
+static const unsigned int s_Points = 131072;
+
+static void GeneratePoints(float* out, unsigned int frame) {
+	for (unsigned int i = 0; i < s_Points; i++) {
+		out[i * 2 + 0] = (float)((i * 7 + frame) % 1024) / 512.0f - 1.0f;
+		out[i * 2 + 1] = (float)((i / 1024 + frame) % 1024) / 512.0f - 1.0f;
+	}
+}
+
+BENCHMARK(StreamingBufferModes)
+{
+	ShaderLibrary library("");
+	std::shared_ptr<Shader> shader = library.Load("assets/shaders/FlatColor.shader.vert", "assets/shaders/FlatColor.shader.frag");
+	if (!shader)
+		return;
+	shader->Bind();
+	shader->SetUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+
+	std::unique_ptr<UniformBuffer> frameUniforms = CreateFrameUniforms();
+
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	const unsigned int frameSize = s_Points * 2 * sizeof(float);
+
+	{
+		std::vector<float> points(s_Points * 2);
+		VertexBuffer vbo(frameSize);
+		VertexArray vao;
+		vao.AddBuffer(vbo, layout);
+
+		GLCall(glFinish());
+		Timer timer;
+		for (unsigned int i = 0; i < s_Frames; i++) {
+			GeneratePoints(points.data(), i);
+			vbo.SetData(points.data(), frameSize);
+			vao.Bind();
+			GLCall(glDrawArrays(GL_POINTS, 0, s_Points));
+		}
+		GLCall(glFinish());
+		Benchmark::Report("glBufferSubData per frame", timer.ElapsedMilliseconds() / s_Frames, "ms");
+	}
+
+	const StreamingBuffer::Mode modes[] = { StreamingBuffer::Mode::Persistent, StreamingBuffer::Mode::Unsynchronized, StreamingBuffer::Mode::Orphaning };
+	const char* names[] = { "persistent", "unsynchronized", "orphaning" };
+	for (int m = 0; m < 3; m++) {
+		StreamingBuffer buffer(GL_ARRAY_BUFFER, frameSize, 3, modes[m]);
+		if (buffer.GetMode() != modes[m]) {
+			Benchmark::Report(std::string(names[m]) + " unsupported", 0, "");
+			continue;
+		}
+
+		VertexArray vao;
+		vao.AddBuffer(buffer, layout);
+
+		GLCall(glFinish());
+		Timer timer;
+		for (unsigned int i = 0; i < s_Frames; i++) {
+			buffer.BeginFrame();
+			unsigned int offset = 0;
+			float* points = (float*)buffer.Map(frameSize, offset, 2 * sizeof(float));
+			ASSERT(points);
+			GeneratePoints(points, i);
+			buffer.Unmap();
+
+			vao.Bind();
+			GLCall(glDrawArrays(GL_POINTS, offset / (2 * sizeof(float)), s_Points));
+			buffer.EndFrame();
+		}
+		GLCall(glFinish());
+		double ms = timer.ElapsedMilliseconds();
+
+		const StreamingBuffer::Stats& stats = buffer.GetStats();
+		std::string prefix = names[m];
+		Benchmark::Report(prefix + " per frame", ms / s_Frames, "ms");
+		Benchmark::Report(prefix + " streamed per frame", stats.BytesStreamed / (1024.0 * 1024.0) / s_Frames, "MiB");
+		Benchmark::Report(prefix + " fence stalls", stats.Stalls, "");
+		Benchmark::Report(prefix + " fence stall time", stats.StallMilliseconds, "ms");
+
+		std::vector<float> expected(s_Points * 2), actual(s_Points * 2);
+		bool matches = true;
+		for (unsigned int i = s_Frames; i < s_Frames + 3 * 2 + 1; i++) {
+			buffer.BeginFrame();
+			unsigned int offset = 0;
+			float* points = (float*)buffer.Map(frameSize, offset, 2 * sizeof(float));
+			ASSERT(points);
+			GeneratePoints(points, i);
+			buffer.Unmap();
+
+			vao.Bind();
+			GLCall(glDrawArrays(GL_POINTS, offset / (2 * sizeof(float)), s_Points));
+			buffer.Bind();
+			GLCall(glGetBufferSubData(GL_ARRAY_BUFFER, offset, frameSize, actual.data()));
+			buffer.EndFrame();
+
+			GeneratePoints(expected.data(), i);
+			matches = matches && memcmp(expected.data(), actual.data(), frameSize) == 0;
+		}
+		Benchmark::Check(prefix + " contents after wrap-around", matches);
+	}
+}
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BatchRenderer.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
+#include "ThreadPool.h"
+
+static Image CreatePattern(unsigned int width, unsigned int height, unsigned int seed) {
+	Image image;
+	image.Width = width;
+	image.Height = height;
+	image.Pixels.resize((size_t)width * height * 4);
+	unsigned char* pixel = image.Pixels.data();
+	for (unsigned int y = 0; y < height; y++) {
+		for (unsigned int x = 0; x < width; x++) {
+			bool checker = ((x / 8) ^ (y / 8)) & 1;
+			*pixel++ = (unsigned char)(seed * 37 + x);
+			*pixel++ = (unsigned char)(seed * 91 + y);
+			*pixel++ = checker ? 255 : 64;
+			*pixel++ = 255;
+		}
+	}
+	return image;
+}
+
+static bool SameTextureData(const TextureData& a, const TextureData& b)
+{
+	if (a.Format != b.Format || a.Width != b.Width || a.Height != b.Height || a.Levels.size() != b.Levels.size())
+		return false;
+	for (unsigned int level = 0; level < a.Levels.size(); level++) {
+		const TextureData::Level& levelA = a.Levels[level];
+		const TextureData::Level& levelB = b.Levels[level];
+		if (levelA.Width != levelB.Width || levelA.Height != levelB.Height || levelA.Size != levelB.Size ||
+			memcmp(a.GetLevelData(level), b.GetLevelData(level), levelA.Size) != 0)
+			return false;
+	}
+	return true;
+}
+
+// Reads every level back from GL and compares it with data
+static bool TexelsMatch(const Texture& texture, const TextureData& data)
+{
+	if (texture.GetLevelCount() != data.Levels.size())
+		return false;
+
+	texture.Bind();
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	std::vector<unsigned char> texels;
+	for (unsigned int level = 0; level < data.Levels.size(); level++) {
+		texels.assign(data.Levels[level].Size, 0);
+		if (IsCompressed(data.Format)) {
+			GLCall(glGetCompressedTexImage(GL_TEXTURE_2D, level, texels.data()));
+		}
+		else {
+			GLCall(glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, texels.data()));
+		}
+		if (memcmp(texels.data(), data.GetLevelData(level), texels.size()) != 0)
+			return false;
+	}
+	return true;
+}
+
+// 2000 images of 8 to 96 pixels a side, packed into atlas pages, then drawn
+// as quads through the BatchRenderer once from their own textures and once
+// from the atlas. No program is bound; the point is how often the batch has
+// to flush for running out of texture slots.
+BENCHMARK(TextureAtlas)
+{
+	const unsigned int imageCount = 2000;
+	std::mt19937 random(5);
+	std::uniform_int_distribution<unsigned int> size(8, 96);
+	std::vector<Image> images(imageCount);
+	for (unsigned int i = 0; i < imageCount; i++)
+		images[i] = CreatePattern(size(random), size(random), i);
+
+	TextureAtlas atlas(2048, 4, 3);
+	Timer timer;
+	for (const Image& image : images)
+		atlas.Add(image);
+	atlas.Build();
+	Benchmark::Report("pack and upload", timer.ElapsedMilliseconds(), "ms");
+	Benchmark::Report("pages", atlas.GetPageCount(), "");
+	Benchmark::Report("occupancy", atlas.GetOccupancy() * 100.0, "%");
+	Benchmark::Report("atlas texture memory", atlas.GetMemorySize() / (1024.0 * 1024.0), "MiB");
+
+	std::vector<std::unique_ptr<Texture>> textures;
+	timer.Reset();
+	for (const Image& image : images)
+		textures.push_back(std::make_unique<Texture>(image, false));
+	Benchmark::Report("separate textures upload", timer.ElapsedMilliseconds(), "ms");
+
+	const float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	BatchRenderer batch(10000);
+	batch.Begin();
+	for (unsigned int i = 0; i < imageCount; i++)
+		batch.DrawQuad((i % 50) * 0.04f - 1.0f, (i / 50) * 0.04f - 1.0f, 0.0f, 0.04f, 0.04f, textures[i]->GetRendererID(), nullptr, white);
+	batch.End();
+	Benchmark::Report("separate textures: batch flushes", batch.GetStats().FlushCount, "");
+
+	batch.ResetStats();
+	batch.Begin();
+	for (unsigned int i = 0; i < imageCount; i++) {
+		const TextureAtlas::Region& region = atlas.GetRegion(i);
+		batch.DrawQuad((i % 50) * 0.04f - 1.0f, (i / 50) * 0.04f - 1.0f, 0.0f, 0.04f, 0.04f,
+			atlas.GetPage(region.Page).GetRendererID(), region.TexCoords, white);
+	}
+	batch.End();
+	Benchmark::Report("atlas: batch flushes", batch.GetStats().FlushCount, "");
+	GLCall(glFinish());
+}
+
+// 32 textures of 1024x1024 with mip chains, created on this thread one by one
+// and then through the TextureLoader: decoded on the pool and streamed with
+// 8 MiB per Update(). What matters is the longest time the GL thread is
+// blocked at once. Also round-trips a KTX file in RGBA8 and, when the GPU
+// supports it, BC1: the file has to read back as the data written, and the
+// texture loaded from it has to hold the same texels.
+BENCHMARK(TextureLoading)
+{
+	const unsigned int textureCount = 32;
+	const unsigned int side = 1024;
+
+	Texture::ResetStats();
+	double longestStall = 0.0;
+	Timer total;
+	{
+		std::vector<std::unique_ptr<Texture>> textures;
+		for (unsigned int i = 0; i < textureCount; i++) {
+			Timer timer;
+			textures.push_back(std::make_unique<Texture>(CreatePattern(side, side, i), true));
+			GLCall(glFlush());
+			longestStall = std::max(longestStall, timer.ElapsedMilliseconds());
+		}
+		GLCall(glFinish());
+		Benchmark::Report("texture memory", Texture::GetMemoryUsage() / (1024.0 * 1024.0), "MiB");
+	}
+	Benchmark::Report("synchronous: total", total.ElapsedMilliseconds(), "ms");
+	Benchmark::Report("synchronous: longest stall", longestStall, "ms");
+
+	TextureLoader loader(ThreadPool::Get());
+	std::vector<std::shared_ptr<Texture>> textures;
+	total.Reset();
+	for (unsigned int i = 0; i < textureCount; i++) {
+		textures.push_back(loader.Load([i, side](TextureData& data) {
+			CreateTextureData(CreatePattern(side, side, i), true, data);
+			return true;
+		}));
+	}
+	unsigned int updates = 0;
+	while (loader.GetPendingCount() > 0) {
+		loader.Update();
+		updates++;
+		std::this_thread::yield();
+	}
+	GLCall(glFinish());
+	const TextureLoader::Stats& stats = loader.GetStats();
+	bool allReady = std::all_of(textures.begin(), textures.end(), [](const std::shared_ptr<Texture>& texture) { return texture->IsReady(); });
+	Benchmark::Report("async: total", total.ElapsedMilliseconds(), "ms");
+	Benchmark::Report("async: longest Update()", stats.MaxUpdateMilliseconds, "ms");
+	Benchmark::Report("async: time in Update()", stats.UpdateMilliseconds, "ms");
+	Benchmark::Report("async: Update() calls", updates, "");
+	Benchmark::Report("async: average latency", stats.Completed ? stats.TotalLatencyMilliseconds / stats.Completed : 0.0, "ms");
+	Benchmark::Report("async: max latency", stats.MaxLatencyMilliseconds, "ms");
+	Benchmark::Report("async: uploaded", stats.BytesUploaded / (1024.0 * 1024.0), "MiB");
+	Benchmark::Check("async: all ready", allReady);
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+	TextureData rgba;
+	CreateTextureData(CreatePattern(side, side, 0), true, rgba);
+	TextureData bc1;
+	bc1.Format = TextureFormat::BC1;
+	bc1.Width = bc1.Height = side;
+	for (unsigned int level = 0, size = side; level < GetMipLevelCount(side, side); level++, size = std::max(1u, size / 2)) {
+		size_t bytes = GetImageSize(TextureFormat::BC1, size, size);
+		bc1.Levels.push_back({ size, size, bc1.Data.size(), bytes });
+		// Any bytes are a valid BC1 block
+		bc1.Data.resize(bc1.Data.size() + bytes, (unsigned char)(level * 40 + 15));
+	}
+
+	struct KTXCase { const char* Name; const TextureData* Data; };
+	const KTXCase cases[] = { { "RGBA8", &rgba }, { "BC1", &bc1 } };
+	for (const KTXCase& ktx : cases) {
+		if (!Texture::IsFormatSupported(ktx.Data->Format)) {
+			Benchmark::Report(std::string("KTX ") + ktx.Name + " unsupported", 0, "");
+			continue;
+		}
+		std::string path = (directory / (std::string("benchmark_") + ktx.Name + ".ktx")).string();
+		if (!Benchmark::Check(std::string("KTX ") + ktx.Name + " written", WriteKTX(path, *ktx.Data)))
+			continue;
+
+		loader.ResetStats();
+		std::shared_ptr<Texture> texture = loader.Load(path);
+		while (loader.GetPendingCount() > 0) {
+			loader.Update();
+			std::this_thread::yield();
+		}
+		GLCall(glFinish());
+		Benchmark::Report(std::string("KTX ") + ktx.Name + " latency", loader.GetStats().MaxLatencyMilliseconds, "ms");
+		Benchmark::Report(std::string("KTX ") + ktx.Name + " texture memory", texture->GetMemorySize() / (1024.0 * 1024.0), "MiB");
+		TextureData reloaded;
+		Benchmark::Check(std::string("KTX ") + ktx.Name + " reads back as written", LoadKTX(path, reloaded) && SameTextureData(reloaded, *ktx.Data));
+		Benchmark::Check(std::string("KTX ") + ktx.Name + " texels uploaded", texture->IsReady() && TexelsMatch(*texture, *ktx.Data));
+		std::filesystem::remove(path, error);
+	}
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "TransformKernels.h"
+#include "ThreadPool.h"
+
+// World matrices, MVP matrices and world bounds for 10k to 1M objects
+// through each TransformKernels path, next to a per-object Mat4 loop over
+// the same data and the best path spread across the thread pool.
+static const size_t s_Counts[] = { 10000, 100000, 1000000 };
+
+// The SIMD paths may fuse multiply-adds, so they only have to agree with the
+// scalar path up to rounding, relative to the size of each value
+static bool NearlyEqual(const float* a, const float* b, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		if (std::fabs(a[i] - b[i]) > 1e-4f * std::max(1.0f, std::fabs(b[i])))
+			return false;
+	}
+	return true;
+}
+
+static bool SameOutputs(const std::vector<Mat4>& world, const std::vector<Mat4>& mvp, const BoundsArrays& bounds,
+	const std::vector<Mat4>& expectedWorld, const std::vector<Mat4>& expectedMvp, const BoundsArrays& expectedBounds) {
+	for (size_t i = 0; i < world.size(); i++) {
+		if (!NearlyEqual(world[i].m, expectedWorld[i].m, 16) || !NearlyEqual(mvp[i].m, expectedMvp[i].m, 16))
+			return false;
+	}
+	size_t count = bounds.GetCount();
+	return NearlyEqual(bounds.CenterX.data(), expectedBounds.CenterX.data(), count) &&
+		NearlyEqual(bounds.CenterY.data(), expectedBounds.CenterY.data(), count) &&
+		NearlyEqual(bounds.CenterZ.data(), expectedBounds.CenterZ.data(), count) &&
+		NearlyEqual(bounds.ExtentX.data(), expectedBounds.ExtentX.data(), count) &&
+		NearlyEqual(bounds.ExtentY.data(), expectedBounds.ExtentY.data(), count) &&
+		NearlyEqual(bounds.ExtentZ.data(), expectedBounds.ExtentZ.data(), count);
+}
+
+BENCHMARK(TransformKernels)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	const Mat4 viewProjection = Mat4::Perspective(Radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f)
+		* Mat4::LookAt(Vec3(0.0f, 50.0f, 200.0f), Vec3(), Vec3(0.0f, 1.0f, 0.0f));
+
+	for (size_t count : s_Counts) {
+		TransformArrays transforms;
+		BoundsArrays localBounds, worldBounds;
+		transforms.Resize(count);
+		localBounds.Resize(count);
+		worldBounds.Resize(count);
+		for (size_t i = 0; i < count; i++) {
+			Vec3 position(distribution(random) * 100.0f, distribution(random) * 100.0f, distribution(random) * 100.0f);
+			Quat rotation = Normalize(Quat(distribution(random), distribution(random), distribution(random), distribution(random)));
+			transforms.Set(i, position, rotation, Vec3(1.0f + distribution(random) * 0.5f));
+			localBounds.Set(i, Vec3(), Vec3(1.0f));
+		}
+
+		std::vector<Mat4> world(count), mvp(count);
+		TransformKernels::Job job;
+		job.Transforms = &transforms;
+		job.LocalBounds = &localBounds;
+		job.ViewProjection = viewProjection;
+		job.World = world.data();
+		job.MVP = mvp.data();
+		job.WorldBounds = &worldBounds;
+
+		const std::string prefix = std::to_string(count / 1000) + "k ";
+		double reference = Benchmark::TimeMilliseconds([&]() {
+			for (size_t i = 0; i < count; i++) {
+				Vec3 position(transforms.PositionX[i], transforms.PositionY[i], transforms.PositionZ[i]);
+				Quat rotation(transforms.RotationX[i], transforms.RotationY[i], transforms.RotationZ[i], transforms.RotationW[i]);
+				Vec3 scale(transforms.ScaleX[i], transforms.ScaleY[i], transforms.ScaleZ[i]);
+				world[i] = Mat4::TRS(position, rotation, scale);
+				mvp[i] = viewProjection * world[i];
+				const float* m = world[i].m;
+				Vec3 extent = localBounds.GetExtent(i);
+				worldBounds.Set(i, world[i].TransformPoint(localBounds.GetCenter(i)), Vec3(
+					std::fabs(m[0]) * extent.x + std::fabs(m[4]) * extent.y + std::fabs(m[8]) * extent.z,
+					std::fabs(m[1]) * extent.x + std::fabs(m[5]) * extent.y + std::fabs(m[9]) * extent.z,
+					std::fabs(m[2]) * extent.x + std::fabs(m[6]) * extent.y + std::fabs(m[10]) * extent.z));
+			}
+		});
+		Benchmark::Report(prefix + "per-object Mat4", reference, "ms");
+
+		// Scalar runs first and every later path is checked against its outputs
+		std::vector<Mat4> scalarWorld, scalarMvp;
+		BoundsArrays scalarBounds;
+		const TransformKernels::Path paths[] = { TransformKernels::Path::Scalar, TransformKernels::Path::SSE, TransformKernels::Path::AVX2 };
+		for (TransformKernels::Path path : paths) {
+			if (!TransformKernels::IsSupported(path)) {
+				Benchmark::Report(prefix + TransformKernels::GetName(path) + " unsupported", 0, "");
+				continue;
+			}
+			double milliseconds = Benchmark::TimeMilliseconds([&]() { TransformKernels::Run(path, job, 0, count); });
+			Benchmark::Report(prefix + TransformKernels::GetName(path), milliseconds, "ms");
+			Benchmark::Report(prefix + TransformKernels::GetName(path) + " per object", milliseconds * 1e6 / count, "ns");
+
+			if (path == TransformKernels::Path::Scalar) {
+				scalarWorld = world;
+				scalarMvp = mvp;
+				scalarBounds = worldBounds;
+			}
+			else {
+				Benchmark::Check(prefix + TransformKernels::GetName(path) + " matches scalar",
+					SameOutputs(world, mvp, worldBounds, scalarWorld, scalarMvp, scalarBounds));
+			}
+		}
+
+		double threaded = Benchmark::TimeMilliseconds([&]() { TransformKernels::Run(job, &ThreadPool::Get()); });
+		Benchmark::Report(prefix + TransformKernels::GetName(TransformKernels::GetBestPath()) + " on the thread pool", threaded, "ms");
+		Benchmark::Check(prefix + TransformKernels::GetName(TransformKernels::GetBestPath()) + " on the thread pool matches scalar",
+			SameOutputs(world, mvp, worldBounds, scalarWorld, scalarMvp, scalarBounds));
+	}
+	Benchmark::Report("pool threads", ThreadPool::Get().GetWorkerCount() + 1.0, "");
+}
@@ -0,0 +1,59 @@
+#include "Benchmark.h"
+#include "BenchmarkFixtures.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
+
+// Sets a per-draw color the way the demo used to (location lookup by string
+// and an unconditional glUniform4f) and through the cached setters. Draws
+// come in runs sharing a material, so most cached sets are skipped.
+BENCHMARK(UniformUploads)
+{
+	const unsigned int draws = 100000;
+	const unsigned int materials = 8, runLength = 16;
+
+	ShaderLibrary library("");
+	std::shared_ptr<Shader> shader = library.Load("assets/shaders/FlatColor.shader.vert", "assets/shaders/FlatColor.shader.frag");
+	if (!shader)
+		return;
+	shader->Bind();
+
+	unsigned int program = shader->GetRendererID();
+	unsigned int naiveUploads = 0;
+	Timer timer;
+	for (unsigned int i = 0; i < draws; i++) {
+		float red = (float)(i / runLength % materials) / materials;
+		GLCall(int location = glGetUniformLocation(program, "u_Color"));
+		GLCall(glUniform4f(location, red, 0.0f, 0.0f, 1.0f));
+		naiveUploads++;
+	}
+	GLCall(glFinish());
+	double naiveMs = timer.ElapsedMilliseconds();
+
+	const std::string color = "u_Color";
+	Shader::ResetUniformStats();
+	timer.Reset();
+	for (unsigned int i = 0; i < draws; i++) {
+		float red = (float)(i / runLength % materials) / materials;
+		shader->SetUniform4f(color, red, 0.0f, 0.0f, 1.0f);
+	}
+	GLCall(glFinish());
+	double cachedMs = timer.ElapsedMilliseconds();
+	Shader::UniformStats stats = Shader::GetUniformStats();
+
+	// Every program reads the view-projection from the Frame block, so one
+	// upload replaces a glUniformMatrix4fv per program
+	std::shared_ptr<Shader> batchShader = library.Load("assets/shaders/Batch.shader.vert", "assets/shaders/Batch.shader.frag");
+	UniformBuffer::ResetStats();
+	std::unique_ptr<UniformBuffer> frameUniforms = CreateFrameUniforms();
+	unsigned int sharingPrograms = (shader->HasUniformBlock("Frame") ? 1 : 0) + (batchShader && batchShader->HasUniformBlock("Frame") ? 1 : 0);
+
+	Benchmark::Report("draws", draws, "");
+	Benchmark::Report("naive glUniform4f calls", naiveUploads, "");
+	Benchmark::Report("naive time", naiveMs, "ms");
+	Benchmark::Report("cached uploads", stats.Uploads, "");
+	Benchmark::Report("cached skipped", stats.Skipped, "");
+	Benchmark::Report("cached time", cachedMs, "ms");
+	Benchmark::Report("Frame block uploads per frame", UniformBuffer::GetStats().Uploads, "");
+	Benchmark::Report("programs sharing the Frame block", sharingPrograms, "");
+}
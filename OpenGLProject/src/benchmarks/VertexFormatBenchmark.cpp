@@ -0,0 +1,114 @@
+#include <cmath>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Renderer.h"
+#include "VertexArray.h"
+
+// Vertex footprint and upload time of the float-only layout against the
+// compact attribute formats, for the same position/normal/UV mesh.
+struct FloatVertex
+{
+	float Position[3];
+	float Normal[3];
+	float TexCoord[2];
+
+	using Layout = StaticVertexLayout<VertexAttribute<float, 3>, VertexAttribute<float, 3>, VertexAttribute<float, 2>>;
+};
+
+struct PackedVertex
+{
+	float Position[3];
+	PackedNormal Normal;
+	Half TexCoord[2];
+
+	using Layout = StaticVertexLayout<VertexAttribute<float, 3>, VertexAttribute<PackedNormal, 1>, VertexAttribute<Half, 2>>;
+};
+
+// Positions normalized to the mesh bounds, to be rescaled by the model matrix
+struct CompactVertex
+{
+	NormalizedShort Position[4];
+	PackedNormal Normal;
+	Half TexCoord[2];
+
+	using Layout = StaticVertexLayout<VertexAttribute<NormalizedShort, 4>, VertexAttribute<PackedNormal, 1>, VertexAttribute<Half, 2>>;
+};
+
+static_assert(FloatVertex::Layout::Stride == sizeof(FloatVertex), "FloatVertex layout does not match the struct");
+static_assert(PackedVertex::Layout::Stride == sizeof(PackedVertex), "PackedVertex layout does not match the struct");
+static_assert(CompactVertex::Layout::Stride == sizeof(CompactVertex), "CompactVertex layout does not match the struct");
+
+template<typename Vertex>
+static void MeasureUpload(const char* name, const std::vector<Vertex>& vertices, double packMs) {
+	const int repetitions = 10;
+	unsigned int size = (unsigned int)(vertices.size() * sizeof(Vertex));
+
+	GLCall(glFinish());
+	Timer timer;
+	for (int i = 0; i < repetitions; i++) {
+		VertexBuffer vbo(vertices.data(), size);
+		VertexArray vao;
+		vao.AddBuffer(vbo, typename Vertex::Layout());
+		GLCall(glFinish());
+	}
+	double uploadMs = timer.ElapsedMilliseconds() / repetitions;
+
+	std::string prefix = name;
+	Benchmark::Report(prefix + " bytes per vertex", sizeof(Vertex), "B");
+	Benchmark::Report(prefix + " buffer size", size / (1024.0 * 1024.0), "MiB");
+	Benchmark::Report(prefix + " pack time", packMs, "ms");
+	Benchmark::Report(prefix + " upload time", uploadMs, "ms");
+}
+
+BENCHMARK(VertexFormats)
+{
+	const unsigned int count = 1000000;
+
+	std::vector<FloatVertex> floats(count);
+	for (unsigned int i = 0; i < count; i++) {
+		float angle = i * 0.001f;
+		FloatVertex& v = floats[i];
+		v.Position[0] = std::cos(angle);
+		v.Position[1] = std::sin(angle);
+		v.Position[2] = (float)(i % 1000) / 1000.0f;
+		v.Normal[0] = std::cos(angle);
+		v.Normal[1] = std::sin(angle);
+		v.Normal[2] = 0.0f;
+		v.TexCoord[0] = (float)(i % 1024) / 1024.0f;
+		v.TexCoord[1] = (float)(i / 1024 % 1024) / 1024.0f;
+	}
+
+	Timer timer;
+	std::vector<PackedVertex> packed(count);
+	for (unsigned int i = 0; i < count; i++) {
+		const FloatVertex& in = floats[i];
+		PackedVertex& out = packed[i];
+		out.Position[0] = in.Position[0];
+		out.Position[1] = in.Position[1];
+		out.Position[2] = in.Position[2];
+		out.Normal = VertexPacking::ToPackedNormal(in.Normal[0], in.Normal[1], in.Normal[2]);
+		out.TexCoord[0] = VertexPacking::ToHalf(in.TexCoord[0]);
+		out.TexCoord[1] = VertexPacking::ToHalf(in.TexCoord[1]);
+	}
+	double packedMs = timer.ElapsedMilliseconds();
+
+	timer.Reset();
+	std::vector<CompactVertex> compact(count);
+	for (unsigned int i = 0; i < count; i++) {
+		const FloatVertex& in = floats[i];
+		CompactVertex& out = compact[i];
+		out.Position[0] = VertexPacking::ToNormalizedShort(in.Position[0]);
+		out.Position[1] = VertexPacking::ToNormalizedShort(in.Position[1]);
+		out.Position[2] = VertexPacking::ToNormalizedShort(in.Position[2]);
+		out.Position[3] = VertexPacking::ToNormalizedShort(1.0f);
+		out.Normal = VertexPacking::ToPackedNormal(in.Normal[0], in.Normal[1], in.Normal[2]);
+		out.TexCoord[0] = VertexPacking::ToHalf(in.TexCoord[0]);
+		out.TexCoord[1] = VertexPacking::ToHalf(in.TexCoord[1]);
+	}
+	double compactMs = timer.ElapsedMilliseconds();
+
+	MeasureUpload("float", floats, 0.0);
+	MeasureUpload("packed", packed, packedMs);
+	MeasureUpload("compact", compact, compactMs);
+}